@@ -0,0 +1,140 @@
+// Rate limiter contention benchmark: 1 to 64 threads hammering the buckets
+//
+// Build with -DBUILD_BENCHMARKS=ON, then run:
+//   ./rate-limiter-bench [milliseconds_per_run]
+
+#include "rate_limiter/RateLimiter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gateway;
+
+namespace {
+
+// The bucket the limiter used before: double tokens behind a mutex
+struct MutexBucket {
+    double capacity;
+    double tokens;
+    double refill_rate;
+    std::chrono::steady_clock::time_point last_refill;
+    std::mutex mtx;
+
+    MutexBucket(double cap, double rate)
+        : capacity(cap), tokens(cap), refill_rate(rate),
+          last_refill(std::chrono::steady_clock::now()) {}
+
+    bool consume(int requested) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_refill).count();
+        if (elapsed > 0) {
+            tokens = std::min(capacity, tokens + refill_rate * elapsed / 1000.0);
+            last_refill = now;
+        }
+        if (tokens >= requested) {
+            tokens -= requested;
+            return true;
+        }
+        return false;
+    }
+};
+
+// Effectively unlimited so every call takes the full consume path
+constexpr double CAPACITY = 1000000;
+constexpr double RATE = 1000000;
+
+// Runs fn(thread_index) in a loop on each thread and returns million ops/sec
+template <typename Fn>
+double run(int threads, int duration_ms, Fn&& fn) {
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> counts(threads * 8, 0);  // Padded to avoid false sharing
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            uint64_t local = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 64; i++) {
+                    fn(t);
+                }
+                local += 64;
+            }
+            counts[t * 8] = local;
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    stop.store(true);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    uint64_t total = 0;
+    for (int t = 0; t < threads; t++) {
+        total += counts[t * 8];
+    }
+    return total / seconds / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int duration_ms = argc > 1 ? std::atoi(argv[1]) : 500;
+    if (duration_ms <= 0) {
+        duration_ms = 500;
+    }
+
+    std::cout << "Mops/s (higher is better), " << std::thread::hardware_concurrency()
+              << " hardware threads\n";
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::right << std::setw(16) << "mutex global"
+              << std::setw(16) << "cas global"
+              << std::setw(22) << "allowRequest ip+gl" << "\n";
+
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        MutexBucket mutex_bucket(CAPACITY, RATE);
+        double mutex_ops = run(threads, duration_ms, [&](int) {
+            mutex_bucket.consume(1);
+        });
+
+        AtomicTokenBucket cas_bucket(CAPACITY);
+        double cas_ops = run(threads, duration_ms, [&](int) {
+            cas_bucket.consume(CAPACITY, RATE, 1);
+        });
+
+        // Full limiter path: shared global bucket plus one per-IP bucket per thread
+        RateLimiter limiter;
+        limiter.setGlobalLimit(static_cast<int>(CAPACITY), 1);
+        limiter.setPerIPLimit(static_cast<int>(CAPACITY), 1);
+        std::vector<std::string> ips;
+        for (int t = 0; t < threads; t++) {
+            ips.push_back("10.0." + std::to_string(t / 256) + "." + std::to_string(t % 256));
+        }
+        double limiter_ops = run(threads, duration_ms, [&](int t) {
+            limiter.allowRequest(ips[t], "/api/bench");
+        });
+
+        std::cout << std::left << std::setw(10) << threads
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(16) << mutex_ops
+                  << std::setw(16) << cas_ops
+                  << std::setw(22) << limiter_ops << "\n";
+    }
+
+    return 0;
+}
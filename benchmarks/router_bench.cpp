@@ -0,0 +1,165 @@
+// Route matching micro-benchmark: RouteTrie vs the previous linear std::regex scan
+//
+// Build with -DBUILD_BENCHMARKS=ON, then run:
+//   ./router-bench [iterations]
+
+#include "router/RouteTrie.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace gateway;
+
+namespace {
+
+// Keeps the timed loops from being optimized away
+volatile size_t g_sink = 0;
+
+// Copy of the wildcard-to-regex conversion the router used before the trie
+std::regex patternToRegex(const std::string& pattern) {
+    std::string regex_pattern = pattern;
+
+    std::string special_chars = ".^$+?()[]{}|\\";
+    for (char c : special_chars) {
+        std::string from(1, c);
+        std::string to = "\\" + from;
+        size_t pos = 0;
+        while ((pos = regex_pattern.find(from, pos)) != std::string::npos) {
+            regex_pattern.replace(pos, 1, to);
+            pos += to.length();
+        }
+    }
+
+    if (regex_pattern.size() >= 2 &&
+        regex_pattern.substr(regex_pattern.size() - 2) == "/*") {
+        regex_pattern = regex_pattern.substr(0, regex_pattern.size() - 2) + "(/.*)?";
+    }
+
+    size_t pos = 0;
+    while ((pos = regex_pattern.find("*", pos)) != std::string::npos) {
+        regex_pattern.replace(pos, 1, ".*");
+        pos += 2;
+    }
+
+    return std::regex(regex_pattern);
+}
+
+// Mix of exact, subtree and inner-wildcard routes, roughly like a real table
+std::vector<std::string> makePatterns(size_t count) {
+    std::vector<std::string> patterns;
+    patterns.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::string service = "/api/v" + std::to_string(i % 3 + 1) + "/service" + std::to_string(i);
+        switch (i % 4) {
+            case 0: patterns.push_back(service); break;
+            case 1: patterns.push_back(service + "/*"); break;
+            case 2: patterns.push_back(service + "/items/*"); break;
+            default: patterns.push_back(service + "/*/details"); break;
+        }
+    }
+    return patterns;
+}
+
+// Paths hitting routes spread across the table, plus some misses
+std::vector<std::string> makePaths(size_t count) {
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < count; i += std::max<size_t>(count / 64, 1)) {
+        std::string service = "/api/v" + std::to_string(i % 3 + 1) + "/service" + std::to_string(i);
+        switch (i % 4) {
+            case 0: paths.push_back(service); break;
+            case 1: paths.push_back(service + "/users/42"); break;
+            case 2: paths.push_back(service + "/items/abc/def"); break;
+            default: paths.push_back(service + "/order-7/details"); break;
+        }
+    }
+    paths.push_back("/api/v9/unknown/path");
+    paths.push_back("/static/app.js");
+    return paths;
+}
+
+template <typename Fn>
+double nsPerMatch(const std::vector<std::string>& paths, int iterations, Fn&& fn) {
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (const auto& path : paths) {
+            hits += fn(path) ? 1 : 0;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    g_sink = hits;
+
+    double total = static_cast<double>(iterations) * static_cast<double>(paths.size());
+    return std::chrono::duration<double, std::nano>(elapsed).count() / total;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+    if (iterations <= 0) {
+        iterations = 200;
+    }
+
+    std::cout << std::left << std::setw(10) << "routes"
+              << std::right << std::setw(16) << "regex ns/op"
+              << std::setw(16) << "trie ns/op"
+              << std::setw(12) << "speedup" << "\n";
+
+    for (size_t count : {10, 100, 1000, 5000}) {
+        auto patterns = makePatterns(count);
+        auto paths = makePaths(count);
+
+        std::vector<std::regex> regexes;
+        regexes.reserve(patterns.size());
+        RouteTrie trie;
+        for (size_t i = 0; i < patterns.size(); i++) {
+            regexes.push_back(patternToRegex(patterns[i]));
+            trie.insert(patterns[i], i);
+        }
+
+        // Sanity check: both matchers must agree before timing them
+        for (const auto& path : paths) {
+            std::optional<size_t> expected;
+            for (size_t i = 0; i < regexes.size(); i++) {
+                if (std::regex_match(path, regexes[i])) {
+                    expected = i;
+                    break;
+                }
+            }
+            if (trie.match(path) != expected) {
+                std::cerr << "Mismatch for " << path << "\n";
+                return 1;
+            }
+        }
+
+        // Regex is linear in route count; scale iterations down to keep runtime sane
+        int regex_iterations = std::max(1, iterations / static_cast<int>(count / 10 + 1));
+
+        double regex_ns = nsPerMatch(paths, regex_iterations, [&](const std::string& path) {
+            for (const auto& re : regexes) {
+                if (std::regex_match(path, re)) {
+                    return true;
+                }
+            }
+            return false;
+        });
+
+        double trie_ns = nsPerMatch(paths, iterations * 10, [&](const std::string& path) {
+            return trie.match(path).has_value();
+        });
+
+        std::cout << std::left << std::setw(10) << count
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(16) << regex_ns
+                  << std::setw(16) << trie_ns
+                  << std::setw(11) << (regex_ns / trie_ns) << "x\n";
+    }
+
+    return 0;
+}
@@ -6,45 +6,61 @@ using json = nlohmann::json;
 namespace gateway {
 
 void AdminAPI::registerEndpoints(httplib::Server& server, const std::string& admin_token) {
+    registerEndpoints([&server](const std::string& method, const std::string& path,
+                                httplib::Server::Handler handler) {
+        if (method == "GET") {
+            server.Get(path, std::move(handler));
+        } else {
+            server.Post(path, std::move(handler));
+        }
+    }, admin_token);
+}
+
+void AdminAPI::registerEndpoints(const EndpointRegistrar& add, const std::string& admin_token) {
     admin_token_ = admin_token;
 
     // GET /admin/config - View current configuration
-    server.Get("/admin/config", [this](const httplib::Request& req, httplib::Response& res) {
+    add("GET", "/admin/config", [this](const httplib::Request& req, httplib::Response& res) {
         handleGetConfig(req, res);
     });
 
     // POST /admin/config - Update configuration
-    server.Post("/admin/config", [this](const httplib::Request& req, httplib::Response& res) {
+    add("POST", "/admin/config", [this](const httplib::Request& req, httplib::Response& res) {
         handleUpdateConfig(req, res);
     });
 
     // GET /admin/cache/stats - Get cache statistics
-    server.Get("/admin/cache/stats", [this](const httplib::Request& req, httplib::Response& res) {
+    add("GET", "/admin/cache/stats", [this](const httplib::Request& req, httplib::Response& res) {
         handleGetCacheStats(req, res);
     });
 
     // POST /admin/cache/clear - Clear cache
-    server.Post("/admin/cache/clear", [this](const httplib::Request& req, httplib::Response& res) {
+    add("POST", "/admin/cache/clear", [this](const httplib::Request& req, httplib::Response& res) {
         handleClearCache(req, res);
     });
 
+    // POST /admin/cache/purge - Purge cached responses by tag
+    add("POST", "/admin/cache/purge", [this](const httplib::Request& req, httplib::Response& res) {
+        handlePurgeCache(req, res);
+    });
+
     // POST /admin/ratelimit/reset - Reset rate limit for a key
-    server.Post("/admin/ratelimit/reset", [this](const httplib::Request& req, httplib::Response& res) {
+    add("POST", "/admin/ratelimit/reset", [this](const httplib::Request& req, httplib::Response& res) {
         handleResetRateLimit(req, res);
     });
 
     // POST /admin/reload - Reload configuration from disk
-    server.Post("/admin/reload", [this](const httplib::Request& req, httplib::Response& res) {
+    add("POST", "/admin/reload", [this](const httplib::Request& req, httplib::Response& res) {
         handleReloadConfig(req, res);
     });
 
     // GET /admin/routes - List all routes
-    server.Get("/admin/routes", [this](const httplib::Request& req, httplib::Response& res) {
+    add("GET", "/admin/routes", [this](const httplib::Request& req, httplib::Response& res) {
         handleGetRoutes(req, res);
     });
 
     // POST /admin/routes - Replace all routes
-    server.Post("/admin/routes", [this](const httplib::Request& req, httplib::Response& res) {
+    add("POST", "/admin/routes", [this](const httplib::Request& req, httplib::Response& res) {
         handleUpdateRoutes(req, res);
     });
 
@@ -179,6 +195,45 @@ void AdminAPI::handleClearCache(const httplib::Request& req, httplib::Response&
     }
 }
 
+void AdminAPI::handlePurgeCache(const httplib::Request& req, httplib::Response& res) {
+    if (!verifyAdminToken(req)) {
+        sendError(res, 401, "Unauthorized: Invalid or missing admin token");
+        return;
+    }
+
+    try {
+        json body = json::parse(req.body);
+
+        // Routes and surrogate keys are shorthands for their tags
+        std::vector<std::string> tags = body.value("tags", std::vector<std::string>{});
+        for (const auto& route : body.value("routes", std::vector<std::string>{})) {
+            tags.push_back("route:" + route);
+        }
+        for (const auto& key : body.value("surrogate_keys", std::vector<std::string>{})) {
+            tags.push_back("key:" + key);
+        }
+        if (tags.empty()) {
+            sendError(res, 400, "Missing required field: tags, routes or surrogate_keys");
+            return;
+        }
+
+        if (cache_purge_callback_) {
+            int purged = cache_purge_callback_(tags);
+            json response = {
+                {"message", "Cache purged"},
+                {"tags", tags},
+                {"keys_purged", purged},
+                {"timestamp", std::time(nullptr)}
+            };
+            sendJSON(res, 200, response);
+        } else {
+            sendError(res, 503, "Cache not available");
+        }
+    } catch (const std::exception& e) {
+        sendError(res, 400, std::string("Cache purge failed: ") + e.what());
+    }
+}
+
 void AdminAPI::handleResetRateLimit(const httplib::Request& req, httplib::Response& res) {
     if (!verifyAdminToken(req)) {
         sendError(res, 401, "Unauthorized: Invalid or missing admin token");
@@ -265,9 +320,12 @@ void AdminAPI::handleUpdateRoutes(const httplib::Request& req, httplib::Response
             return;
         }
 
-        // Clear existing routes and reload from the submitted JSON
-        router_->clearRoutes();
-        int count = router_->loadRoutes(body.dump());
+        // Swap in the new table atomically; in-flight requests finish on the old one
+        int count = router_->replaceRoutes(body.dump());
+        if (count < 0) {
+            sendError(res, 400, "Invalid routes configuration");
+            return;
+        }
 
         json response = {
             {"message", "Routes updated successfully"},
@@ -3,6 +3,7 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <vector>
 #include <memory>
 #include <httplib.h>
 #include <nlohmann/json.hpp>
@@ -34,6 +35,18 @@ public:
      */
     void registerEndpoints(httplib::Server& server, const std::string& admin_token);
 
+    /**
+     * @brief Adds one endpoint: (method, path, handler)
+     */
+    using EndpointRegistrar = std::function<void(const std::string& method, const std::string& path,
+                                                 httplib::Server::Handler handler)>;
+
+    /**
+     * @brief Register admin endpoints through a registrar (e.g. HttpServer::addLocalRoute)
+     * @param admin_token Bearer token required for admin endpoints
+     */
+    void registerEndpoints(const EndpointRegistrar& add, const std::string& admin_token);
+
     /**
      * @brief Set callback for configuration updates
      */
@@ -64,6 +77,14 @@ public:
         cache_clear_callback_ = callback;
     }
 
+    /**
+     * @brief Set cache purge-by-tag callback (returns entries removed)
+     */
+    using CachePurgeCallback = std::function<int(const std::vector<std::string>& tags)>;
+    void setCachePurgeCallback(CachePurgeCallback callback) {
+        cache_purge_callback_ = callback;
+    }
+
     /**
      * @brief Set rate limit reset callback
      */
@@ -85,6 +106,7 @@ private:
     ConfigUpdateCallback config_update_callback_;
     CacheStatsCallback cache_stats_callback_;
     CacheClearCallback cache_clear_callback_;
+    CachePurgeCallback cache_purge_callback_;
     RateLimitResetCallback rate_limit_reset_callback_;
     std::shared_ptr<Router> router_;
 
@@ -108,6 +130,7 @@ private:
     void handleUpdateConfig(const httplib::Request& req, httplib::Response& res);
     void handleGetCacheStats(const httplib::Request& req, httplib::Response& res);
     void handleClearCache(const httplib::Request& req, httplib::Response& res);
+    void handlePurgeCache(const httplib::Request& req, httplib::Response& res);
     void handleResetRateLimit(const httplib::Request& req, httplib::Response& res);
     void handleReloadConfig(const httplib::Request& req, httplib::Response& res);
     void handleGetRoutes(const httplib::Request& req, httplib::Response& res);
@@ -0,0 +1,149 @@
+#include "cache/CacheCodec.h"
+
+namespace gateway {
+
+namespace {
+
+void putInt(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void putString(std::string& out, std::string_view value) {
+    putInt(out, value.size(), 4);
+    out.append(value.data(), value.size());
+}
+
+/**
+ * @brief Bounds-checked reader over an encoded value
+ */
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    bool readInt(uint64_t& value, size_t bytes) {
+        if (data_.size() - pos_ < bytes) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(data_[pos_ + i])) << (8 * i);
+        }
+        pos_ += bytes;
+        return true;
+    }
+
+    bool readString(std::string_view& value) {
+        uint64_t length = 0;
+        if (!readInt(length, 4) || data_.size() - pos_ < length) {
+            return false;
+        }
+        value = data_.substr(pos_, length);
+        pos_ += length;
+        return true;
+    }
+
+    bool atEnd() const { return pos_ == data_.size(); }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+std::string CacheCodec::encode(int status_code, long long cached_at, long long fresh_until,
+                               std::string_view content_type,
+                               const std::map<std::string, std::string>& headers,
+                               const std::vector<std::string>& tags,
+                               std::string_view body) {
+    size_t size = 1 + 2 + 8 + 8 + 4 + content_type.size() + 4 + 4 + 4 + body.size();
+    for (const auto& [name, value] : headers) {
+        size += 8 + name.size() + value.size();
+    }
+    for (const auto& tag : tags) {
+        size += 4 + tag.size();
+    }
+
+    std::string out;
+    out.reserve(size);
+    putInt(out, VERSION, 1);
+    putInt(out, static_cast<uint16_t>(status_code), 2);
+    putInt(out, static_cast<uint64_t>(cached_at), 8);
+    putInt(out, static_cast<uint64_t>(fresh_until), 8);
+    putString(out, content_type);
+    putInt(out, headers.size(), 4);
+    for (const auto& [name, value] : headers) {
+        putString(out, name);
+        putString(out, value);
+    }
+    putInt(out, tags.size(), 4);
+    for (const auto& tag : tags) {
+        putString(out, tag);
+    }
+    putString(out, body);
+    return out;
+}
+
+std::optional<CacheRecordView> CacheCodec::decode(std::string_view data) {
+    Reader reader(data);
+    CacheRecordView view;
+    uint64_t version = 0, status = 0, cached_at = 0, fresh_until = 0, header_count = 0, tag_count = 0;
+
+    if (!reader.readInt(version, 1) || version != VERSION ||
+        !reader.readInt(status, 2) ||
+        !reader.readInt(cached_at, 8) ||
+        !reader.readInt(fresh_until, 8) ||
+        !reader.readString(view.content_type) ||
+        !reader.readInt(header_count, 4)) {
+        return std::nullopt;
+    }
+
+    // Each header needs at least its two length prefixes
+    if (header_count > data.size() / 8) {
+        return std::nullopt;
+    }
+    view.headers.reserve(header_count);
+    for (uint64_t i = 0; i < header_count; i++) {
+        std::string_view name, value;
+        if (!reader.readString(name) || !reader.readString(value)) {
+            return std::nullopt;
+        }
+        view.headers.emplace_back(name, value);
+    }
+
+    if (!reader.readInt(tag_count, 4) || tag_count > data.size() / 4) {
+        return std::nullopt;
+    }
+    view.tags.reserve(tag_count);
+    for (uint64_t i = 0; i < tag_count; i++) {
+        std::string_view tag;
+        if (!reader.readString(tag)) {
+            return std::nullopt;
+        }
+        view.tags.push_back(tag);
+    }
+
+    if (!reader.readString(view.body) || !reader.atEnd()) {
+        return std::nullopt;
+    }
+
+    view.status_code = static_cast<int>(status);
+    view.cached_at = static_cast<long long>(cached_at);
+    view.fresh_until = static_cast<long long>(fresh_until);
+    return view;
+}
+
+std::optional<CacheRecord> CacheRecord::fromBuffer(std::string data) {
+    CacheRecord record;
+    record.data_ = std::make_shared<const std::string>(std::move(data));
+    auto view = CacheCodec::decode(*record.data_);
+    if (!view) {
+        return std::nullopt;
+    }
+    record.view_ = std::move(*view);
+    return record;
+}
+
+} // namespace gateway
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <cstdint>
+
+namespace gateway {
+
+/**
+ * @brief Decoded cache value; string fields point into the encoded buffer
+ */
+struct CacheRecordView {
+    int status_code = 0;
+    long long cached_at = 0;        // Unix ms
+    long long fresh_until = 0;      // Unix ms after which the entry is stale (0 = never)
+    std::string_view content_type;
+    std::vector<std::pair<std::string_view, std::string_view>> headers;
+    std::vector<std::string_view> tags;
+    std::string_view body;
+};
+
+/**
+ * @brief Compact binary encoding for cached responses
+ *
+ * Layout (integers little-endian):
+ *   u8  version
+ *   u16 status, i64 cached_at, i64 fresh_until
+ *   u32 length + content type
+ *   u32 header count, then u32 length + name, u32 length + value per header
+ *   u32 tag count, then u32 length + tag per tag
+ *   u32 length + body
+ *
+ * Values in any other version (including the old JSON format) fail to
+ * decode and are treated as cache misses.
+ */
+class CacheCodec {
+public:
+    static constexpr uint8_t VERSION = 2;
+
+    static std::string encode(int status_code, long long cached_at, long long fresh_until,
+                              std::string_view content_type,
+                              const std::map<std::string, std::string>& headers,
+                              const std::vector<std::string>& tags,
+                              std::string_view body);
+
+    /**
+     * @brief Decode without copying; the view is valid while data is
+     * @return std::nullopt if data is truncated or from another version
+     */
+    static std::optional<CacheRecordView> decode(std::string_view data);
+};
+
+/**
+ * @brief Owns an encoded cache value together with its decoded view
+ *
+ * The buffer lives on the heap, so moving or copying the record keeps the
+ * view valid.
+ */
+class CacheRecord {
+public:
+    /**
+     * @brief Take ownership of an encoded value and decode it
+     */
+    static std::optional<CacheRecord> fromBuffer(std::string data);
+
+    const CacheRecordView& view() const { return view_; }
+    std::string_view body() const { return view_.body; }
+
+private:
+    std::shared_ptr<const std::string> data_;
+    CacheRecordView view_;
+};
+
+} // namespace gateway
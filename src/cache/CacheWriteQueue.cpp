@@ -0,0 +1,93 @@
+#include "cache/CacheWriteQueue.h"
+#include <algorithm>
+#include <iostream>
+
+namespace gateway {
+
+CacheWriteQueue::CacheWriteQueue(FlushFn flush, CacheWriteQueueConfig config,
+                                 std::shared_ptr<SimpleMetrics> metrics)
+    : flush_(std::move(flush)), config_(config), metrics_(std::move(metrics)) {
+    config_.max_pending = std::max<size_t>(config_.max_pending, 1);
+    config_.max_batch = std::max<size_t>(config_.max_batch, 1);
+    writer_ = std::thread([this]() {
+        writerLoop();
+    });
+}
+
+CacheWriteQueue::~CacheWriteQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+bool CacheWriteQueue::enqueue(CacheWrite write) {
+    size_t depth;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || queue_.size() >= config_.max_pending) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            if (metrics_) {
+                metrics_->incrementCacheWriteDrops();
+            }
+            return false;
+        }
+        queue_.push_back(std::move(write));
+        depth = queue_.size();
+    }
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+    if (metrics_) {
+        metrics_->setCacheWriteQueueDepth(depth);
+    }
+    cv_.notify_one();
+    return true;
+}
+
+CacheWriteQueue::Stats CacheWriteQueue::getStats() {
+    size_t depth;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        depth = queue_.size();
+    }
+    return {depth, enqueued_.load(), written_.load(), dropped_.load(), batches_.load()};
+}
+
+void CacheWriteQueue::writerLoop() {
+    std::vector<CacheWrite> batch;
+    batch.reserve(config_.max_batch);
+
+    while (true) {
+        size_t depth;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() {
+                return !running_ || !queue_.empty();
+            });
+            if (queue_.empty()) {
+                return;     // Stopped and drained
+            }
+            size_t count = std::min(queue_.size(), config_.max_batch);
+            std::move(queue_.begin(), queue_.begin() + count, std::back_inserter(batch));
+            queue_.erase(queue_.begin(), queue_.begin() + count);
+            depth = queue_.size();
+        }
+        if (metrics_) {
+            metrics_->setCacheWriteQueueDepth(depth);
+        }
+
+        try {
+            flush_(batch);
+        } catch (const std::exception& e) {
+            std::cerr << "Cache write batch failed: " << e.what() << std::endl;
+        }
+        written_.fetch_add(batch.size(), std::memory_order_relaxed);
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        batch.clear();
+    }
+}
+
+} // namespace gateway
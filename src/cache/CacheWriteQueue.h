@@ -0,0 +1,102 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include "metrics/SimpleMetrics.h"
+
+namespace gateway {
+
+/**
+ * @brief One cache entry waiting to be written to the shared cache
+ */
+struct CacheWrite {
+    std::string key;
+    std::string value;                  // Already encoded (CacheCodec)
+    int retention_seconds = 0;          // Fresh TTL plus stale window
+    std::vector<std::string> tags;
+};
+
+/**
+ * @brief Tuning for CacheWriteQueue
+ */
+struct CacheWriteQueueConfig {
+    size_t max_pending = 10000;     // Writes beyond this are dropped
+    size_t max_batch = 64;          // Writes handed to one flush call
+};
+
+/**
+ * @brief Moves shared-cache writes off the request thread
+ *
+ * Requests enqueue encoded entries and return immediately; one writer
+ * thread drains the queue in batches, so a flush (e.g. one Redis pipeline)
+ * carries everything that queued up while the previous one ran. When the
+ * queue is full new writes are dropped: a lost cache write only costs a
+ * later miss, while blocking would put the cache backend back on the
+ * request path.
+ */
+class CacheWriteQueue {
+public:
+    /**
+     * @brief Writes a batch (e.g. RedisCache::writeBatch); exceptions are logged
+     */
+    using FlushFn = std::function<void(const std::vector<CacheWrite>& batch)>;
+
+    struct Stats {
+        size_t depth;           // Writes queued now
+        uint64_t enqueued;
+        uint64_t written;       // Handed to the flush function
+        uint64_t dropped;       // Rejected because the queue was full
+        uint64_t batches;
+    };
+
+    /**
+     * @param metrics Receives queue depth and drop counts (optional)
+     */
+    CacheWriteQueue(FlushFn flush, CacheWriteQueueConfig config = {},
+                    std::shared_ptr<SimpleMetrics> metrics = nullptr);
+
+    /**
+     * @brief Stops the writer after flushing what is already queued
+     */
+    ~CacheWriteQueue();
+
+    CacheWriteQueue(const CacheWriteQueue&) = delete;
+    CacheWriteQueue& operator=(const CacheWriteQueue&) = delete;
+
+    /**
+     * @brief Queue a write without blocking
+     * @return false if the queue was full and the write was dropped
+     */
+    bool enqueue(CacheWrite write);
+
+    Stats getStats();
+
+private:
+    FlushFn flush_;
+    CacheWriteQueueConfig config_;
+    std::shared_ptr<SimpleMetrics> metrics_;
+
+    std::deque<CacheWrite> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = true;               // Guarded by mutex_
+    std::thread writer_;
+
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> batches_{0};
+
+    void writerLoop();
+};
+
+} // namespace gateway
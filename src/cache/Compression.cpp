@@ -0,0 +1,216 @@
+#include "cache/Compression.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef ZLIB_AVAILABLE
+#include <zlib.h>
+#endif
+#ifdef BROTLI_AVAILABLE
+#include <brotli/encode.h>
+#include <brotli/decode.h>
+#endif
+
+namespace gateway {
+
+namespace {
+
+std::string trimLower(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t");
+    std::string out = value.substr(start, end - start + 1);
+    std::transform(out.begin(), out.end(), out.begin(), ::tolower);
+    return out;
+}
+
+#ifdef ZLIB_AVAILABLE
+std::optional<std::string> gzipCompress(std::string_view data, int level) {
+    z_stream stream{};
+    // 15 window bits + 16 selects the gzip wrapper
+    if (deflateInit2(&stream, level < 0 ? Z_DEFAULT_COMPRESSION : std::min(level, 9),
+                     Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::nullopt;
+    }
+
+    std::string out;
+    out.resize(deflateBound(&stream, static_cast<uLong>(data.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    int ret = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (ret != Z_STREAM_END) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+std::optional<std::string> gzipDecompress(std::string_view data, size_t max_size) {
+    z_stream stream{};
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return std::nullopt;
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+
+    std::string out;
+    char buffer[16384];
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            break;
+        }
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+        if (out.size() > max_size) {
+            ret = Z_BUF_ERROR;
+            break;
+        }
+    }
+    inflateEnd(&stream);
+    if (ret != Z_STREAM_END) {
+        return std::nullopt;
+    }
+    return out;
+}
+#endif
+
+#ifdef BROTLI_AVAILABLE
+std::optional<std::string> brotliCompress(std::string_view data, int level) {
+    std::string out;
+    size_t encoded_size = BrotliEncoderMaxCompressedSize(data.size());
+    out.resize(encoded_size > 0 ? encoded_size : data.size() + 1024);
+    if (!BrotliEncoderCompress(level < 0 ? BROTLI_DEFAULT_QUALITY : std::min(level, BROTLI_MAX_QUALITY),
+                               BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, data.size(),
+                               reinterpret_cast<const uint8_t*>(data.data()), &encoded_size,
+                               reinterpret_cast<uint8_t*>(out.data()))) {
+        return std::nullopt;
+    }
+    out.resize(encoded_size);
+    return out;
+}
+
+std::optional<std::string> brotliDecompress(std::string_view data, size_t max_size) {
+    BrotliDecoderState* state = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+    if (!state) {
+        return std::nullopt;
+    }
+
+    size_t available_in = data.size();
+    const uint8_t* next_in = reinterpret_cast<const uint8_t*>(data.data());
+    std::string out;
+    uint8_t buffer[16384];
+    BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+    while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT && out.size() <= max_size) {
+        size_t available_out = sizeof(buffer);
+        uint8_t* next_out = buffer;
+        result = BrotliDecoderDecompressStream(state, &available_in, &next_in,
+                                               &available_out, &next_out, nullptr);
+        out.append(reinterpret_cast<char*>(buffer), sizeof(buffer) - available_out);
+    }
+    BrotliDecoderDestroyInstance(state);
+    if (result != BROTLI_DECODER_RESULT_SUCCESS || out.size() > max_size) {
+        return std::nullopt;
+    }
+    return out;
+}
+#endif
+
+} // namespace
+
+bool Compression::isSupported(const std::string& coding) {
+#ifdef ZLIB_AVAILABLE
+    if (coding == "gzip") {
+        return true;
+    }
+#endif
+#ifdef BROTLI_AVAILABLE
+    if (coding == "br") {
+        return true;
+    }
+#endif
+    (void)coding;
+    return false;
+}
+
+std::optional<std::string> Compression::compress(const std::string& coding, std::string_view data,
+                                                 int level) {
+#ifdef ZLIB_AVAILABLE
+    if (coding == "gzip") {
+        return gzipCompress(data, level);
+    }
+#endif
+#ifdef BROTLI_AVAILABLE
+    if (coding == "br") {
+        return brotliCompress(data, level);
+    }
+#endif
+    (void)coding;
+    (void)data;
+    (void)level;
+    return std::nullopt;
+}
+
+std::optional<std::string> Compression::decompress(const std::string& coding, std::string_view data,
+                                                   size_t max_size) {
+#ifdef ZLIB_AVAILABLE
+    if (coding == "gzip") {
+        return gzipDecompress(data, max_size);
+    }
+#endif
+#ifdef BROTLI_AVAILABLE
+    if (coding == "br") {
+        return brotliDecompress(data, max_size);
+    }
+#endif
+    (void)coding;
+    (void)data;
+    (void)max_size;
+    return std::nullopt;
+}
+
+bool Compression::accepts(const std::string& accept_encoding, const std::string& coding) {
+    bool wildcard = false;
+    std::stringstream ss(accept_encoding);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        std::string name = item;
+        double q = 1.0;
+        size_t semi = item.find(';');
+        if (semi != std::string::npos) {
+            name = item.substr(0, semi);
+            std::string param = trimLower(item.substr(semi + 1));
+            if (param.rfind("q=", 0) == 0) {
+                q = std::atof(param.c_str() + 2);
+            }
+        }
+        name = trimLower(name);
+        if (name == coding || (coding == "gzip" && name == "x-gzip")) {
+            return q > 0;
+        }
+        if (name == "*") {
+            wildcard = q > 0;
+        }
+    }
+    return wildcard;
+}
+
+bool Compression::isCompressibleType(const std::string& content_type) {
+    std::string type = trimLower(content_type.substr(0, content_type.find(';')));
+    return type.rfind("text/", 0) == 0 ||
+           type == "application/json" || type == "application/javascript" ||
+           type == "application/xml" || type == "image/svg+xml" ||
+           (type.size() > 5 && (type.compare(type.size() - 5, 5, "+json") == 0 ||
+                                type.compare(type.size() - 4, 4, "+xml") == 0));
+}
+
+} // namespace gateway
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstddef>
+
+namespace gateway {
+
+/**
+ * @brief HTTP content codings for cached bodies
+ *
+ * "gzip" needs zlib (ZLIB_AVAILABLE) and "br" needs brotli
+ * (BROTLI_AVAILABLE); without them the coding is reported unsupported and
+ * bodies are cached uncompressed.
+ */
+class Compression {
+public:
+    /**
+     * @brief Whether this build can encode and decode a coding
+     */
+    static bool isSupported(const std::string& coding);
+
+    /**
+     * @brief Encode data
+     * @param level Codec-specific level (-1 = codec default)
+     * @return std::nullopt if the coding is unsupported or encoding failed
+     */
+    static std::optional<std::string> compress(const std::string& coding, std::string_view data,
+                                               int level = -1);
+
+    /**
+     * @brief Decode data
+     * @param max_size Output limit; larger results fail
+     * @return std::nullopt if the coding is unsupported or data is invalid
+     */
+    static std::optional<std::string> decompress(const std::string& coding, std::string_view data,
+                                                 size_t max_size);
+
+    /**
+     * @brief Whether an Accept-Encoding header value allows a coding
+     */
+    static bool accepts(const std::string& accept_encoding, const std::string& coding);
+
+    /**
+     * @brief Whether a Content-Type is worth compressing (text, JSON, XML, JS)
+     */
+    static bool isCompressibleType(const std::string& content_type);
+};
+
+} // namespace gateway
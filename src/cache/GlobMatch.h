@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+namespace gateway {
+
+/**
+ * @brief Match text against a pattern where '*' matches any run of
+ *        characters (including '*' itself); everything else is literal
+ *
+ * Iterative with a single backtrack point, so it is linear in practice and
+ * never recurses on hostile patterns.
+ */
+inline bool globMatch(const std::string& pattern, const std::string& text) {
+    size_t p = 0, t = 0, star = std::string::npos, mark = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            mark = t;
+        } else if (p < pattern.size() && pattern[p] == text[t]) {
+            p++;
+            t++;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            t = ++mark;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+} // namespace gateway
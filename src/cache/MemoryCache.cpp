@@ -0,0 +1,182 @@
+#include "cache/MemoryCache.h"
+#include "cache/GlobMatch.h"
+#include <algorithm>
+#include <functional>
+
+namespace gateway {
+
+namespace {
+// Rough per-entry bookkeeping cost (list node, index slot, control block)
+constexpr size_t ENTRY_OVERHEAD = 128;
+}
+
+MemoryCache::MemoryCache(size_t max_bytes, size_t shard_count, size_t max_entry_bytes)
+    : shard_count_(std::max<size_t>(shard_count, 1)) {
+    shards_ = std::make_unique<Shard[]>(shard_count_);
+    shard_budget_ = std::max<size_t>(max_bytes / shard_count_, 1);
+    max_entry_bytes_ = max_entry_bytes > 0 ? std::min(max_entry_bytes, shard_budget_) : shard_budget_;
+}
+
+std::shared_ptr<const MemoryCache::Entry> MemoryCache::get(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if (Clock::now() >= it->second->expires_at) {
+        eraseLocked(shard, it->second);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // Move to front
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->entry;
+}
+
+long long MemoryCache::Entry::staleForMs() const {
+    auto now = std::chrono::steady_clock::now();
+    if (now <= fresh_until) {
+        return 0;
+    }
+    return std::max<long long>(1, std::chrono::duration_cast<std::chrono::milliseconds>(now - fresh_until).count());
+}
+
+void MemoryCache::set(const std::string& key, Entry entry, int ttl_seconds, int stale_seconds) {
+    size_t bytes = key.size() * 2 + entry.body.size() + entry.content_type.size() + ENTRY_OVERHEAD;
+    for (const auto& [name, value] : entry.headers) {
+        bytes += name.size() + value.size();
+    }
+    for (const auto& tag : entry.tags) {
+        bytes += tag.size() + key.size();
+    }
+    if (ttl_seconds <= 0 || bytes > max_entry_bytes_) {
+        invalidate(key);
+        return;
+    }
+
+    auto now = Clock::now();
+    entry.fresh_until = now + std::chrono::seconds(ttl_seconds);
+    auto expires_at = entry.fresh_until + std::chrono::seconds(std::max(stale_seconds, 0));
+    auto shared = std::make_shared<const Entry>(std::move(entry));
+
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        eraseLocked(shard, it->second);
+    }
+
+    for (const auto& tag : shared->tags) {
+        shard.tags[tag].insert(key);
+    }
+    shard.lru.push_front({key, std::move(shared), expires_at, bytes});
+    shard.index[key] = shard.lru.begin();
+    shard.bytes += bytes;
+
+    // Plain LRU: evict from the cold end whether or not entries have expired;
+    // expired ones are otherwise dropped when a lookup finds them
+    while (shard.bytes > shard_budget_ && shard.lru.size() > 1) {
+        eraseLocked(shard, std::prev(shard.lru.end()));
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MemoryCache::invalidate(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        eraseLocked(shard, it->second);
+    }
+}
+
+size_t MemoryCache::invalidatePattern(const std::string& pattern) {
+    size_t removed = 0;
+    for (size_t i = 0; i < shard_count_; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        for (auto it = shard.lru.begin(); it != shard.lru.end();) {
+            auto next = std::next(it);
+            if (globMatch(pattern, it->key)) {
+                eraseLocked(shard, it);
+                removed++;
+            }
+            it = next;
+        }
+    }
+    return removed;
+}
+
+size_t MemoryCache::invalidateTag(const std::string& tag) {
+    size_t removed = 0;
+    for (size_t i = 0; i < shard_count_; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto tagged = shard.tags.find(tag);
+        if (tagged == shard.tags.end()) {
+            continue;
+        }
+        // eraseLocked() edits the tag index, so take the keys first
+        std::unordered_set<std::string> keys = std::move(tagged->second);
+        shard.tags.erase(tagged);
+        for (const auto& key : keys) {
+            auto it = shard.index.find(key);
+            if (it != shard.index.end()) {
+                eraseLocked(shard, it->second);
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
+
+void MemoryCache::clear() {
+    for (size_t i = 0; i < shard_count_; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.tags.clear();
+        shard.bytes = 0;
+    }
+}
+
+MemoryCache::Stats MemoryCache::getStats() {
+    Stats stats{0, 0, hits_.load(), misses_.load(), evictions_.load()};
+    for (size_t i = 0; i < shard_count_; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        stats.entries += shard.lru.size();
+        stats.bytes += shard.bytes;
+    }
+    return stats;
+}
+
+MemoryCache::Shard& MemoryCache::shardFor(const std::string& key) {
+    return shards_[std::hash<std::string>{}(key) % shard_count_];
+}
+
+void MemoryCache::eraseLocked(Shard& shard, std::list<Node>::iterator it) {
+    for (const auto& tag : it->entry->tags) {
+        auto tagged = shard.tags.find(tag);
+        if (tagged != shard.tags.end()) {
+            tagged->second.erase(it->key);
+            if (tagged->second.empty()) {
+                shard.tags.erase(tagged);
+            }
+        }
+    }
+    shard.bytes -= it->bytes;
+    shard.index.erase(it->key);
+    shard.lru.erase(it);
+}
+
+} // namespace gateway
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace gateway {
+
+/**
+ * @brief In-process response cache (L1) with a byte budget
+ *
+ * Keys hash to one of N shards, each an LRU list under its own mutex with
+ * an equal share of the byte budget. Entries expire by TTL and the least
+ * recently used entries are evicted once a shard is over budget. Hits hand
+ * out a shared pointer, so the body is never copied under the lock.
+ *
+ * An entry is fresh for its TTL and then kept, stale, for an extra grace
+ * period so callers can serve it while revalidating or when the backend
+ * fails. Entries can carry tags; each shard indexes keys by tag so purging
+ * a tag touches only the entries that have it.
+ */
+class MemoryCache {
+public:
+    struct Entry {
+        std::string body;
+        std::string content_type;
+        int status_code;
+        std::map<std::string, std::string> headers{};
+        std::vector<std::string> tags{};                        // For invalidateTag()
+        std::chrono::steady_clock::time_point fresh_until{};   // Set by set()
+
+        /**
+         * @brief Milliseconds past the fresh TTL (0 while fresh)
+         */
+        long long staleForMs() const;
+    };
+
+    struct Stats {
+        size_t entries;
+        size_t bytes;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+    };
+
+    /**
+     * @brief Constructor
+     * @param max_bytes Total budget for keys and bodies
+     * @param shard_count Number of independently locked shards
+     * @param max_entry_bytes Larger entries are not cached (0 = shard budget)
+     */
+    explicit MemoryCache(size_t max_bytes, size_t shard_count = 16, size_t max_entry_bytes = 0);
+
+    MemoryCache(const MemoryCache&) = delete;
+    MemoryCache& operator=(const MemoryCache&) = delete;
+
+    /**
+     * @brief Get a cached entry (possibly stale), or nullptr if missing or expired
+     */
+    std::shared_ptr<const Entry> get(const std::string& key);
+
+    /**
+     * @brief Store an entry
+     * @param ttl_seconds Time the entry is fresh (<= 0 is not cached)
+     * @param stale_seconds Extra time a stale copy is kept
+     */
+    void set(const std::string& key, Entry entry, int ttl_seconds, int stale_seconds = 0);
+
+    /**
+     * @brief Remove one entry
+     */
+    void invalidate(const std::string& key);
+
+    /**
+     * @brief Remove entries whose key matches a glob pattern ('*' only)
+     * @return Number of entries removed
+     */
+    size_t invalidatePattern(const std::string& pattern);
+
+    /**
+     * @brief Remove every entry carrying a tag
+     * @return Number of entries removed
+     */
+    size_t invalidateTag(const std::string& tag);
+
+    /**
+     * @brief Remove every entry
+     */
+    void clear();
+
+    Stats getStats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Node {
+        std::string key;
+        std::shared_ptr<const Entry> entry;
+        Clock::time_point expires_at;
+        size_t bytes;
+    };
+
+    struct Shard {
+        std::mutex mtx;
+        std::list<Node> lru;        // Most recently used first
+        std::unordered_map<std::string, std::list<Node>::iterator> index;
+        std::unordered_map<std::string, std::unordered_set<std::string>> tags;    // Tag -> keys
+        size_t bytes = 0;
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_count_;
+    size_t shard_budget_;
+    size_t max_entry_bytes_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    Shard& shardFor(const std::string& key);
+
+    /**
+     * @brief Unlink a node (caller holds shard lock)
+     */
+    static void eraseLocked(Shard& shard, std::list<Node>::iterator it);
+};
+
+} // namespace gateway
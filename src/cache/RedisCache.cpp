@@ -1,12 +1,27 @@
 #include "cache/RedisCache.h"
-#include <nlohmann/json.hpp>
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 
-using json = nlohmann::json;
-
 namespace gateway {
 
+namespace {
+
+// Index KEYS[1] under a tag set and keep the set alive for at least ARGV[2]
+// seconds. The TTL is only ever extended: a short-lived entry (e.g. a
+// negative cache hit) must not expire the index of longer-lived ones.
+const char* const TAG_SCRIPT = R"lua(
+local tag = KEYS[1]
+local retention = tonumber(ARGV[2])
+redis.call('SADD', tag, ARGV[1])
+if redis.call('TTL', tag) < retention then
+    redis.call('EXPIRE', tag, retention)
+end
+return 1
+)lua";
+
+} // namespace
+
 RedisCache::RedisCache(const std::string& redis_uri, const std::string& password,
                        const std::string& key_prefix)
     : key_prefix_(key_prefix) {
@@ -32,6 +47,7 @@ RedisCache::RedisCache(const std::string& redis_uri, const std::string& password
 
         redis_ = std::make_unique<sw::redis::Redis>(opts);
         redis_->ping();
+        tag_script_sha_ = redis_->script_load(TAG_SCRIPT);
         std::cout << "Cache: Connected to Redis at " << opts.host << ":" << opts.port << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Failed to connect to Redis for caching: " << e.what() << std::endl;
@@ -40,12 +56,33 @@ RedisCache::RedisCache(const std::string& redis_uri, const std::string& password
 }
 
 std::optional<RedisCache::CachedResponse> RedisCache::get(const std::string& key) {
+    auto record = getRecord(key);
+    if (!record) {
+        return std::nullopt;
+    }
+
+    const CacheRecordView& view = record->view();
+    CachedResponse response;
+    response.body = std::string(view.body);
+    response.content_type = std::string(view.content_type);
+    response.status_code = view.status_code;
+    response.cached_at = view.cached_at;
+    response.fresh_until = view.fresh_until;
+    for (const auto& [name, value] : view.headers) {
+        response.headers.emplace(name, value);
+    }
+    response.tags.assign(view.tags.begin(), view.tags.end());
+    return response;
+}
+
+std::optional<CacheRecord> RedisCache::getRecord(const std::string& key) {
     try {
         std::string full_key = getFullKey(key);
         auto value = redis_->get(full_key);
 
         if (value) {
-            return deserializeResponse(*value);
+            // Values that do not decode (e.g. an older format) are misses
+            return CacheRecord::fromBuffer(std::move(*value));
         }
         return std::nullopt;
     } catch (const std::exception& e) {
@@ -54,14 +91,74 @@ std::optional<RedisCache::CachedResponse> RedisCache::get(const std::string& key
     }
 }
 
-void RedisCache::set(const std::string& key, const CachedResponse& response, int ttl_seconds) {
+void RedisCache::set(const std::string& key, const CachedResponse& response, int ttl_seconds,
+                     int stale_seconds) {
+    writeBatch({prepareWrite(key, response, ttl_seconds, stale_seconds)});
+}
+
+CacheWrite RedisCache::prepareWrite(const std::string& key, const CachedResponse& response,
+                                    int ttl_seconds, int stale_seconds) {
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+
+    CacheWrite write;
+    write.key = getFullKey(key);
+    write.value = serializeResponse(response, now_ms + ttl_seconds * 1000LL);
+    write.retention_seconds = ttl_seconds + std::max(stale_seconds, 0);
+    write.tags = response.tags;
+    return write;
+}
+
+void RedisCache::writeBatch(const std::vector<CacheWrite>& batch) {
+    if (batch.empty()) {
+        return;
+    }
     try {
-        std::string full_key = getFullKey(key);
-        std::string serialized = serializeResponse(response);
+        if (batch.size() == 1 && batch[0].tags.empty()) {
+            redis_->setex(batch[0].key, std::chrono::seconds(batch[0].retention_seconds), batch[0].value);
+            return;
+        }
 
-        redis_->setex(full_key, std::chrono::seconds(ttl_seconds), serialized);
+        // Tag sets live as long as the longest-lived entry in them; members
+        // whose key already expired are harmless and dropped on the next purge
+        // Returns false if Redis lost the tag script. A pipeline reports a
+        // failed command only in its reply, never from exec()
+        auto exec = [&]() {
+            auto pipe = redis_->pipeline();
+            std::vector<size_t> script_replies;
+            size_t commands = 0;
+            for (const auto& write : batch) {
+                auto retention = std::chrono::seconds(write.retention_seconds);
+                pipe.setex(write.key, retention, write.value);
+                commands++;
+                for (const auto& tag : write.tags) {
+                    pipe.evalsha(tag_script_sha_, {getTagKey(tag)},
+                                 {write.key, std::to_string(write.retention_seconds)});
+                    script_replies.push_back(commands++);
+                }
+            }
+            auto replies = pipe.exec();
+            for (size_t index : script_replies) {
+                try {
+                    replies.get<long long>(index);
+                } catch (const sw::redis::ReplyError& e) {
+                    if (std::string(e.what()).find("NOSCRIPT") == std::string::npos) {
+                        throw;
+                    }
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (!exec()) {
+            // Script cache flushed or server restarted; SETEX and SADD are
+            // idempotent, so replaying the whole batch is safe
+            redis_->script_load(TAG_SCRIPT);
+            exec();
+        }
     } catch (const std::exception& e) {
-        std::cerr << "Cache set error: " << e.what() << std::endl;
+        std::cerr << "Cache set error (" << batch.size() << " entries): " << e.what() << std::endl;
     }
 }
 
@@ -99,6 +196,26 @@ void RedisCache::invalidatePattern(const std::string& pattern) {
     }
 }
 
+long long RedisCache::invalidateTag(const std::string& tag) {
+    long long deleted = 0;
+    try {
+        std::string tag_key = getTagKey(tag);
+        // SPOP in batches so keys tagged during the purge are not lost
+        while (true) {
+            std::vector<std::string> keys;
+            redis_->spop(tag_key, 500, std::back_inserter(keys));
+            if (keys.empty()) {
+                break;
+            }
+            deleted += redis_->del(keys.begin(), keys.end());
+        }
+        std::cout << "Cache: Purged " << deleted << " keys tagged " << tag << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Cache invalidate tag error: " << e.what() << std::endl;
+    }
+    return deleted;
+}
+
 void RedisCache::clear() {
     try {
         invalidatePattern("*");
@@ -149,36 +266,19 @@ std::string RedisCache::getFullKey(const std::string& key) const {
     return key_prefix_ + key;
 }
 
-std::string RedisCache::serializeResponse(const CachedResponse& response) {
+std::string RedisCache::getTagKey(const std::string& tag) const {
+    // Cache keys start with a method, so this never collides with one
+    return key_prefix_ + "tag:" + tag;
+}
+
+std::string RedisCache::serializeResponse(const CachedResponse& response, long long fresh_until) {
     auto now = std::chrono::system_clock::now();
     auto cached_at = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()
     ).count();
 
-    json j;
-    j["body"] = response.body;
-    j["content_type"] = response.content_type;
-    j["status_code"] = response.status_code;
-    j["cached_at"] = cached_at;
-
-    return j.dump();
-}
-
-std::optional<RedisCache::CachedResponse> RedisCache::deserializeResponse(const std::string& data) {
-    try {
-        json j = json::parse(data);
-
-        CachedResponse response;
-        response.body = j["body"].get<std::string>();
-        response.content_type = j["content_type"].get<std::string>();
-        response.status_code = j["status_code"].get<int>();
-        response.cached_at = j["cached_at"].get<long long>();
-
-        return response;
-    } catch (const std::exception& e) {
-        std::cerr << "Cache deserialize error: " << e.what() << std::endl;
-        return std::nullopt;
-    }
+    return CacheCodec::encode(response.status_code, cached_at, fresh_until,
+                              response.content_type, response.headers, response.tags, response.body);
 }
 
 } // namespace gateway
@@ -3,14 +3,20 @@
 #include <string>
 #include <memory>
 #include <optional>
+#include <map>
+#include <vector>
 #include <sw/redis++/redis++.h>
+#include "cache/CacheCodec.h"
+#include "cache/CacheWriteQueue.h"
 
 namespace gateway {
 
 /**
  * @brief Redis-backed response cache with TTL support
  *
- * Caches HTTP responses in Redis to reduce backend load
+ * Caches HTTP responses in Redis to reduce backend load. Entries can be
+ * tagged; each tag is a Redis set of the keys written with it, so purging
+ * a tag costs time proportional to its entries rather than a keyspace SCAN.
  */
 class RedisCache {
 public:
@@ -19,6 +25,9 @@ public:
         std::string content_type;
         int status_code;
         long long cached_at;  // Unix timestamp in milliseconds
+        long long fresh_until = 0;  // Unix ms after which the entry is stale (0 = never)
+        std::map<std::string, std::string> headers{};
+        std::vector<std::string> tags{};    // Also indexed for invalidateTag()
     };
 
     /**
@@ -38,13 +47,33 @@ public:
      */
     std::optional<CachedResponse> get(const std::string& key);
 
+    /**
+     * @brief Get cached response without copying it out of the Redis reply
+     * @param key Cache key
+     * @return Decoded record if found, std::nullopt otherwise
+     */
+    std::optional<CacheRecord> getRecord(const std::string& key);
+
     /**
      * @brief Store response in cache
      * @param key Cache key
      * @param response Response to cache
-     * @param ttl_seconds Time to live in seconds
+     * @param ttl_seconds Time the entry is fresh, in seconds
+     * @param stale_seconds Extra time Redis keeps the stale copy
+     */
+    void set(const std::string& key, const CachedResponse& response, int ttl_seconds,
+             int stale_seconds = 0);
+
+    /**
+     * @brief Encode a response for writeBatch() (no Redis access)
      */
-    void set(const std::string& key, const CachedResponse& response, int ttl_seconds);
+    CacheWrite prepareWrite(const std::string& key, const CachedResponse& response, int ttl_seconds,
+                            int stale_seconds = 0);
+
+    /**
+     * @brief Write entries and their tag index in one pipeline
+     */
+    void writeBatch(const std::vector<CacheWrite>& batch);
 
     /**
      * @brief Invalidate cache entry
@@ -58,6 +87,13 @@ public:
      */
     void invalidatePattern(const std::string& pattern);
 
+    /**
+     * @brief Invalidate all cache entries written with a tag
+     * @param tag Tag given in CachedResponse::tags
+     * @return Number of keys deleted
+     */
+    long long invalidateTag(const std::string& tag);
+
     /**
      * @brief Clear all cached entries
      */
@@ -80,10 +116,11 @@ public:
 private:
     std::unique_ptr<sw::redis::Redis> redis_;
     std::string key_prefix_;
+    std::string tag_script_sha_;  // SHA1 of the tag index script
 
     std::string getFullKey(const std::string& key) const;
-    std::string serializeResponse(const CachedResponse& response);
-    std::optional<CachedResponse> deserializeResponse(const std::string& data);
+    std::string getTagKey(const std::string& tag) const;
+    std::string serializeResponse(const CachedResponse& response, long long fresh_until);
 };
 
 } // namespace gateway
@@ -15,9 +15,12 @@
 #include "logging/Logger.h"
 #include "config/ConfigManager.h"
 #include "admin/AdminAPI.h"
+#include "cache/MemoryCache.h"
+#include "cache/Compression.h"
 #ifdef REDIS_PLUS_PLUS_AVAILABLE
 #include "cache/RedisCache.h"
 #include "rate_limiter/RedisRateLimiter.h"
+#include "rate_limiter/LeasedRateLimiter.h"
 #endif
 #include <nlohmann/json.hpp>
 
@@ -49,6 +52,51 @@ static bool getEnvBool(const char* name, bool default_val = false) {
     return s == "true" || s == "1";
 }
 
+#ifdef REDIS_PLUS_PLUS_AVAILABLE
+// Helper: read the distributed limits out of the rate_limits config once
+static RedisRateLimits compileRedisRateLimits(const json& rate_limits) {
+    auto toLimit = [](const json& j) {
+        return RedisRateLimits::Limit{j["requests"].get<int>(), j["window"].get<int>()};
+    };
+
+    RedisRateLimits limits;
+    if (rate_limits.contains("global")) {
+        limits.global = toLimit(rate_limits["global"]);
+    }
+    if (rate_limits.contains("per_ip")) {
+        limits.per_ip = toLimit(rate_limits["per_ip"]);
+    }
+    if (rate_limits.contains("endpoints") && rate_limits["endpoints"].is_object()) {
+        for (auto& [endpoint, limit] : rate_limits["endpoints"].items()) {
+            limits.endpoints[endpoint] = toLimit(limit);
+        }
+    }
+    return limits;
+}
+#endif
+
+// Helper: L1 cache stats for the Admin API
+static json memoryCacheStatsJson(MemoryCache& cache) {
+    auto stats = cache.getStats();
+    return json{
+        {"entries", stats.entries},
+        {"bytes", stats.bytes},
+        {"hits", stats.hits},
+        {"misses", stats.misses},
+        {"evictions", stats.evictions}
+    };
+}
+
+// Helper: L1 cache entry as the server's cached response
+static HttpServer::CachedResponse fromMemoryCache(const MemoryCache::Entry& entry) {
+    return HttpServer::CachedResponse{entry.body, entry.content_type, entry.status_code, entry.staleForMs(),
+                                      entry.headers};
+}
+
+static MemoryCache::Entry toMemoryCache(const HttpServer::CachedResponse& resp) {
+    return MemoryCache::Entry{resp.body, resp.content_type, resp.status_code, resp.headers, resp.tags};
+}
+
 void printBanner() {
     std::cout << R"(
 ╔═══════════════════════════════════════════════════════════════╗
@@ -249,6 +297,31 @@ int main(int argc, char* argv[]) {
 
         // Router
         auto router = std::make_shared<Router>();
+        if (config.contains("cache")) {
+            // Per-route "cache" blocks in routes.json override these
+            const auto& cache_cfg = config["cache"];
+            RouteCachePolicy cache_defaults;
+            cache_defaults.ttl_seconds = cache_cfg.value("default_ttl", cache_defaults.ttl_seconds);
+            cache_defaults.max_entry_bytes = cache_cfg.value("max_entry_size", cache_defaults.max_entry_bytes);
+            if (cache_cfg.contains("cacheable_status_codes")) {
+                RouteCachePolicy::assignStatuses(cache_defaults.statuses,
+                                                 cache_cfg["cacheable_status_codes"].get<std::vector<int>>());
+            }
+
+            // Negative caching: short-lived 404/5xx entries and memoized route misses
+            auto negative_cfg = cache_cfg.value("negative", nlohmann::json::object());
+            if (negative_cfg.value("enabled", false)) {
+                cache_defaults.negative_ttl_seconds = negative_cfg.value("ttl", 10);
+                RouteCachePolicy::assignStatuses(cache_defaults.negative_statuses,
+                                                 negative_cfg.value("statuses", std::vector<int>{404}));
+                size_t route_misses = negative_cfg.value("route_miss_cache", static_cast<size_t>(4096));
+                router->setMissCacheSize(route_misses);
+                std::cout << "  ✓ Negative caching (TTL=" << cache_defaults.negative_ttl_seconds
+                          << "s, " << route_misses << " route misses per thread)\n";
+            }
+            router->setCacheDefaults(cache_defaults,
+                                     cache_cfg.value("exclude_paths", std::vector<std::string>{}));
+        }
         int routes_loaded = router->loadRoutes(routes_config.dump());
         std::cout << "  ✓ Router initialized (" << routes_loaded << " routes loaded)\n";
 
@@ -303,12 +376,69 @@ int main(int argc, char* argv[]) {
             cb_failure_threshold = config["backends"]["circuit_breaker"].value("failure_threshold", 5);
             cb_recovery_timeout = config["backends"]["circuit_breaker"].value("recovery_timeout", 60);
         }
-        auto proxy_manager = std::make_shared<ProxyManager>(cb_failure_threshold, cb_recovery_timeout);
+        ConnectionPoolConfig pool_config;
+        if (config.contains("backends") && config["backends"].contains("connection_pool")) {
+            auto& pool_json = config["backends"]["connection_pool"];
+            pool_config.min_idle = pool_json.value("min_idle", pool_config.min_idle);
+            pool_config.max_idle = pool_json.value("max_idle", pool_config.max_idle);
+            pool_config.idle_timeout_seconds = pool_json.value("idle_timeout", pool_config.idle_timeout_seconds);
+            pool_config.max_requests_per_connection = pool_json.value(
+                "max_requests_per_connection", pool_config.max_requests_per_connection);
+        }
+        auto proxy_manager = std::make_shared<ProxyManager>(cb_failure_threshold, cb_recovery_timeout, pool_config);
+        router->setInFlightProvider([proxy_manager](int backend_id) {
+            return proxy_manager->getInFlight(backend_id);
+        });
         std::cout << "  ✓ Proxy Manager initialized (circuit breaker: threshold="
                   << cb_failure_threshold << ", recovery=" << cb_recovery_timeout << "s)\n";
+        std::cout << "  ✓ Upstream connection pool (max_idle=" << pool_config.max_idle
+                  << ", idle_timeout=" << pool_config.idle_timeout_seconds << "s)\n";
 
         // HTTP Server
         auto server = std::make_shared<HttpServer>(host, port, max_connections);
+        server->setRequestCoalescing(config["server"].value("request_coalescing", true));
+        server->setStreamBufferSize(config["server"].value("stream_buffer_size", static_cast<size_t>(256 * 1024)));
+        server->setMaxStreams(config["server"].value("max_streams", static_cast<size_t>(256)));
+
+        // Worker threads and a bounded connection queue; overflow is shed with 503
+        WorkerPoolConfig worker_config;
+        worker_config.threads = config["server"].value("worker_threads", worker_config.threads);
+        worker_config.queue_depth = config["server"].value("queue_depth", worker_config.queue_depth);
+        worker_config.shed_queue_depth = config["server"].value("shed_queue_depth", worker_config.shed_queue_depth);
+        server->setWorkerPool(worker_config);
+        auto keep_alive_cfg = config["server"].value("keep_alive", nlohmann::json::object());
+        server->setKeepAlive(keep_alive_cfg.value("max_requests", static_cast<size_t>(100)),
+                             keep_alive_cfg.value("timeout", 5));
+        std::cout << "  ✓ Worker pool ("
+                  << (worker_config.threads ? std::to_string(worker_config.threads) : std::string("auto"))
+                  << " threads, queue depth " << worker_config.queue_depth << ")\n";
+
+        // SO_REUSEPORT acceptor shards, each with its own slice of the workers
+        size_t acceptors = config["server"].value("acceptors", static_cast<size_t>(1));
+        if (acceptors == 0) {
+            acceptors = std::max(1u, std::thread::hardware_concurrency());
+        }
+        bool pin_cpus = config["server"].value("pin_cpus", false);
+        server->setAcceptors(acceptors, pin_cpus);
+        if (acceptors > 1 || pin_cpus) {
+            std::cout << "  ✓ " << acceptors << " acceptor shard(s)" << (pin_cpus ? ", pinned to CPUs" : "") << "\n";
+        }
+
+        // Optional epoll front end: loops own the sockets, workers run requests
+        auto event_loop_cfg = config["server"].value("event_loop", nlohmann::json::object());
+        if (event_loop_cfg.value("enabled", false)) {
+            EventLoopConfig loop_config;
+            loop_config.loops = event_loop_cfg.value("loops", loop_config.loops);
+            loop_config.max_connections = static_cast<size_t>(max_connections);
+            loop_config.max_header_bytes = event_loop_cfg.value("max_header_bytes", static_cast<size_t>(16384));
+            loop_config.max_body_bytes = static_cast<size_t>(max_body_size);
+            loop_config.read_timeout = config["server"].value("request_timeout", loop_config.read_timeout);
+            loop_config.pin_cpus = pin_cpus;
+            server->setEventLoop(loop_config);
+            std::cout << "  ✓ Event loop mode ("
+                      << (loop_config.loops ? std::to_string(loop_config.loops) : std::string("auto"))
+                      << " loops)\n";
+        }
 
         // Enable TLS BEFORE registering any handlers (SSLServer must exist first)
         if (config["server"]["tls"]["enabled"].get<bool>()) {
@@ -346,7 +476,10 @@ int main(int argc, char* argv[]) {
 
         if (admin_enabled && !admin_token.empty()) {
             admin_api = std::make_shared<AdminAPI>();
-            admin_api->registerEndpoints(server->getInternalServer(), admin_token);
+            admin_api->registerEndpoints([&server](const std::string& method, const std::string& path,
+                                                   httplib::Server::Handler handler) {
+                server->addLocalRoute(method, path, std::move(handler));
+            }, admin_token);
             admin_api->setCurrentConfig(config);
 
             // Wire config update callback — dispatches live config changes
@@ -460,10 +593,50 @@ int main(int argc, char* argv[]) {
         // Now register catch-all handlers (must come AFTER admin routes)
         server->initialize(jwt_manager, rate_limiter, router, security_validator, logger, proxy_manager);
 
+        // ── In-process L1 response cache ─────────────────────────────
+        bool cache_enabled = config.contains("cache") && config["cache"].value("enabled", false);
+        int cache_ttl = config.contains("cache") ? config["cache"].value("default_ttl", 300) : 300;
+        json l1_cfg = cache_enabled ? config["cache"].value("l1", json::object()) : json::object();
+        std::shared_ptr<MemoryCache> l1_cache;
+        bool cache_wired = false;
+
+        if (cache_enabled) {
+            if (l1_cfg.value("enabled", true)) {
+                size_t l1_bytes = l1_cfg.value("max_bytes", static_cast<size_t>(64 * 1024 * 1024));
+                size_t l1_shards = l1_cfg.value("shards", static_cast<size_t>(16));
+                size_t max_entry = config["cache"].value("max_entry_size", static_cast<size_t>(1048576));
+                l1_cache = std::make_shared<MemoryCache>(l1_bytes, l1_shards, max_entry);
+                std::cout << "  ✓ L1 memory cache enabled (" << (l1_bytes >> 20) << " MiB, "
+                          << l1_shards << " shards)\n";
+            }
+        }
+
+        if (cache_enabled) {
+            int stale_while_revalidate = config["cache"].value("stale_while_revalidate", 0);
+            int stale_if_error = config["cache"].value("stale_if_error", 0);
+            server->setCacheStaleness(stale_while_revalidate, stale_if_error);
+            if (stale_while_revalidate > 0 || stale_if_error > 0) {
+                std::cout << "  ✓ Stale cache serving (while-revalidate=" << stale_while_revalidate
+                          << "s, if-error=" << stale_if_error << "s)\n";
+            }
+
+            auto compression_cfg = config["cache"].value("compression", nlohmann::json::object());
+            if (compression_cfg.value("enabled", false)) {
+                std::string coding = compression_cfg.value("encoding", "gzip");
+                if (Compression::isSupported(coding)) {
+                    server->setCacheCompression(coding, compression_cfg.value("min_size", 1024),
+                                                compression_cfg.value("level", -1));
+                    std::cout << "  ✓ Cache compression (" << coding << ")\n";
+                } else {
+                    std::cerr << "  ✗ Cache compression '" << coding
+                              << "' not available in this build, storing bodies uncompressed\n";
+                }
+            }
+        }
+
         // ── Redis Cache + Distributed Rate Limiter (Task 3) ──────────
 #ifdef REDIS_PLUS_PLUS_AVAILABLE
         bool redis_enabled = config.contains("redis") && config["redis"].value("enabled", false);
-        bool cache_enabled = config.contains("cache") && config["cache"].value("enabled", false);
 
         if (redis_enabled) {
             std::string redis_uri = config["redis"].value("uri", std::string("tcp://127.0.0.1:6379"));
@@ -471,45 +644,121 @@ int main(int argc, char* argv[]) {
 
             try {
                 if (cache_enabled) {
-                    int cache_ttl = config.contains("cache") ? config["cache"].value("default_ttl", 300) : 300;
                     auto redis_cache = std::make_shared<RedisCache>(redis_uri, redis_pass);
+                    int l1_max_ttl = l1_cfg.value("max_ttl", 60);
+                    bool l1_write_through = l1_cfg.value("write_through", true);
+
+                    // Redis writes go through a background queue so requests never wait on SETEX
+                    std::shared_ptr<CacheWriteQueue> cache_writer;
+                    auto write_cfg = config["cache"].value("write_queue", nlohmann::json::object());
+                    if (write_cfg.value("enabled", true)) {
+                        CacheWriteQueueConfig queue_cfg;
+                        queue_cfg.max_pending = write_cfg.value("max_pending", queue_cfg.max_pending);
+                        queue_cfg.max_batch = write_cfg.value("max_batch", queue_cfg.max_batch);
+                        cache_writer = std::make_shared<CacheWriteQueue>(
+                            [redis_cache](const std::vector<CacheWrite>& batch) {
+                                redis_cache->writeBatch(batch);
+                            },
+                            queue_cfg, server->getMetrics());
+                    }
 
-                    // Wire cache into HttpServer via function callbacks
+                    // Wire cache into HttpServer via function callbacks: L1 first, then Redis.
+                    // Redis hits are copied into L1 for at most l1_max_ttl, bounding how
+                    // stale a node can be after another node updates Redis.
                     server->setCache(
-                        [redis_cache](const std::string& key) -> std::optional<HttpServer::CachedResponse> {
-                            auto cached = redis_cache->get(key);
-                            if (cached) {
+                        [redis_cache, l1_cache, l1_max_ttl](const std::string& key)
+                            -> std::optional<HttpServer::CachedResponse> {
+                            if (l1_cache) {
+                                if (auto hit = l1_cache->get(key)) {
+                                    return fromMemoryCache(*hit);
+                                }
+                            }
+                            auto record = redis_cache->getRecord(key);
+                            if (record) {
+                                const CacheRecordView& cached = record->view();
                                 HttpServer::CachedResponse resp;
-                                resp.body = cached->body;
-                                resp.content_type = cached->content_type;
-                                resp.status_code = cached->status_code;
+                                resp.body = std::string(cached.body);
+                                resp.content_type = std::string(cached.content_type);
+                                resp.status_code = cached.status_code;
+                                for (const auto& [name, value] : cached.headers) {
+                                    resp.headers.emplace(name, value);
+                                }
+                                // Kept so the L1 copy can be purged by tag too
+                                resp.tags.assign(cached.tags.begin(), cached.tags.end());
+
+                                auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    std::chrono::system_clock::now().time_since_epoch()).count();
+                                long long fresh_ms = cached.fresh_until > 0 ? cached.fresh_until - now_ms
+                                                                            : l1_max_ttl * 1000LL;
+                                if (fresh_ms <= 0) {
+                                    resp.stale_ms = std::max(1LL, -fresh_ms);
+                                } else if (l1_cache) {
+                                    // Only fresh entries are promoted, and never past their Redis freshness
+                                    int l1_ttl = static_cast<int>(std::min<long long>(l1_max_ttl, fresh_ms / 1000));
+                                    l1_cache->set(key, toMemoryCache(resp), l1_ttl);
+                                }
                                 return resp;
                             }
                             return std::nullopt;
                         },
-                        [redis_cache](const std::string& key, const HttpServer::CachedResponse& resp, int ttl) {
+                        [redis_cache, l1_cache, l1_max_ttl, l1_write_through, cache_writer](
+                            const std::string& key, const HttpServer::CachedResponse& resp, int ttl, int stale_ttl) {
+                            if (l1_cache) {
+                                // L1 keeps a stale copy only when it is not capped below the real TTL
+                                if (ttl <= l1_max_ttl) {
+                                    l1_cache->set(key, toMemoryCache(resp), ttl, stale_ttl);
+                                } else {
+                                    l1_cache->set(key, toMemoryCache(resp), l1_max_ttl);
+                                }
+                                if (!l1_write_through) {
+                                    return;
+                                }
+                            }
                             RedisCache::CachedResponse cr;
                             cr.body = resp.body;
                             cr.content_type = resp.content_type;
                             cr.status_code = resp.status_code;
                             cr.cached_at = 0;
-                            redis_cache->set(key, cr, ttl);
-                        },
-                        cache_ttl
+                            cr.headers = resp.headers;
+                            cr.tags = resp.tags;
+                            if (cache_writer) {
+                                cache_writer->enqueue(redis_cache->prepareWrite(key, cr, ttl, stale_ttl));
+                            } else {
+                                redis_cache->set(key, cr, ttl, stale_ttl);
+                            }
+                        }
                     );
+                    cache_wired = true;
 
                     // Wire cache stats and clear to Admin API
                     if (admin_api) {
-                        admin_api->setCacheStatsCallback([redis_cache]() -> nlohmann::json {
+                        admin_api->setCacheStatsCallback([redis_cache, l1_cache, cache_writer]() -> nlohmann::json {
                             auto stats = redis_cache->getStats();
-                            return nlohmann::json{
+                            nlohmann::json result{
                                 {"total_keys", stats.total_keys},
                                 {"memory_usage_bytes", stats.memory_usage},
                                 {"connected", redis_cache->isConnected()}
                             };
+                            if (l1_cache) {
+                                result["l1"] = memoryCacheStatsJson(*l1_cache);
+                            }
+                            if (cache_writer) {
+                                auto writes = cache_writer->getStats();
+                                result["write_queue"] = {
+                                    {"depth", writes.depth},
+                                    {"enqueued", writes.enqueued},
+                                    {"written", writes.written},
+                                    {"dropped", writes.dropped},
+                                    {"batches", writes.batches}
+                                };
+                            }
+                            return result;
                         });
 
-                        admin_api->setCacheClearCallback([redis_cache](const std::string& pattern) -> int {
+                        admin_api->setCacheClearCallback([redis_cache, l1_cache](const std::string& pattern) -> int {
+                            if (l1_cache) {
+                                l1_cache->invalidatePattern(pattern);
+                            }
                             auto before = redis_cache->getStats().total_keys;
                             if (pattern == "*") {
                                 redis_cache->clear();
@@ -519,57 +768,80 @@ int main(int argc, char* argv[]) {
                             auto after = redis_cache->getStats().total_keys;
                             return static_cast<int>(before - after);
                         });
+
+                        admin_api->setCachePurgeCallback([redis_cache, l1_cache](const std::vector<std::string>& tags) -> int {
+                            long long purged = 0;
+                            for (const auto& tag : tags) {
+                                if (l1_cache) {
+                                    l1_cache->invalidateTag(tag);
+                                }
+                                purged += redis_cache->invalidateTag(tag);
+                            }
+                            return static_cast<int>(purged);
+                        });
                     }
 
-                    std::cout << "  ✓ Redis Cache enabled (TTL=" << cache_ttl << "s)\n";
+                    std::cout << "  ✓ Redis Cache enabled (default TTL=" << cache_ttl << "s)\n";
                 }
 
-                auto redis_rate_limiter = std::make_shared<RedisRateLimiter>(redis_uri, redis_pass);
-                std::cout << "  ✓ Redis Rate Limiter connected\n";
-
-                // Wire distributed rate limiter into the request pipeline
-                // Replicates multi-level checks (global, per-ip, per-endpoint) via Redis
-                auto rl_config = rate_limits; // capture config
-                server->setDistributedRateLimiter(
-                    [redis_rate_limiter, rl_config](const std::string& client_ip,
-                                                    const std::string& endpoint)
-                        -> std::pair<bool, int> {
-                        // Global check
-                        if (rl_config.contains("global")) {
-                            int max_req = rl_config["global"]["requests"].get<int>();
-                            int window  = rl_config["global"]["window"].get<int>();
-                            if (!redis_rate_limiter->allowRequest("global", max_req, window)) {
-                                return {false, window};
-                            }
-                        }
-                        // Per-IP check
-                        if (rl_config.contains("per_ip")) {
-                            int max_req = rl_config["per_ip"]["requests"].get<int>();
-                            int window  = rl_config["per_ip"]["window"].get<int>();
-                            if (!redis_rate_limiter->allowRequest("ip:" + client_ip, max_req, window)) {
-                                return {false, window};
-                            }
-                        }
-                        // Per-endpoint check
-                        if (rl_config.contains("endpoints") && rl_config["endpoints"].is_object()) {
-                            auto it = rl_config["endpoints"].find(endpoint);
-                            if (it != rl_config["endpoints"].end()) {
-                                int max_req = (*it)["requests"].get<int>();
-                                int window  = (*it)["window"].get<int>();
-                                if (!redis_rate_limiter->allowRequest(
-                                        "ep:" + client_ip + ":" + endpoint, max_req, window)) {
-                                    return {false, window};
-                                }
-                            }
-                        }
-                        return {true, 0};
-                    });
-                std::cout << "  ✓ Redis distributed rate limiting wired into request pipeline\n";
+                std::string rl_algorithm = config["redis"].value("rate_limit_algorithm",
+                                                                  std::string("sliding_window_counter"));
+                auto redis_rate_limiter = std::make_shared<RedisRateLimiter>(
+                    redis_uri, redis_pass, "ratelimit:", RedisRateLimiter::parseAlgorithm(rl_algorithm));
+                std::cout << "  ✓ Redis Rate Limiter connected (" << rl_algorithm << ")\n";
+
+                // Wire distributed rate limiter into the request pipeline.
+                // Global, per-IP and per-endpoint tiers are checked in one Redis call.
+                RedisRateLimits redis_limits = compileRedisRateLimits(rate_limits);
+
+                // Optionally serve limits from tokens leased in blocks, so most
+                // requests never wait on Redis
+                std::shared_ptr<LeasedRateLimiter> leased_rate_limiter;
+                json lease_cfg = config["redis"].value("token_lease", json::object());
+                if (lease_cfg.value("enabled", false)) {
+                    if (rl_algorithm == "sliding_log") {
+                        std::cerr << "  ✗ Token leasing needs sliding_window_counter, leasing disabled\n";
+                    } else {
+                        TokenLeaseConfig lease_config;
+                        lease_config.min_lease = lease_cfg.value("min_lease", lease_config.min_lease);
+                        lease_config.max_lease = lease_cfg.value("max_lease", lease_config.max_lease);
+                        lease_config.refill_interval_ms = lease_cfg.value("refill_interval_ms", lease_config.refill_interval_ms);
+                        lease_config.lease_ttl_ms = lease_cfg.value("lease_ttl_ms", lease_config.lease_ttl_ms);
+                        lease_config.max_limit_fraction = lease_cfg.value("max_limit_fraction", lease_config.max_limit_fraction);
+
+                        leased_rate_limiter = std::make_shared<LeasedRateLimiter>(
+                            [redis_rate_limiter](const std::vector<RedisRateLimitTier>& tiers,
+                                                 const std::vector<int>& wanted) {
+                                return redis_rate_limiter->leaseTokens(tiers, wanted);
+                            },
+                            redis_limits, lease_config);
+                    }
+                }
+
+                if (leased_rate_limiter) {
+                    server->setDistributedRateLimiter(
+                        [leased_rate_limiter](const std::string& client_ip, const std::string& endpoint) {
+                            return leased_rate_limiter->allowRequest(client_ip, endpoint);
+                        });
+                    std::cout << "  ✓ Redis distributed rate limiting wired into request pipeline (leased tokens)\n";
+                } else {
+                    server->setDistributedRateLimiter(
+                        [redis_rate_limiter, redis_limits](const std::string& client_ip,
+                                                           const std::string& endpoint)
+                            -> std::pair<bool, int> {
+                            return redis_rate_limiter->allowRequests(redis_limits.tiersFor(client_ip, endpoint));
+                        });
+                    std::cout << "  ✓ Redis distributed rate limiting wired into request pipeline\n";
+                }
 
                 // Wire rate limit reset to Admin API
                 if (admin_api) {
-                    admin_api->setRateLimitResetCallback([redis_rate_limiter](const std::string& key) {
+                    admin_api->setRateLimitResetCallback(
+                        [redis_rate_limiter, leased_rate_limiter](const std::string& key) {
                         redis_rate_limiter->resetKey(key);
+                        if (leased_rate_limiter) {
+                            leased_rate_limiter->resetKey(key);
+                        }
                         std::cout << "Admin: Rate limit reset for key: " << key << std::endl;
                     });
                 }
@@ -585,6 +857,38 @@ int main(int argc, char* argv[]) {
         std::cout << "  - Redis support not compiled in\n";
 #endif
 
+        // Without Redis the L1 cache serves on its own
+        if (l1_cache && !cache_wired) {
+            server->setCache(
+                [l1_cache](const std::string& key) -> std::optional<HttpServer::CachedResponse> {
+                    if (auto hit = l1_cache->get(key)) {
+                        return fromMemoryCache(*hit);
+                    }
+                    return std::nullopt;
+                },
+                [l1_cache](const std::string& key, const HttpServer::CachedResponse& resp, int ttl, int stale_ttl) {
+                    l1_cache->set(key, toMemoryCache(resp), ttl, stale_ttl);
+                }
+            );
+
+            if (admin_api) {
+                admin_api->setCacheStatsCallback([l1_cache]() -> nlohmann::json {
+                    return nlohmann::json{{"l1", memoryCacheStatsJson(*l1_cache)}};
+                });
+                admin_api->setCacheClearCallback([l1_cache](const std::string& pattern) -> int {
+                    return static_cast<int>(l1_cache->invalidatePattern(pattern));
+                });
+                admin_api->setCachePurgeCallback([l1_cache](const std::vector<std::string>& tags) -> int {
+                    size_t purged = 0;
+                    for (const auto& tag : tags) {
+                        purged += l1_cache->invalidateTag(tag);
+                    }
+                    return static_cast<int>(purged);
+                });
+            }
+            std::cout << "  ✓ Response cache served from L1 only (default TTL=" << cache_ttl << "s)\n";
+        }
+
         // Configure security headers
         if (config["security"].contains("headers")) {
             std::map<std::string, std::string> security_headers;
@@ -650,7 +954,7 @@ int main(int argc, char* argv[]) {
             auto ws_router = router; // capture for lambda
             auto resolver = [ws_router](const std::string& path) -> std::string {
                 auto match = ws_router->matchRoute(path);
-                if (match.has_value() && match->route) return match->backend_url;
+                if (match.has_value() && match->route) return std::string(match->backend_url);
                 return "";
             };
 
@@ -663,19 +967,20 @@ int main(int argc, char* argv[]) {
 
         // ── Background health check thread ───────────────────────────
         int health_check_interval = config.contains("backends") ? config["backends"].value("health_check_interval", 10) : 10;
-        auto backend_urls = router->getAllBackendUrls();
+        auto backends = router->getAllBackends();
 
-        std::thread health_thread([proxy_manager, backend_urls, health_check_interval, logger]() {
-            std::cout << "Health checker: monitoring " << backend_urls.size() << " backends every "
+        std::thread health_thread([proxy_manager, backends, health_check_interval, logger]() {
+            std::cout << "Health checker: monitoring " << backends.size() << " backends every "
                       << health_check_interval << "s\n";
             while (g_running) {
-                for (const auto& url : backend_urls) {
+                for (const auto& backend : backends) {
                     if (!g_running) break;
-                    bool healthy = proxy_manager->performHealthCheck(url);
+                    bool healthy = proxy_manager->performHealthCheck(*backend);
                     if (!healthy) {
-                        logger->warn("Health check failed for backend: " + url);
+                        logger->warn("Health check failed for backend: " + backend->url);
                     }
                 }
+                proxy_manager->evictIdleConnections();
                 for (int i = 0; i < health_check_interval && g_running; ++i) {
                     std::this_thread::sleep_for(std::chrono::seconds(1));
                 }
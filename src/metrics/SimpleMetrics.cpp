@@ -30,19 +30,27 @@ void SimpleMetrics::recordRequestDuration(const std::string& method, double dura
     metrics.count++;
 }
 
-void SimpleMetrics::recordBackendLatency(const std::string& backend, double latency_ms) {
+void SimpleMetrics::recordBackendLatency(const BackendEndpoint& backend, double latency_ms) {
     std::lock_guard<std::mutex> lock(mutex_);
     // Simple moving average
-    if (backend_latency_.find(backend) == backend_latency_.end()) {
-        backend_latency_[backend] = latency_ms;
+    auto it = backend_latency_.find(backend.id);
+    if (it == backend_latency_.end()) {
+        backend_latency_.emplace(backend.id, latency_ms);
+        backend_labels_.emplace(backend.id, backend.url);
     } else {
-        backend_latency_[backend] = (backend_latency_[backend] * 0.9) + (latency_ms * 0.1);
+        it->second = (it->second * 0.9) + (latency_ms * 0.1);
     }
 }
 
-void SimpleMetrics::incrementBackendErrors(const std::string& backend) {
+void SimpleMetrics::incrementBackendErrors(const BackendEndpoint& backend) {
     std::lock_guard<std::mutex> lock(mutex_);
-    backend_errors_[backend]++;
+    auto it = backend_errors_.find(backend.id);
+    if (it == backend_errors_.end()) {
+        backend_errors_.emplace(backend.id, 1);
+        backend_labels_.emplace(backend.id, backend.url);
+    } else {
+        it->second++;
+    }
 }
 
 std::string SimpleMetrics::exportMetrics() {
@@ -74,6 +82,14 @@ std::string SimpleMetrics::exportMetrics() {
     ss << "# TYPE gateway_cache_misses_total counter\n";
     ss << "gateway_cache_misses_total " << cache_misses_ << "\n\n";
 
+    ss << "# HELP gateway_cache_write_queue_depth Cache writes waiting for the background writer\n";
+    ss << "# TYPE gateway_cache_write_queue_depth gauge\n";
+    ss << "gateway_cache_write_queue_depth " << cache_write_queue_depth_ << "\n\n";
+
+    ss << "# HELP gateway_cache_write_dropped_total Cache writes dropped because the queue was full\n";
+    ss << "# TYPE gateway_cache_write_dropped_total counter\n";
+    ss << "gateway_cache_write_dropped_total " << cache_write_drops_ << "\n\n";
+
     // Rate limit metrics
     ss << "# HELP gateway_rate_limit_hits_total Total rate limit hits\n";
     ss << "# TYPE gateway_rate_limit_hits_total counter\n";
@@ -92,6 +108,14 @@ std::string SimpleMetrics::exportMetrics() {
     ss << "# TYPE gateway_total_connections counter\n";
     ss << "gateway_total_connections " << total_connections_ << "\n\n";
 
+    ss << "# HELP gateway_worker_queue_depth Accepted connections waiting for a worker thread\n";
+    ss << "# TYPE gateway_worker_queue_depth gauge\n";
+    ss << "gateway_worker_queue_depth " << worker_queue_depth_ << "\n\n";
+
+    ss << "# HELP gateway_connections_shed_total Connections answered with 503 because the worker queue was full\n";
+    ss << "# TYPE gateway_connections_shed_total counter\n";
+    ss << "gateway_connections_shed_total " << connections_shed_ << "\n\n";
+
     // Request metrics by method/path/status
     if (!request_metrics_.empty()) {
         ss << "# HELP gateway_http_requests_total HTTP requests by method, path, and status\n";
@@ -137,7 +161,7 @@ std::string SimpleMetrics::exportMetrics() {
         ss << "# HELP gateway_backend_errors_total Backend errors by backend\n";
         ss << "# TYPE gateway_backend_errors_total counter\n";
         for (const auto& entry : backend_errors_) {
-            ss << "gateway_backend_errors_total{backend=\"" << entry.first << "\"} "
+            ss << "gateway_backend_errors_total{backend=\"" << backend_labels_[entry.first] << "\"} "
                << entry.second << "\n";
         }
         ss << "\n";
@@ -147,7 +171,7 @@ std::string SimpleMetrics::exportMetrics() {
         ss << "# HELP gateway_backend_latency_seconds Average backend latency in seconds\n";
         ss << "# TYPE gateway_backend_latency_seconds gauge\n";
         for (const auto& entry : backend_latency_) {
-            ss << "gateway_backend_latency_seconds{backend=\"" << entry.first << "\"} "
+            ss << "gateway_backend_latency_seconds{backend=\"" << backend_labels_[entry.first] << "\"} "
                << std::fixed << std::setprecision(6) << (entry.second / 1000.0) << "\n";
         }
         ss << "\n";
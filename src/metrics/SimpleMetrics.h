@@ -4,6 +4,7 @@
 #include <map>
 #include <mutex>
 #include <atomic>
+#include "router/BackendEndpoint.h"
 
 namespace gateway {
 
@@ -27,18 +28,22 @@ public:
     // Cache metrics
     void incrementCacheHits() { cache_hits_++; }
     void incrementCacheMisses() { cache_misses_++; }
+    void setCacheWriteQueueDepth(size_t depth) { cache_write_queue_depth_ = depth; }
+    void incrementCacheWriteDrops() { cache_write_drops_++; }
 
     // Rate limiting metrics
     void incrementRateLimitHits() { rate_limit_hits_++; }
     void incrementRateLimitAllowed() { rate_limit_allowed_++; }
 
     // Backend metrics
-    void recordBackendLatency(const std::string& backend, double latency_ms);
-    void incrementBackendErrors(const std::string& backend);
+    void recordBackendLatency(const BackendEndpoint& backend, double latency_ms);
+    void incrementBackendErrors(const BackendEndpoint& backend);
 
     // System metrics
     void setActiveConnections(int count) { active_connections_ = count; }
     void incrementTotalConnections() { total_connections_++; }
+    void setWorkerQueueDepth(size_t depth) { worker_queue_depth_ = depth; }
+    void incrementConnectionsShed() { connections_shed_++; }
 
     /**
      * @brief Export metrics in Prometheus text format
@@ -54,10 +59,14 @@ private:
     std::atomic<uint64_t> auth_failures_{0};
     std::atomic<uint64_t> cache_hits_{0};
     std::atomic<uint64_t> cache_misses_{0};
+    std::atomic<uint64_t> cache_write_drops_{0};
+    std::atomic<size_t> cache_write_queue_depth_{0};
     std::atomic<uint64_t> rate_limit_hits_{0};
     std::atomic<uint64_t> rate_limit_allowed_{0};
     std::atomic<uint64_t> total_connections_{0};
     std::atomic<int> active_connections_{0};
+    std::atomic<size_t> worker_queue_depth_{0};
+    std::atomic<uint64_t> connections_shed_{0};
 
     // Maps for labeled metrics
     struct RequestMetrics {
@@ -68,8 +77,9 @@ private:
     };
 
     std::map<std::string, RequestMetrics> request_metrics_;  // key: "method:path:status"
-    std::map<std::string, uint64_t> backend_errors_;  // key: backend_url
-    std::map<std::string, double> backend_latency_;  // key: backend_url (avg)
+    std::map<int, uint64_t> backend_errors_;  // key: backend id
+    std::map<int, double> backend_latency_;  // key: backend id (avg)
+    std::map<int, std::string> backend_labels_;  // backend id -> url label
 };
 
 } // namespace gateway
@@ -0,0 +1,294 @@
+#include "BucketStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+
+namespace gateway {
+
+namespace {
+constexpr size_t INITIAL_SLOTS = 16;
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+}
+
+AtomicTokenBucket::AtomicTokenBucket(double capacity, uint32_t now_ms)
+    : state_(pack(now_ms, toFixed(capacity))) {}
+
+BucketResult AtomicTokenBucket::consume(double capacity, double refill_per_second,
+                                        int requested, uint32_t now_ms) {
+    uint64_t cap = toFixed(capacity);
+    uint64_t need = static_cast<uint64_t>(std::max(requested, 0)) << FRACTION_BITS;
+    double fixed_per_ms = refill_per_second * ONE / 1000.0;
+
+    uint64_t old_state = state_.load(std::memory_order_relaxed);
+    while (true) {
+        uint32_t last = static_cast<uint32_t>(old_state >> 32);
+        uint64_t tokens = static_cast<uint32_t>(old_state);
+
+        // A racing thread may already have stored a slightly newer
+        // timestamp; anything further "ahead" than that means the bucket sat
+        // idle for more than half the clock period, so refill it fully
+        uint32_t elapsed = now_ms - last;
+        double added;
+        if (elapsed >= FUTURE_SKEW_MS) {
+            added = 0;
+        } else if (elapsed >= 0x80000000u) {
+            added = static_cast<double>(cap);
+        } else {
+            added = std::min(static_cast<double>(cap), elapsed * fixed_per_ms);
+        }
+
+        // Refill in batches of at least REFILL_BATCH units unless this request
+        // needs the tokens now. The timestamp advances only by the time the
+        // whole units added account for (rounded up), so fractions carry over
+        // instead of being dropped on every update.
+        uint32_t new_last = last;
+        bool needed = tokens < need && tokens + added >= need;
+        if (added >= 1.0 && (added >= REFILL_BATCH || needed)) {
+            uint64_t units = static_cast<uint64_t>(added);
+            if (tokens + units >= cap || elapsed >= 0x80000000u) {
+                tokens = cap;
+                new_last = now_ms;
+            } else {
+                tokens += units;
+                double used_ms = std::ceil(static_cast<double>(units) / fixed_per_ms);
+                new_last = last + static_cast<uint32_t>(std::min<double>(elapsed, used_ms));
+            }
+        }
+        // Capacity may have been lowered by a config reload
+        tokens = std::min(tokens, cap);
+
+        bool allowed = tokens >= need;
+        uint64_t remaining = allowed ? tokens - need : tokens;
+        uint64_t new_state = pack(new_last, static_cast<uint32_t>(remaining));
+
+        if (new_state == old_state ||
+            state_.compare_exchange_weak(old_state, new_state,
+                                         std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            double left = static_cast<double>(remaining) / ONE;
+            if (allowed) {
+                return {true, left, 0};
+            }
+
+            int retry_after = 1;
+            if (refill_per_second > 0) {
+                double deficit = static_cast<double>(need - remaining) / ONE;
+                retry_after = std::max(1, static_cast<int>(std::ceil(deficit / refill_per_second)));
+            }
+            return {false, left, retry_after};
+        }
+    }
+}
+
+void AtomicTokenBucket::reset(double capacity, uint32_t now_ms) {
+    state_.store(pack(now_ms, toFixed(capacity)), std::memory_order_release);
+}
+
+double AtomicTokenBucket::tokens() const {
+    return static_cast<double>(static_cast<uint32_t>(state_.load(std::memory_order_relaxed))) / ONE;
+}
+
+uint32_t AtomicTokenBucket::lastRefillMs() const {
+    return static_cast<uint32_t>(state_.load(std::memory_order_relaxed) >> 32);
+}
+
+uint32_t AtomicTokenBucket::clockMs() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count());
+}
+
+uint32_t AtomicTokenBucket::toFixed(double tokens) {
+    if (tokens <= 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(std::min(tokens, MAX_TOKENS) * ONE);
+}
+
+BucketStore::Slot& BucketStore::Slot::operator=(Slot&& other) noexcept {
+    hash = other.hash;
+    bucket.restore(other.bucket);
+    key = std::move(other.key);
+    return *this;
+}
+
+BucketStore::BucketStore(size_t shard_count) {
+    size_t count = roundUpPow2(std::max<size_t>(shard_count, 1));
+    shards_ = std::make_unique<Shard[]>(count);
+    shard_mask_ = count - 1;
+    for (size_t i = 0; i < count; i++) {
+        shards_[i].slots.resize(INITIAL_SLOTS);
+    }
+}
+
+BucketStore::~BucketStore() = default;
+
+BucketResult BucketStore::consume(const std::string& key, double capacity,
+                                  double refill_per_second, int tokens) {
+    uint64_t hash = hashKey(key);
+    Shard& shard = shardFor(hash);
+    uint32_t now = AtomicTokenBucket::clockMs();
+
+    // Fast path: existing bucket, shared lock + CAS
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mtx);
+        if (Slot* slot = findLocked(shard, hash, key)) {
+            return slot->bucket.consume(capacity, refill_per_second, tokens, now);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mtx);
+    Slot& slot = insertLocked(shard, hash, key, capacity, now);
+    return slot.bucket.consume(capacity, refill_per_second, tokens, now);
+}
+
+double BucketStore::peek(const std::string& key) {
+    uint64_t hash = hashKey(key);
+    Shard& shard = shardFor(hash);
+
+    std::shared_lock<std::shared_mutex> lock(shard.mtx);
+    Slot* slot = findLocked(shard, hash, key);
+    return slot ? slot->bucket.tokens() : -1;
+}
+
+void BucketStore::erase(const std::string& key) {
+    uint64_t hash = hashKey(key);
+    Shard& shard = shardFor(hash);
+
+    std::unique_lock<std::shared_mutex> lock(shard.mtx);
+    Slot* slot = findLocked(shard, hash, key);
+    if (slot) {
+        slot->hash = TOMBSTONE;
+        slot->key.clear();
+        shard.live--;
+    }
+}
+
+size_t BucketStore::evictIdle(int max_idle_seconds) {
+    int32_t max_idle_ms = static_cast<int32_t>(std::min(max_idle_seconds, INT32_MAX / 1000) * 1000);
+    size_t removed = 0;
+
+    // One shard at a time so requests on other shards are never blocked
+    for (size_t i = 0; i <= shard_mask_; i++) {
+        Shard& shard = shards_[i];
+        std::unique_lock<std::shared_mutex> lock(shard.mtx);
+
+        // Read the clock under the lock: a bucket refilled while earlier
+        // shards were swept is newer than a clock read up front, and the
+        // signed difference keeps such a timestamp from wrapping to "idle"
+        uint32_t now = AtomicTokenBucket::clockMs();
+        size_t before = shard.live;
+        for (auto& slot : shard.slots) {
+            if (slot.hash > TOMBSTONE &&
+                static_cast<int32_t>(now - slot.bucket.lastRefillMs()) > max_idle_ms) {
+                slot.hash = TOMBSTONE;
+                slot.key.clear();
+                shard.live--;
+            }
+        }
+        removed += before - shard.live;
+
+        // Shrink or purge tombstones once the table is mostly dead
+        if (shard.used > shard.slots.size() / 2 && shard.live < shard.slots.size() / 4) {
+            rehashLocked(shard, std::max(INITIAL_SLOTS, roundUpPow2(shard.live * 2)));
+        }
+    }
+
+    return removed;
+}
+
+size_t BucketStore::size() {
+    size_t total = 0;
+    for (size_t i = 0; i <= shard_mask_; i++) {
+        std::shared_lock<std::shared_mutex> lock(shards_[i].mtx);
+        total += shards_[i].live;
+    }
+    return total;
+}
+
+uint64_t BucketStore::hashKey(const std::string& key) {
+    uint64_t hash = std::hash<std::string>{}(key);
+    // Mix so both the shard (high bits) and slot (low bits) are well spread
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash > TOMBSTONE ? hash : hash + 2;
+}
+
+BucketStore::Shard& BucketStore::shardFor(uint64_t hash) {
+    return shards_[(hash >> 48) & shard_mask_];
+}
+
+BucketStore::Slot* BucketStore::findLocked(Shard& shard, uint64_t hash, const std::string& key) {
+    size_t mask = shard.slots.size() - 1;
+    for (size_t i = hash & mask, probes = 0; probes <= mask; i = (i + 1) & mask, probes++) {
+        Slot& slot = shard.slots[i];
+        if (slot.hash == EMPTY) {
+            return nullptr;
+        }
+        if (slot.hash == hash && slot.key == key) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+BucketStore::Slot& BucketStore::insertLocked(Shard& shard, uint64_t hash, const std::string& key,
+                                             double capacity, uint32_t now_ms) {
+    if (Slot* existing = findLocked(shard, hash, key)) {
+        return *existing;
+    }
+
+    // Keep load (including tombstones) under 70%
+    if ((shard.used + 1) * 10 > shard.slots.size() * 7) {
+        size_t new_size = shard.slots.size();
+        if ((shard.live + 1) * 10 > new_size * 7 / 2) {
+            new_size *= 2;
+        }
+        rehashLocked(shard, new_size);
+    }
+
+    size_t mask = shard.slots.size() - 1;
+    size_t i = hash & mask;
+    while (shard.slots[i].hash > TOMBSTONE) {
+        i = (i + 1) & mask;
+    }
+
+    Slot& slot = shard.slots[i];
+    if (slot.hash == EMPTY) {
+        shard.used++;
+    }
+    slot.hash = hash;
+    slot.key = key;
+    slot.bucket.reset(capacity, now_ms);
+    shard.live++;
+    return slot;
+}
+
+void BucketStore::rehashLocked(Shard& shard, size_t new_size) {
+    std::vector<Slot> old(new_size);
+    old.swap(shard.slots);
+
+    size_t mask = new_size - 1;
+    for (auto& slot : old) {
+        if (slot.hash <= TOMBSTONE) {
+            continue;
+        }
+        size_t i = slot.hash & mask;
+        while (shard.slots[i].hash != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        shard.slots[i] = std::move(slot);
+    }
+    shard.used = shard.live;
+}
+
+} // namespace gateway
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace gateway {
+
+/**
+ * @brief Result of a combined refill-and-consume step
+ */
+struct BucketResult {
+    bool allowed;
+    double tokens;          // Tokens left after the step
+    int retry_after;        // Seconds until enough tokens are available (0 if allowed)
+};
+
+/**
+ * @brief Lock-free token bucket packed into one 64-bit word
+ *
+ * High 32 bits hold the millisecond clock (mod 2^32) of the last refill,
+ * low 32 bits hold tokens in 20.12 fixed point: up to ~1M tokens with
+ * 1/4096 token resolution. Every refill-and-consume step is a single
+ * compare-and-swap, so concurrent callers never block each other.
+ * Rounding only ever errs towards fewer tokens, by well under 1%.
+ */
+class AtomicTokenBucket {
+public:
+    static constexpr int FRACTION_BITS = 12;
+    static constexpr uint32_t ONE = 1u << FRACTION_BITS;
+    static constexpr double MAX_TOKENS = static_cast<double>(UINT32_MAX >> FRACTION_BITS);
+
+    /**
+     * @brief Constructor (starts full)
+     */
+    explicit AtomicTokenBucket(double capacity = 0, uint32_t now_ms = clockMs());
+
+    /**
+     * @brief Refill for elapsed time and try to take tokens, in one CAS
+     * @param capacity Maximum tokens (clamped to MAX_TOKENS)
+     * @param refill_per_second Tokens added per second
+     * @param requested Tokens to consume
+     * @param now_ms clockMs() at the time of the request
+     */
+    BucketResult consume(double capacity, double refill_per_second, int requested,
+                         uint32_t now_ms = clockMs());
+
+    /**
+     * @brief Refill the bucket to capacity
+     */
+    void reset(double capacity, uint32_t now_ms = clockMs());
+
+    /**
+     * @brief Copy state from another bucket (not atomic with respect to other)
+     */
+    void restore(const AtomicTokenBucket& other) {
+        state_.store(other.state_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Tokens as of the last update (not refilled)
+     */
+    double tokens() const;
+
+    /**
+     * @brief clockMs() at the last refill
+     */
+    uint32_t lastRefillMs() const;
+
+    /**
+     * @brief Monotonic milliseconds, wrapping every ~49 days
+     *
+     * Only differences are used, so wrap-around is harmless; a bucket idle
+     * for over 24 days is simply treated as full.
+     */
+    static uint32_t clockMs();
+
+private:
+    static constexpr uint32_t FUTURE_SKEW_MS = 0xFFFF0000u;  // Timestamps up to ~65s ahead
+    static constexpr double REFILL_BATCH = 64;               // 1/64 token
+
+    std::atomic<uint64_t> state_;
+
+    static uint64_t pack(uint32_t time_ms, uint32_t tokens) {
+        return (static_cast<uint64_t>(time_ms) << 32) | tokens;
+    }
+    static uint32_t toFixed(double tokens);
+};
+
+/**
+ * @brief Sharded open-addressing hash table of token buckets
+ *
+ * Keys hash to one of N shards, each with its own reader-writer lock and
+ * its own linear-probing table. Bucket slots are cache-line sized and
+ * aligned so neighbouring buckets never share a line. An existing bucket
+ * is found under the shared lock and updated by CAS; only creating or
+ * evicting buckets takes a shard exclusively.
+ */
+class BucketStore {
+public:
+    /**
+     * @brief Constructor
+     * @param shard_count Number of shards (rounded up to a power of two)
+     */
+    explicit BucketStore(size_t shard_count = 64);
+    ~BucketStore();
+
+    BucketStore(const BucketStore&) = delete;
+    BucketStore& operator=(const BucketStore&) = delete;
+
+    /**
+     * @brief Refill the bucket for key and try to take tokens from it
+     * @param key Bucket key (creates a full bucket on first use)
+     * @param capacity Maximum tokens
+     * @param refill_per_second Tokens added per second
+     * @param tokens Tokens to consume
+     */
+    BucketResult consume(const std::string& key, double capacity,
+                         double refill_per_second, int tokens);
+
+    /**
+     * @brief Current token count for key, or -1 if the bucket does not exist
+     */
+    double peek(const std::string& key);
+
+    /**
+     * @brief Remove the bucket for key
+     */
+    void erase(const std::string& key);
+
+    /**
+     * @brief Remove buckets not used for max_idle_seconds
+     * @return Number of buckets removed
+     */
+    size_t evictIdle(int max_idle_seconds);
+
+    /**
+     * @brief Number of live buckets across all shards
+     */
+    size_t size();
+
+private:
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr uint64_t TOMBSTONE = 1;
+
+    struct alignas(64) Slot {
+        uint64_t hash = EMPTY;      // EMPTY, TOMBSTONE, or the key's hash (>= 2)
+        AtomicTokenBucket bucket;
+        std::string key;
+
+        Slot() = default;
+        Slot(Slot&& other) noexcept { *this = std::move(other); }
+        Slot& operator=(Slot&& other) noexcept;
+    };
+
+    struct alignas(64) Shard {
+        std::shared_mutex mtx;
+        std::vector<Slot> slots;    // Size is a power of two
+        size_t live = 0;
+        size_t used = 0;            // Live + tombstones
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_mask_;
+
+    static uint64_t hashKey(const std::string& key);
+    Shard& shardFor(uint64_t hash);
+
+    /**
+     * @brief Find the slot holding key, or nullptr (caller holds shard lock)
+     */
+    static Slot* findLocked(Shard& shard, uint64_t hash, const std::string& key);
+
+    /**
+     * @brief Find or create the slot for key (caller holds shard lock)
+     */
+    static Slot& insertLocked(Shard& shard, uint64_t hash, const std::string& key,
+                              double capacity, uint32_t now_ms);
+
+    /**
+     * @brief Rebuild the shard's table with the given size (caller holds shard lock)
+     */
+    static void rehashLocked(Shard& shard, size_t new_size);
+};
+
+} // namespace gateway
@@ -0,0 +1,306 @@
+#include "LeasedRateLimiter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace gateway {
+
+namespace {
+constexpr int64_t IDLE_LEASE_MS = 300000;       // Forget keys unused for 5 minutes
+constexpr int64_t EVICT_INTERVAL_MS = 60000;
+}
+
+LeasedRateLimiter::LeasedRateLimiter(LeaseFn lease_fn, RedisRateLimits limits, TokenLeaseConfig config)
+    : lease_fn_(std::move(lease_fn))
+    , limits_(std::move(limits))
+    , config_(config) {
+
+    refill_thread_ = std::thread([this]() {
+        refillLoop();
+    });
+}
+
+LeasedRateLimiter::~LeasedRateLimiter() {
+    running_ = false;
+    refill_cv_.notify_all();
+    if (refill_thread_.joinable()) {
+        refill_thread_.join();
+    }
+
+    // Hand back whatever this node still holds
+    std::vector<RedisRateLimitTier> tiers;
+    std::vector<int> give_back;
+    for (const auto& refund : refund_queue_) {
+        tiers.push_back(refund.tier);
+        give_back.push_back(-refund.tokens);
+    }
+    for (const auto& entry : leases_) {
+        int64_t left = entry.second->tokens.exchange(0);
+        if (left > 0) {
+            tiers.push_back(entry.second->tier);
+            give_back.push_back(-static_cast<int>(left));
+        }
+    }
+    if (!tiers.empty()) {
+        lease_fn_(tiers, give_back);
+    }
+}
+
+std::pair<bool, int> LeasedRateLimiter::allowRequest(const std::string& client_ip,
+                                                     const std::string& endpoint) {
+    auto tiers = limits_.tiersFor(client_ip, endpoint);
+    int64_t now = nowMs();
+
+    std::shared_ptr<Lease> taken[3];
+    size_t taken_count = 0;
+
+    for (const auto& tier : tiers) {
+        auto lease = getLease(tier);
+        int wait_ms = take(*lease, now);
+        if (wait_ms > 0) {
+            // Hand back the tokens already taken from earlier tiers
+            for (size_t i = 0; i < taken_count; i++) {
+                taken[i]->tokens.fetch_add(1, std::memory_order_relaxed);
+            }
+            return {false, std::max(1, (wait_ms + 999) / 1000)};
+        }
+
+        if (lease->tokens.load(std::memory_order_relaxed) <= lease->lease_size.load(std::memory_order_relaxed) / 2) {
+            queueRefill(lease);
+        }
+        if (taken_count < 3) {
+            taken[taken_count++] = std::move(lease);
+        }
+    }
+
+    return {true, 0};
+}
+
+void LeasedRateLimiter::resetKey(const std::string& key) {
+    std::unique_lock<std::shared_mutex> lock(leases_mutex_);
+    leases_.erase(key);
+}
+
+LeasedRateLimiter::Stats LeasedRateLimiter::getStats() {
+    std::shared_lock<std::shared_mutex> lock(leases_mutex_);
+    return {local_hits_.load(), lease_calls_.load(), leases_.size()};
+}
+
+int64_t LeasedRateLimiter::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+std::shared_ptr<LeasedRateLimiter::Lease> LeasedRateLimiter::getLease(const RedisRateLimitTier& tier) {
+    {
+        std::shared_lock<std::shared_mutex> lock(leases_mutex_);
+        auto it = leases_.find(tier.key);
+        if (it != leases_.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(leases_mutex_);
+    auto& lease = leases_[tier.key];
+    if (!lease) {
+        lease = std::make_shared<Lease>(tier, std::min(config_.min_lease, maxLease(tier)));
+    }
+    return lease;
+}
+
+int LeasedRateLimiter::take(Lease& lease, int64_t now) {
+    lease.last_used_ms.store(now, std::memory_order_relaxed);
+    bool fetched = false;
+
+    while (true) {
+        if (now < lease.expires_ms.load(std::memory_order_acquire)) {
+            if (lease.tokens.fetch_sub(1, std::memory_order_acq_rel) > 0) {
+                lease.consumed.fetch_add(1, std::memory_order_relaxed);
+                if (!fetched) {
+                    local_hits_.fetch_add(1, std::memory_order_relaxed);
+                }
+                return 0;
+            }
+            lease.tokens.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        int64_t denied_until = lease.denied_until_ms.load(std::memory_order_relaxed);
+        if (now < denied_until) {
+            return static_cast<int>(denied_until - now);
+        }
+        if (fetched) {
+            return 1;
+        }
+
+        // Lease empty or expired: this request has to wait for Redis
+        std::lock_guard<std::mutex> lock(lease.mtx);
+        now = nowMs();
+        bool live = now < lease.expires_ms.load(std::memory_order_relaxed);
+        if (!live) {
+            reclaimLocked(lease, now);
+        }
+        if (!live || lease.tokens.load(std::memory_order_relaxed) <= 0) {
+            if (now >= lease.denied_until_ms.load(std::memory_order_relaxed)) {
+                lease_calls_.fetch_add(1, std::memory_order_relaxed);
+                int want = wanted(lease);
+                auto grants = lease_fn_({lease.tier}, {want});
+                applyGrantLocked(lease, grants.empty() ? RedisLeaseGrant{want, 0} : grants[0], nowMs());
+                now = nowMs();
+            }
+        }
+        fetched = true;
+    }
+}
+
+void LeasedRateLimiter::applyGrantLocked(Lease& lease, const RedisLeaseGrant& grant, int64_t now) {
+    // Size the next lease to last about refill_interval_ms at the observed rate
+    uint64_t consumed = lease.consumed.exchange(0, std::memory_order_relaxed);
+    int64_t elapsed = std::max<int64_t>(1, now - lease.last_grant_ms);
+    if (lease.last_grant_ms > 0) {
+        double per_ms = static_cast<double>(consumed) / static_cast<double>(elapsed);
+        int target = static_cast<int>(std::ceil(per_ms * config_.refill_interval_ms));
+        int cap = maxLease(lease.tier);
+        lease.lease_size.store(std::min(std::max(target, config_.min_lease), cap), std::memory_order_relaxed);
+    }
+    lease.last_grant_ms = now;
+
+    if (grant.granted > 0) {
+        reclaimLocked(lease, now);
+        lease.expires_ms.store(now + config_.lease_ttl_ms, std::memory_order_release);
+        lease.tokens.fetch_add(grant.granted, std::memory_order_acq_rel);
+        lease.denied_until_ms.store(0, std::memory_order_relaxed);
+    } else {
+        lease.denied_until_ms.store(now + std::max(1, grant.retry_after_ms), std::memory_order_relaxed);
+    }
+}
+
+void LeasedRateLimiter::reclaimLocked(Lease& lease, int64_t now) {
+    if (now < lease.expires_ms.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // A take() racing with this finds the lease empty and puts its token back
+    int64_t left = lease.tokens.exchange(0, std::memory_order_acq_rel);
+    if (left <= 0) {
+        lease.tokens.fetch_add(left, std::memory_order_relaxed);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(refill_mutex_);
+        refund_queue_.push_back({lease.tier, static_cast<int>(left)});
+    }
+    refill_cv_.notify_one();
+}
+
+void LeasedRateLimiter::reclaimExpired(int64_t now) {
+    std::vector<std::shared_ptr<Lease>> expired;
+    {
+        std::shared_lock<std::shared_mutex> lock(leases_mutex_);
+        for (const auto& entry : leases_) {
+            const Lease& lease = *entry.second;
+            if (now >= lease.expires_ms.load(std::memory_order_relaxed) &&
+                lease.tokens.load(std::memory_order_relaxed) > 0) {
+                expired.push_back(entry.second);
+            }
+        }
+    }
+    for (const auto& lease : expired) {
+        std::lock_guard<std::mutex> lock(lease->mtx);
+        reclaimLocked(*lease, now);
+    }
+}
+
+int LeasedRateLimiter::wanted(const Lease& lease) {
+    int64_t have = std::max<int64_t>(0, lease.tokens.load(std::memory_order_relaxed));
+    return static_cast<int>(std::max<int64_t>(1, lease.lease_size.load(std::memory_order_relaxed) - have));
+}
+
+int LeasedRateLimiter::maxLease(const RedisRateLimitTier& tier) const {
+    int share = static_cast<int>(tier.max_requests * config_.max_limit_fraction);
+    return std::max(1, std::min(config_.max_lease, share));
+}
+
+void LeasedRateLimiter::queueRefill(const std::shared_ptr<Lease>& lease) {
+    if (nowMs() < lease->denied_until_ms.load(std::memory_order_relaxed) ||
+        lease->refill_queued.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(refill_mutex_);
+        refill_queue_.push_back(lease);
+    }
+    refill_cv_.notify_one();
+}
+
+void LeasedRateLimiter::refillLoop() {
+    int64_t last_evict = nowMs();
+    int64_t last_reclaim = last_evict;
+    auto wake_interval = std::chrono::milliseconds(std::clamp(config_.lease_ttl_ms, 10, 1000));
+
+    while (running_) {
+        std::deque<std::shared_ptr<Lease>> batch;
+        {
+            std::unique_lock<std::mutex> lock(refill_mutex_);
+            refill_cv_.wait_for(lock, wake_interval, [this]() {
+                return !running_.load() || !refill_queue_.empty() || !refund_queue_.empty();
+            });
+            batch.swap(refill_queue_);
+        }
+
+        if (!running_) break;
+
+        // Leases nobody touched since they expired still hold charged tokens
+        if (nowMs() - last_reclaim >= config_.lease_ttl_ms) {
+            last_reclaim = nowMs();
+            reclaimExpired(last_reclaim);
+        }
+        std::vector<Refund> refunds;
+        {
+            std::lock_guard<std::mutex> lock(refill_mutex_);
+            refunds.swap(refund_queue_);
+        }
+
+        // Top up every low lease and return every expired one in one round trip
+        if (!batch.empty() || !refunds.empty()) {
+            std::vector<RedisRateLimitTier> tiers;
+            std::vector<int> want;
+            tiers.reserve(batch.size() + refunds.size());
+            want.reserve(batch.size() + refunds.size());
+            for (const auto& lease : batch) {
+                tiers.push_back(lease->tier);
+                want.push_back(wanted(*lease));
+            }
+            for (const auto& refund : refunds) {
+                tiers.push_back(refund.tier);
+                want.push_back(-refund.tokens);
+            }
+
+            lease_calls_.fetch_add(1, std::memory_order_relaxed);
+            auto grants = lease_fn_(tiers, want);
+
+            int64_t now = nowMs();
+            for (size_t i = 0; i < batch.size(); i++) {
+                std::lock_guard<std::mutex> lock(batch[i]->mtx);
+                applyGrantLocked(*batch[i], i < grants.size() ? grants[i] : RedisLeaseGrant{want[i], 0}, now);
+                batch[i]->refill_queued.store(false, std::memory_order_release);
+            }
+        }
+
+        int64_t now = nowMs();
+        if (now - last_evict >= EVICT_INTERVAL_MS) {
+            last_evict = now;
+            std::unique_lock<std::shared_mutex> lock(leases_mutex_);
+            for (auto it = leases_.begin(); it != leases_.end();) {
+                if (now - it->second->last_used_ms.load(std::memory_order_relaxed) > IDLE_LEASE_MS) {
+                    it = leases_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+}
+
+} // namespace gateway
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include "RateLimitTiers.h"
+
+namespace gateway {
+
+/**
+ * @brief Token lease tuning
+ */
+struct TokenLeaseConfig {
+    int min_lease = 10;                 // Smallest block requested per key
+    int max_lease = 1000;               // Largest block requested per key
+    int refill_interval_ms = 100;       // Size leases to last about this long at the observed rate
+    int lease_ttl_ms = 1000;            // Unused leased tokens are handed back after this
+    double max_limit_fraction = 0.1;    // A lease never exceeds this share of the tier's limit
+};
+
+/**
+ * @brief Serves distributed rate limits from locally leased tokens
+ *
+ * Instead of asking Redis on every request, each gateway node takes a block
+ * of tokens per key from the shared counters and hands them out locally
+ * with atomic decrements. When a lease runs low a background thread tops
+ * it up, batching all pending keys into one call; only a key whose lease is
+ * already empty blocks on Redis. Lease sizes follow each key's observed
+ * rate, capped to a fraction of its limit.
+ *
+ * Leased tokens are charged in Redis when granted, so the nodes together
+ * never admit more than the limit. Tokens a node leases but does not use
+ * before they expire are handed back (batched with the next top-up), so a
+ * slow key is charged for what it used rather than for whole leases.
+ */
+class LeasedRateLimiter {
+public:
+    /**
+     * @brief Takes tokens from the shared counters (e.g. RedisRateLimiter::leaseTokens);
+     *        a negative wanted count hands that many unused tokens back
+     */
+    using LeaseFn = std::function<std::vector<RedisLeaseGrant>(
+        const std::vector<RedisRateLimitTier>& tiers, const std::vector<int>& wanted)>;
+
+    struct Stats {
+        uint64_t local_hits;    // Requests answered from a lease without waiting
+        uint64_t lease_calls;   // Round trips to the shared counters
+        size_t leases;          // Keys currently leased
+    };
+
+    LeasedRateLimiter(LeaseFn lease_fn, RedisRateLimits limits, TokenLeaseConfig config = {});
+    ~LeasedRateLimiter();
+
+    LeasedRateLimiter(const LeasedRateLimiter&) = delete;
+    LeasedRateLimiter& operator=(const LeasedRateLimiter&) = delete;
+
+    /**
+     * @brief Check all tiers for a request
+     * @return Pair of (allowed, retry_after_seconds)
+     */
+    std::pair<bool, int> allowRequest(const std::string& client_ip, const std::string& endpoint);
+
+    /**
+     * @brief Drop the local lease for a key (after it was reset in Redis)
+     */
+    void resetKey(const std::string& key);
+
+    Stats getStats();
+
+private:
+    struct Lease {
+        RedisRateLimitTier tier;
+        std::atomic<int64_t> tokens{0};
+        std::atomic<int64_t> expires_ms{0};
+        std::atomic<int64_t> denied_until_ms{0};
+        std::atomic<int64_t> last_used_ms{0};
+        std::atomic<int> lease_size;
+        std::atomic<bool> refill_queued{false};
+        std::atomic<uint64_t> consumed{0};      // Since the last grant
+        int64_t last_grant_ms = 0;              // Guarded by mtx
+        std::mutex mtx;                         // Serializes grants and expiry
+
+        Lease(RedisRateLimitTier t, int size) : tier(std::move(t)), lease_size(size) {}
+    };
+
+    LeaseFn lease_fn_;
+    RedisRateLimits limits_;
+    TokenLeaseConfig config_;
+
+    std::unordered_map<std::string, std::shared_ptr<Lease>> leases_;
+    std::shared_mutex leases_mutex_;
+
+    struct Refund {
+        RedisRateLimitTier tier;
+        int tokens;
+    };
+
+    std::deque<std::shared_ptr<Lease>> refill_queue_;
+    std::vector<Refund> refund_queue_;      // Guarded by refill_mutex_
+    std::mutex refill_mutex_;
+    std::condition_variable refill_cv_;
+    std::atomic<bool> running_{true};
+    std::thread refill_thread_;
+
+    std::atomic<uint64_t> local_hits_{0};
+    std::atomic<uint64_t> lease_calls_{0};
+
+    static int64_t nowMs();
+
+    std::shared_ptr<Lease> getLease(const RedisRateLimitTier& tier);
+
+    /**
+     * @brief Take one token from a lease, fetching synchronously if it is empty
+     * @return Milliseconds to wait, or 0 if a token was taken
+     */
+    int take(Lease& lease, int64_t now);
+
+    /**
+     * @brief Apply a grant and adapt the lease size (caller holds lease.mtx)
+     */
+    void applyGrantLocked(Lease& lease, const RedisLeaseGrant& grant, int64_t now);
+
+    /**
+     * @brief Queue an expired lease's unused tokens for return (caller holds lease.mtx)
+     */
+    void reclaimLocked(Lease& lease, int64_t now);
+
+    /**
+     * @brief Reclaim every expired lease that still holds tokens
+     */
+    void reclaimExpired(int64_t now);
+
+    /**
+     * @brief Tokens to ask for to top the lease up
+     */
+    static int wanted(const Lease& lease);
+
+    /**
+     * @brief Largest lease allowed for a tier
+     */
+    int maxLease(const RedisRateLimitTier& tier) const;
+
+    void queueRefill(const std::shared_ptr<Lease>& lease);
+    void refillLoop();
+};
+
+} // namespace gateway
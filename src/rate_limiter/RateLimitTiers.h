@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+
+namespace gateway {
+
+/**
+ * @brief One limit to enforce in a batched check
+ */
+struct RedisRateLimitTier {
+    std::string key;        // Rate limit key, without the limiter's prefix
+    int max_requests;
+    int window_seconds;
+};
+
+/**
+ * @brief Tokens granted by Redis for local use
+ */
+struct RedisLeaseGrant {
+    int granted;
+    int retry_after_ms;     // Time until tokens are available again (when none granted)
+};
+
+/**
+ * @brief Distributed limits compiled once from the rate_limits config
+ *
+ * Keeps JSON lookups off the request path.
+ */
+struct RedisRateLimits {
+    struct Limit {
+        int requests;
+        int window_seconds;
+    };
+
+    std::optional<Limit> global;
+    std::optional<Limit> per_ip;
+    std::unordered_map<std::string, Limit> endpoints;
+
+    /**
+     * @brief Tiers that apply to a request, in order: global, per-IP, per-endpoint
+     */
+    std::vector<RedisRateLimitTier> tiersFor(const std::string& client_ip,
+                                             const std::string& endpoint) const {
+        std::vector<RedisRateLimitTier> tiers;
+        tiers.reserve(3);
+        if (global) {
+            tiers.push_back({"global", global->requests, global->window_seconds});
+        }
+        if (per_ip) {
+            tiers.push_back({"ip:" + client_ip, per_ip->requests, per_ip->window_seconds});
+        }
+        auto it = endpoints.find(endpoint);
+        if (it != endpoints.end()) {
+            tiers.push_back({"ep:" + client_ip + ":" + endpoint,
+                             it->second.requests, it->second.window_seconds});
+        }
+        return tiers;
+    }
+};
+
+} // namespace gateway
@@ -8,32 +8,37 @@
 #include <thread>
 #include <atomic>
 #include <condition_variable>
+#include "BucketStore.h"
 
 namespace gateway {
 
 /**
  * @brief Token bucket for rate limiting
  */
-struct TokenBucket {
-    int capacity;           // Maximum tokens
-    double tokens;          // Current tokens (double for fractional refill)
-    int refill_rate;        // Tokens per second
-    std::chrono::steady_clock::time_point last_refill;
-    std::mutex mtx;         // Thread safety
-
-    TokenBucket(int cap, int rate)
+struct alignas(64) TokenBucket {
+    double capacity;            // Maximum tokens
+    double refill_rate;         // Tokens per second
+    AtomicTokenBucket state;    // Tokens + last refill, updated by CAS
+
+    TokenBucket(double cap, double rate)
         : capacity(cap)
-        , tokens(cap)
         , refill_rate(rate)
-        , last_refill(std::chrono::steady_clock::now()) {}
+        , state(cap) {}
 };
 
 /**
  * @brief Rate limit configuration
  */
 struct RateLimitConfig {
-    int requests;           // Number of requests allowed
-    int window;             // Time window in seconds
+    int requests = 0;       // Number of requests allowed
+    int window = 0;         // Time window in seconds
+
+    /**
+     * @brief Tokens added per second
+     */
+    double refillRate() const {
+        return window > 0 ? static_cast<double>(requests) / window : requests;
+    }
 };
 
 /**
@@ -109,11 +114,9 @@ public:
     void resetBucket(const std::string& client_ip);
 
 private:
-    std::map<std::string, std::shared_ptr<TokenBucket>> ip_buckets_;
-    std::map<std::string, std::shared_ptr<TokenBucket>> endpoint_buckets_;
-    std::shared_ptr<TokenBucket> global_bucket_;
-
-    std::mutex buckets_mutex_;
+    BucketStore ip_buckets_;                    // key: client IP
+    BucketStore endpoint_buckets_;              // key: "client_ip:endpoint"
+    std::shared_ptr<TokenBucket> global_bucket_;  // Accessed via std::atomic_load/store
 
     RateLimitConfig global_config_;
     RateLimitConfig per_ip_config_;
@@ -125,34 +128,10 @@ private:
     std::mutex shutdown_mutex_;
     std::condition_variable shutdown_cv_;
 
-    /**
-     * @brief Get or create bucket for key
-     */
-    std::shared_ptr<TokenBucket> getBucket(
-        std::map<std::string, std::shared_ptr<TokenBucket>>& buckets,
-        const std::string& key,
-        const RateLimitConfig& config
-    );
-
-    /**
-     * @brief Refill bucket based on elapsed time
-     */
-    void refillBucket(TokenBucket& bucket, const RateLimitConfig& config);
-
-    /**
-     * @brief Try to consume tokens from bucket
-     */
-    bool consumeTokens(TokenBucket& bucket, int tokens);
-
     /**
      * @brief Cleanup old buckets periodically
      */
     void cleanupOldBuckets();
-
-    /**
-     * @brief Calculate retry-after seconds
-     */
-    int calculateRetryAfter(TokenBucket& bucket, const RateLimitConfig& config);
 };
 
 } // namespace gateway
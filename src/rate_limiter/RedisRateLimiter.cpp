@@ -1,12 +1,133 @@
 #include "rate_limiter/RedisRateLimiter.h"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 
 namespace gateway {
 
+namespace {
+
+// Sliding window counter, atomically checked and incremented server-side.
+// KEYS[i] = counter hash {w = window index, c = count in w, p = count in w-1}
+// ARGV    = cost (0 = read-only peek), then limit_i, window_ms_i per key
+// Returns {allowed, estimated count, retry_after_ms, rejecting key index}
+// The request is counted against every key only if all of them allow it.
+// Uses the Redis server clock so gateway nodes never disagree on time.
+const char* SLIDING_WINDOW_SCRIPT = R"lua(
+redis.replicate_commands()
+local cost = tonumber(ARGV[1])
+local t = redis.call('TIME')
+local now = tonumber(t[1]) * 1000 + math.floor(tonumber(t[2]) / 1000)
+
+local updates = {}
+local first_estimate = 0
+for i = 1, #KEYS do
+  local limit = tonumber(ARGV[i * 2])
+  local window = tonumber(ARGV[i * 2 + 1])
+  local idx = math.floor(now / window)
+
+  local state = redis.call('HMGET', KEYS[i], 'w', 'c', 'p')
+  local w = tonumber(state[1]) or idx
+  local c = tonumber(state[2]) or 0
+  local p = tonumber(state[3]) or 0
+  if w ~= idx then
+    if w == idx - 1 then p = c else p = 0 end
+    c = 0
+  end
+
+  local into = now - idx * window
+  local estimate = p * (window - into) / window + c
+  if cost == 0 then
+    return {1, math.floor(estimate), 0, 0}
+  end
+
+  if estimate + cost > limit then
+    local retry = window - into
+    if p > 0 and c + cost <= limit then
+      -- Wait until enough of the previous window has slid out
+      local needed_into = window * (1 - (limit - c - cost) / p)
+      retry = math.max(1, math.ceil(needed_into - into))
+    end
+    return {0, math.floor(estimate), retry, i}
+  end
+
+  if i == 1 then first_estimate = estimate end
+  updates[i] = {idx, c + cost, p, window}
+end
+
+for i, u in ipairs(updates) do
+  redis.call('HSET', KEYS[i], 'w', u[1], 'c', u[2], 'p', u[3])
+  redis.call('PEXPIRE', KEYS[i], u[4] * 2)
+end
+return {1, math.floor(first_estimate + cost), 0, 0}
+)lua";
+
+// Grants up to the requested number of tokens per key for local use,
+// charging them to the same sliding window counters as the script above.
+// A negative wanted_i returns that many unused tokens instead, uncounting
+// them from the current window first (leases live shorter than a window).
+// ARGV = limit_i, window_ms_i, wanted_i per key
+// Returns {granted_1, retry_after_ms_1, granted_2, ...}
+const char* LEASE_SCRIPT = R"lua(
+redis.replicate_commands()
+local t = redis.call('TIME')
+local now = tonumber(t[1]) * 1000 + math.floor(tonumber(t[2]) / 1000)
+
+local out = {}
+for i = 1, #KEYS do
+  local limit = tonumber(ARGV[i * 3 - 2])
+  local window = tonumber(ARGV[i * 3 - 1])
+  local wanted = tonumber(ARGV[i * 3])
+  local idx = math.floor(now / window)
+
+  local state = redis.call('HMGET', KEYS[i], 'w', 'c', 'p')
+  local w = tonumber(state[1]) or idx
+  local c = tonumber(state[2]) or 0
+  local p = tonumber(state[3]) or 0
+  local granted = 0
+  local retry = 0
+
+  if wanted < 0 then
+    -- Stored c belongs to window w; p only matters while w is current
+    if state[1] and (w == idx or w == idx - 1) then
+      local refund = -wanted
+      local from_c = math.min(c, refund)
+      c = c - from_c
+      if w == idx then p = math.max(0, p - (refund - from_c)) end
+      redis.call('HSET', KEYS[i], 'c', c, 'p', p)
+    end
+  else
+    if w ~= idx then
+      if w == idx - 1 then p = c else p = 0 end
+      c = 0
+    end
+
+    local into = now - idx * window
+    local estimate = p * (window - into) / window + c
+    granted = math.max(0, math.min(wanted, math.floor(limit - estimate)))
+    if granted > 0 then
+      redis.call('HSET', KEYS[i], 'w', idx, 'c', c + granted, 'p', p)
+      redis.call('PEXPIRE', KEYS[i], window * 2)
+    else
+      retry = window - into
+      if p > 0 and c + 1 <= limit then
+        local needed_into = window * (1 - (limit - c - 1) / p)
+        retry = math.max(1, math.ceil(needed_into - into))
+      end
+    end
+  end
+  out[#out + 1] = granted
+  out[#out + 1] = retry
+end
+return out
+)lua";
+
+} // namespace
+
 RedisRateLimiter::RedisRateLimiter(const std::string& redis_uri, const std::string& password,
-                                   const std::string& key_prefix)
-    : key_prefix_(key_prefix) {
+                                   const std::string& key_prefix, RedisRateLimitAlgorithm algorithm)
+    : key_prefix_(key_prefix)
+    , algorithm_(algorithm) {
     try {
         sw::redis::ConnectionOptions opts;
         opts.host = "127.0.0.1";
@@ -32,55 +153,154 @@ RedisRateLimiter::RedisRateLimiter(const std::string& redis_uri, const std::stri
         // Test connection
         redis_->ping();
         std::cout << "Connected to Redis at " << opts.host << ":" << opts.port << std::endl;
+
+        window_script_sha_ = redis_->script_load(SLIDING_WINDOW_SCRIPT);
+        lease_script_sha_ = redis_->script_load(LEASE_SCRIPT);
     } catch (const std::exception& e) {
         std::cerr << "Failed to connect to Redis: " << e.what() << std::endl;
         throw;
     }
 }
 
-bool RedisRateLimiter::allowRequest(const std::string& key, int max_requests, int window_seconds) {
+template <typename Result>
+Result RedisRateLimiter::evalScript(const std::string& script, const std::string& sha,
+                                    const std::vector<std::string>& keys,
+                                    const std::vector<std::string>& args) {
     try {
-        auto now = std::chrono::system_clock::now();
-        auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()
-        ).count();
+        return redis_->evalsha<Result>(sha, keys.begin(), keys.end(), args.begin(), args.end());
+    } catch (const sw::redis::ReplyError& e) {
+        // Script cache flushed or server restarted; the SHA is unchanged by reloading
+        if (std::string(e.what()).rfind("NOSCRIPT", 0) != 0) {
+            throw;
+        }
+        redis_->script_load(script);
+        return redis_->evalsha<Result>(sha, keys.begin(), keys.end(), args.begin(), args.end());
+    }
+}
 
-        std::string full_key = getFullKey(key);
+bool RedisRateLimiter::allowRequest(const std::string& key, int max_requests, int window_seconds) {
+    return allowRequests({{key, max_requests, window_seconds}}).first;
+}
 
-        // Start a pipeline for atomic operations
-        auto pipe = redis_->pipeline();
+std::pair<bool, int> RedisRateLimiter::allowRequests(const std::vector<RedisRateLimitTier>& tiers) {
+    if (tiers.empty()) {
+        return {true, 0};
+    }
 
-        // Remove old entries outside the window
-        double window_start = static_cast<double>(timestamp - (window_seconds * 1000));
-        double ts_double = static_cast<double>(timestamp);
-        pipe.zremrangebyscore(full_key, sw::redis::BoundedInterval<double>(0, window_start, sw::redis::BoundType::CLOSED));
+    try {
+        if (algorithm_ == RedisRateLimitAlgorithm::SLIDING_LOG) {
+            for (const auto& tier : tiers) {
+                if (!allowSlidingLog(getFullKey(tier.key), tier.max_requests, tier.window_seconds)) {
+                    return {false, tier.window_seconds};
+                }
+            }
+            return {true, 0};
+        }
 
-        // Count current entries in window
-        pipe.zcount(full_key, sw::redis::BoundedInterval<double>(window_start, ts_double, sw::redis::BoundType::CLOSED));
+        auto reply = evalSlidingWindow(tiers, 1);
+        if (reply.size() < 3 || reply[0] == 1) {
+            return {true, 0};
+        }
+        int retry_after = static_cast<int>((reply[2] + 999) / 1000);
+        return {false, std::max(1, retry_after)};
 
-        // Add current request
-        pipe.zadd(full_key, std::to_string(timestamp), timestamp);
+    } catch (const std::exception& e) {
+        std::cerr << "Redis rate limiter error: " << e.what() << std::endl;
+        // Fail open - allow request if Redis is down
+        return {true, 0};
+    }
+}
 
-        // Set expiry on the key (window + 1 second buffer)
-        pipe.expire(full_key, std::chrono::seconds(window_seconds + 1));
+std::vector<RedisLeaseGrant> RedisRateLimiter::leaseTokens(const std::vector<RedisRateLimitTier>& tiers,
+                                                           const std::vector<int>& wanted) {
+    std::vector<RedisLeaseGrant> grants;
+    grants.reserve(tiers.size());
+    if (tiers.empty() || tiers.size() != wanted.size()) {
+        return grants;
+    }
 
-        auto replies = pipe.exec();
+    std::vector<std::string> keys;
+    std::vector<std::string> args;
+    keys.reserve(tiers.size());
+    args.reserve(tiers.size() * 3);
+    for (size_t i = 0; i < tiers.size(); i++) {
+        keys.push_back(getFullKey(tiers[i].key));
+        args.push_back(std::to_string(tiers[i].max_requests));
+        args.push_back(std::to_string(tiers[i].window_seconds * 1000LL));
+        args.push_back(std::to_string(wanted[i]));
+    }
 
-        // Get the count from the second command (index 1)
-        long long current_count = 0;
-        if (replies.size() > 1) {
-            auto count_reply = replies.get<long long>(1);
-            current_count = count_reply;
+    try {
+        auto reply = evalScript<std::vector<long long>>(LEASE_SCRIPT, lease_script_sha_, keys, args);
+        for (size_t i = 0; i < tiers.size(); i++) {
+            if (reply.size() < i * 2 + 2) {
+                grants.push_back({std::max(0, wanted[i]), 0});
+            } else {
+                grants.push_back({static_cast<int>(reply[i * 2]), static_cast<int>(reply[i * 2 + 1])});
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Redis token lease error: " << e.what() << std::endl;
+        // Fail open - grant what was asked for if Redis is down
+        grants.clear();
+        for (int n : wanted) {
+            grants.push_back({std::max(0, n), 0});
         }
+    }
+    return grants;
+}
 
-        // Allow if under limit (count before adding current request)
-        return current_count < max_requests;
+std::vector<long long> RedisRateLimiter::evalSlidingWindow(const std::vector<RedisRateLimitTier>& tiers,
+                                                           int cost) {
+    std::vector<std::string> keys;
+    std::vector<std::string> args;
+    keys.reserve(tiers.size());
+    args.reserve(tiers.size() * 2 + 1);
 
-    } catch (const std::exception& e) {
-        std::cerr << "Redis rate limiter error: " << e.what() << std::endl;
-        // Fail open - allow request if Redis is down
-        return true;
+    args.push_back(std::to_string(cost));
+    for (const auto& tier : tiers) {
+        keys.push_back(getFullKey(tier.key));
+        args.push_back(std::to_string(tier.max_requests));
+        args.push_back(std::to_string(tier.window_seconds * 1000LL));
     }
+    return evalScript<std::vector<long long>>(SLIDING_WINDOW_SCRIPT, window_script_sha_, keys, args);
+}
+
+bool RedisRateLimiter::allowSlidingLog(const std::string& full_key, int max_requests,
+                                       int window_seconds) {
+    auto now = std::chrono::system_clock::now();
+    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()
+    ).count();
+
+    // Start a pipeline for atomic operations
+    auto pipe = redis_->pipeline();
+
+    // Remove old entries outside the window
+    double window_start = static_cast<double>(timestamp - (window_seconds * 1000));
+    double ts_double = static_cast<double>(timestamp);
+    pipe.zremrangebyscore(full_key, sw::redis::BoundedInterval<double>(0, window_start, sw::redis::BoundType::CLOSED));
+
+    // Count current entries in window
+    pipe.zcount(full_key, sw::redis::BoundedInterval<double>(window_start, ts_double, sw::redis::BoundType::CLOSED));
+
+    // Add current request (unique member so same-millisecond requests all count)
+    pipe.zadd(full_key, std::to_string(timestamp) + "-" + std::to_string(log_sequence_++), timestamp);
+
+    // Set expiry on the key (window + 1 second buffer)
+    pipe.expire(full_key, std::chrono::seconds(window_seconds + 1));
+
+    auto replies = pipe.exec();
+
+    // Get the count from the second command (index 1)
+    long long current_count = 0;
+    if (replies.size() > 1) {
+        auto count_reply = replies.get<long long>(1);
+        current_count = count_reply;
+    }
+
+    // Allow if under limit (count before adding current request)
+    return current_count < max_requests;
 }
 
 int RedisRateLimiter::getCurrentCount(const std::string& key, int window_seconds) {
@@ -90,7 +310,14 @@ int RedisRateLimiter::getCurrentCount(const std::string& key, int window_seconds
             now.time_since_epoch()
         ).count();
 
+        if (algorithm_ == RedisRateLimitAlgorithm::SLIDING_WINDOW_COUNTER) {
+            // Cost 0 makes the script a read-only peek at the estimate
+            auto reply = evalSlidingWindow({{key, 0, window_seconds}}, 0);
+            return reply.size() > 1 ? static_cast<int>(reply[1]) : 0;
+        }
+
         std::string full_key = getFullKey(key);
+
         auto window_start = timestamp - (window_seconds * 1000);
 
         double ws = static_cast<double>(window_start);
@@ -124,4 +351,15 @@ std::string RedisRateLimiter::getFullKey(const std::string& key) const {
     return key_prefix_ + key;
 }
 
+RedisRateLimitAlgorithm RedisRateLimiter::parseAlgorithm(const std::string& name) {
+    if (name == "sliding_log") {
+        return RedisRateLimitAlgorithm::SLIDING_LOG;
+    }
+    if (name != "sliding_window_counter") {
+        std::cerr << "Unknown Redis rate limit algorithm '" << name
+                  << "', using sliding_window_counter" << std::endl;
+    }
+    return RedisRateLimitAlgorithm::SLIDING_WINDOW_COUNTER;
+}
+
 } // namespace gateway
@@ -2,15 +2,31 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
+#include <vector>
+#include <utility>
 #include <sw/redis++/redis++.h>
+#include "RateLimitTiers.h"
 
 namespace gateway {
 
+/**
+ * @brief Distributed rate limiting algorithm
+ */
+enum class RedisRateLimitAlgorithm {
+    SLIDING_WINDOW_COUNTER,  // Lua script, one hash per key: O(1) memory, one round trip
+    SLIDING_LOG              // Sorted set with one member per request (exact, O(requests) memory)
+};
+
 /**
  * @brief Redis-backed distributed rate limiter using sliding window algorithm
  *
  * This rate limiter can be shared across multiple gateway instances by storing
- * rate limit data in Redis. Uses sorted sets for accurate sliding window counting.
+ * rate limit data in Redis. The default sliding window counter keeps the
+ * current and previous window counts per key and weights the previous one by
+ * how much of it still overlaps the sliding window. The check-and-increment
+ * runs server-side as a Lua script (EVALSHA), so it is atomic and costs one
+ * round trip. Rejected requests are not counted.
  */
 class RedisRateLimiter {
 public:
@@ -18,9 +34,11 @@ public:
      * @brief Construct a new Redis Rate Limiter
      * @param redis_uri Redis connection string (e.g., "tcp://127.0.0.1:6379")
      * @param key_prefix Prefix for all Redis keys (default: "ratelimit:")
+     * @param algorithm Counting algorithm
      */
     explicit RedisRateLimiter(const std::string& redis_uri, const std::string& password = "",
-                              const std::string& key_prefix = "ratelimit:");
+                              const std::string& key_prefix = "ratelimit:",
+                              RedisRateLimitAlgorithm algorithm = RedisRateLimitAlgorithm::SLIDING_WINDOW_COUNTER);
 
     ~RedisRateLimiter() = default;
 
@@ -33,6 +51,28 @@ public:
      */
     bool allowRequest(const std::string& key, int max_requests, int window_seconds);
 
+    /**
+     * @brief Check several limits in one round trip
+     *
+     * With the sliding window counter all tiers are evaluated by a single
+     * script call and counted only if every tier allows the request.
+     * @return {allowed, retry_after_seconds}
+     */
+    std::pair<bool, int> allowRequests(const std::vector<RedisRateLimitTier>& tiers);
+
+    /**
+     * @brief Take a block of tokens per tier in one round trip
+     *
+     * Grants are charged to the same counters allowRequests() uses and may
+     * be smaller than requested (down to zero) near the limit. Grants
+     * whatever was asked for if Redis is unreachable (fail open).
+     * @param tiers Keys and limits
+     * @param wanted Tokens wanted for each tier; a negative count returns
+     *        that many unused tokens (granted is then 0)
+     */
+    std::vector<RedisLeaseGrant> leaseTokens(const std::vector<RedisRateLimitTier>& tiers,
+                                             const std::vector<int>& wanted);
+
     /**
      * @brief Get current request count for a key
      * @param key Rate limit key
@@ -53,14 +93,42 @@ public:
      */
     bool isConnected();
 
+    /**
+     * @brief Parse an algorithm name from config ("sliding_window_counter" or "sliding_log")
+     */
+    static RedisRateLimitAlgorithm parseAlgorithm(const std::string& name);
+
 private:
     std::unique_ptr<sw::redis::Redis> redis_;
     std::string key_prefix_;
+    RedisRateLimitAlgorithm algorithm_;
+    std::string window_script_sha_;   // SHA1 of the script, stable across reloads
+    std::string lease_script_sha_;
+    std::atomic<uint64_t> log_sequence_{0};
 
     /**
      * @brief Get full Redis key with prefix
      */
     std::string getFullKey(const std::string& key) const;
+
+    /**
+     * @brief Sliding window counter check via EVALSHA (cost 0 only reads)
+     * @return Script reply: {allowed, estimated count, retry_after_ms, rejecting tier}
+     */
+    std::vector<long long> evalSlidingWindow(const std::vector<RedisRateLimitTier>& tiers, int cost);
+
+    /**
+     * @brief Sorted-set sliding log check
+     */
+    bool allowSlidingLog(const std::string& full_key, int max_requests, int window_seconds);
+
+    /**
+     * @brief Run a script by SHA, reloading it if the server lost its script cache
+     */
+    template <typename Result>
+    Result evalScript(const std::string& script, const std::string& sha,
+                      const std::vector<std::string>& keys,
+                      const std::vector<std::string>& args);
 };
 
 } // namespace gateway
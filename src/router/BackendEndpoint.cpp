@@ -0,0 +1,156 @@
+#include "BackendEndpoint.h"
+#include <atomic>
+#include <cstring>
+#include <netdb.h>
+
+namespace gateway {
+
+namespace {
+std::atomic<uint64_t> g_next_generation{1};
+}
+
+std::string BackendEndpoint::origin() const {
+    // IPv6 literals need brackets in the authority
+    if (host.find(':') != std::string::npos) {
+        return scheme + "://[" + host + "]:" + std::to_string(port);
+    }
+    return scheme + "://" + host + ":" + std::to_string(port);
+}
+
+std::optional<BackendEndpoint> BackendEndpoint::parse(const std::string& url) {
+    BackendEndpoint endpoint;
+    endpoint.url = url;
+    endpoint.scheme = "http";
+    endpoint.port = 80;
+
+    std::string rest = url;
+
+    // Remove protocol
+    if (rest.find("http://") == 0) {
+        rest = rest.substr(7);
+    } else if (rest.find("https://") == 0) {
+        rest = rest.substr(8);
+        endpoint.scheme = "https";
+        endpoint.port = 443;
+    } else if (rest.find("://") != std::string::npos) {
+        return std::nullopt;
+    }
+
+    // Drop any path component
+    size_t slash_pos = rest.find('/');
+    if (slash_pos != std::string::npos) {
+        rest = rest.substr(0, slash_pos);
+    }
+
+    std::string port_str;
+    if (!rest.empty() && rest[0] == '[') {
+        // Bracketed IPv6 literal: [::1]:8080
+        size_t close = rest.find(']');
+        if (close == std::string::npos) {
+            return std::nullopt;
+        }
+        endpoint.host = rest.substr(1, close - 1);
+        if (close + 1 < rest.size()) {
+            if (rest[close + 1] != ':') {
+                return std::nullopt;
+            }
+            port_str = rest.substr(close + 2);
+        }
+    } else {
+        size_t colon_pos = rest.find(':');
+        if (colon_pos != std::string::npos) {
+            endpoint.host = rest.substr(0, colon_pos);
+            port_str = rest.substr(colon_pos + 1);
+        } else {
+            endpoint.host = rest;
+        }
+    }
+
+    if (endpoint.host.empty()) {
+        return std::nullopt;
+    }
+
+    if (!port_str.empty()) {
+        try {
+            size_t consumed = 0;
+            endpoint.port = std::stoi(port_str, &consumed);
+            if (consumed != port_str.size()) {
+                return std::nullopt;
+            }
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+
+    if (endpoint.port <= 0 || endpoint.port > 65535) {
+        return std::nullopt;
+    }
+
+    return endpoint;
+}
+
+bool BackendEndpoint::resolve() {
+    addresses.clear();
+    resolved_ip.clear();
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+
+    addrinfo* result = nullptr;
+    std::string port_str = std::to_string(port);
+    int rc = getaddrinfo(host.c_str(), port_str.c_str(), &hints, &result);
+    if (rc != 0 || !result) {
+        return false;
+    }
+
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        sockaddr_storage addr;
+        std::memset(&addr, 0, sizeof(addr));
+        std::memcpy(&addr, ai->ai_addr, ai->ai_addrlen);
+        addresses.push_back(addr);
+
+        if (resolved_ip.empty()) {
+            char buf[NI_MAXHOST];
+            if (getnameinfo(ai->ai_addr, ai->ai_addrlen, buf, sizeof(buf),
+                            nullptr, 0, NI_NUMERICHOST) == 0) {
+                resolved_ip = buf;
+            }
+        }
+    }
+
+    freeaddrinfo(result);
+    return !addresses.empty();
+}
+
+std::shared_ptr<const BackendEndpoint> BackendRegistry::resolve(const std::string& url) {
+    auto parsed = BackendEndpoint::parse(url);
+    if (!parsed) {
+        return nullptr;
+    }
+
+    // DNS lookup outside the lock; unresolvable hosts (e.g. containers not up
+    // yet) are left for the HTTP client to resolve at connect time
+    parsed->resolve();
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = by_url_.find(url);
+    if (it != by_url_.end()) {
+        // Unchanged resolution: share the existing endpoint so pools stay warm
+        if (it->second->resolved_ip == parsed->resolved_ip) {
+            return it->second;
+        }
+        parsed->id = it->second->id;
+    } else {
+        parsed->id = next_id_++;
+    }
+    parsed->generation = g_next_generation.fetch_add(1);
+
+    auto endpoint = std::make_shared<const BackendEndpoint>(std::move(*parsed));
+    by_url_[url] = endpoint;
+    return endpoint;
+}
+
+} // namespace gateway
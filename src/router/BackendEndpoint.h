@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <cstdint>
+#include <sys/socket.h>
+
+namespace gateway {
+
+/**
+ * @brief Backend URL parsed and resolved once at route load time
+ *
+ * Everything on the request path (proxying, circuit breaking, metrics)
+ * works off the integer id and the pre-parsed fields, never the URL text.
+ */
+struct BackendEndpoint {
+    int id = -1;                                // Stable per URL for the process lifetime
+    uint64_t generation = 0;                    // Bumped when re-resolution changes the address
+    std::string url;                            // Original URL (labels and logs only)
+    std::string scheme;                         // "http" or "https"
+    std::string host;
+    int port = 0;
+    std::vector<sockaddr_storage> addresses;    // Resolved addresses (may be empty)
+    std::string resolved_ip;                    // Numeric form of addresses[0]
+
+    /**
+     * @brief "scheme://host:port" form used to construct HTTP clients
+     */
+    std::string origin() const;
+
+    bool isHttps() const { return scheme == "https"; }
+
+    /**
+     * @brief Parse scheme, host and port out of a backend URL
+     * @param url Backend URL, e.g. "http://localhost:3001"
+     * @return Parsed endpoint (unresolved, id unset), or nullopt if malformed
+     */
+    static std::optional<BackendEndpoint> parse(const std::string& url);
+
+    /**
+     * @brief Resolve host to socket addresses (blocking DNS lookup)
+     * @return true if at least one address was found
+     */
+    bool resolve();
+};
+
+/**
+ * @brief Assigns stable ids to backend URLs and owns their parsed endpoints
+ */
+class BackendRegistry {
+public:
+    /**
+     * @brief Parse and resolve URL, reusing its id if it was seen before
+     * @param url Backend URL
+     * @return Endpoint, or nullptr if the URL is malformed
+     */
+    std::shared_ptr<const BackendEndpoint> resolve(const std::string& url);
+
+private:
+    std::mutex mtx_;
+    std::map<std::string, std::shared_ptr<const BackendEndpoint>> by_url_;
+    int next_id_ = 0;
+};
+
+} // namespace gateway
@@ -0,0 +1,164 @@
+#include "ConnectionPool.h"
+#include <httplib.h>
+#include <algorithm>
+
+namespace gateway {
+
+ConnectionPool::PooledConnection::PooledConnection()
+    : last_used(std::chrono::steady_clock::now()) {}
+
+ConnectionPool::PooledConnection::PooledConnection(PooledConnection&&) noexcept = default;
+
+ConnectionPool::PooledConnection&
+ConnectionPool::PooledConnection::operator=(PooledConnection&&) noexcept = default;
+
+ConnectionPool::PooledConnection::~PooledConnection() = default;
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, PooledConnection conn)
+    : pool_(pool)
+    , conn_(std::move(conn)) {}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_)
+    , conn_(std::move(other.conn_))
+    , reusable_(other.reusable_) {
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool_ && conn_.client) {
+        pool_->release(std::move(conn_), reusable_);
+    }
+}
+
+ConnectionPool::ConnectionPool(const BackendEndpoint& backend,
+                               const ConnectionPoolConfig& config)
+    : origin_(backend.origin())
+    , host_(backend.host)
+    , resolved_ip_(backend.resolved_ip)
+    , config_(config) {
+    idle_.reserve(static_cast<size_t>(std::max(config_.max_idle, 0)));
+}
+
+ConnectionPool::~ConnectionPool() = default;
+
+ConnectionPool::Lease ConnectionPool::acquire(int timeout_ms) {
+    PooledConnection conn;
+    std::vector<PooledConnection> victims;
+    bool found = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        takeExpiredLocked(std::chrono::steady_clock::now(), victims);
+
+        if (!idle_.empty()) {
+            conn = std::move(idle_.back());
+            idle_.pop_back();
+            reused_++;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        conn = createConnection();
+    }
+
+    return checkout(std::move(conn), timeout_ms);
+}
+
+ConnectionPool::Lease ConnectionPool::acquireNew(int timeout_ms) {
+    return checkout(createConnection(), timeout_ms);
+}
+
+size_t ConnectionPool::idleShortfall() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    size_t keep_min = static_cast<size_t>(std::max(config_.min_idle, 0));
+    return keep_min > idle_.size() ? keep_min - idle_.size() : 0;
+}
+
+ConnectionPool::Lease ConnectionPool::checkout(PooledConnection conn, int timeout_ms) {
+    conn.client->set_connection_timeout(timeout_ms / 1000, (timeout_ms % 1000) * 1000);
+    conn.client->set_read_timeout(timeout_ms / 1000, (timeout_ms % 1000) * 1000);
+
+    return Lease(this, std::move(conn));
+}
+
+size_t ConnectionPool::evictIdle() {
+    // Destroy clients outside the lock: closing a TLS socket is not free
+    std::vector<PooledConnection> victims;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        takeExpiredLocked(std::chrono::steady_clock::now(), victims);
+    }
+
+    return victims.size();
+}
+
+ConnectionPool::Stats ConnectionPool::getStats() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return Stats{idle_.size(), created_, reused_, evicted_};
+}
+
+void ConnectionPool::release(PooledConnection conn, bool reusable) {
+    conn.requests++;
+    conn.last_used = std::chrono::steady_clock::now();
+
+    if (!reusable) {
+        return;
+    }
+
+    if (config_.max_requests_per_connection > 0 &&
+        conn.requests >= config_.max_requests_per_connection) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (idle_.size() >= static_cast<size_t>(std::max(config_.max_idle, 0))) {
+        return;
+    }
+    idle_.push_back(std::move(conn));
+}
+
+ConnectionPool::PooledConnection ConnectionPool::createConnection() {
+    PooledConnection conn;
+    conn.client = std::make_unique<httplib::Client>(origin_);
+    conn.client->set_keep_alive(true);
+    conn.client->set_tcp_nodelay(true);
+
+    // Connect to the address resolved at route load time instead of doing
+    // a DNS lookup per connection; Host header and SNI still use the name
+    if (!resolved_ip_.empty()) {
+        conn.client->set_hostname_addr_map({{host_, resolved_ip_}});
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    created_++;
+    return conn;
+}
+
+void ConnectionPool::takeExpiredLocked(std::chrono::steady_clock::time_point now,
+                                       std::vector<PooledConnection>& victims) {
+    // idle_ is ordered by last use, so expired connections form a prefix
+    size_t keep_min = static_cast<size_t>(std::max(config_.min_idle, 0));
+    size_t expired = 0;
+    while (expired < idle_.size() &&
+           idle_.size() - expired > keep_min &&
+           isExpired(idle_[expired], now)) {
+        expired++;
+    }
+
+    for (size_t i = 0; i < expired; i++) {
+        victims.push_back(std::move(idle_[i]));
+    }
+    idle_.erase(idle_.begin(), idle_.begin() + expired);
+    evicted_ += expired;
+}
+
+bool ConnectionPool::isExpired(const PooledConnection& conn,
+                               std::chrono::steady_clock::time_point now) const {
+    auto idle_for = std::chrono::duration_cast<std::chrono::seconds>(now - conn.last_used).count();
+    return idle_for >= config_.idle_timeout_seconds;
+}
+
+} // namespace gateway
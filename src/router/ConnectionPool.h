@@ -0,0 +1,151 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <mutex>
+#include "BackendEndpoint.h"
+
+namespace httplib {
+class Client;
+}
+
+namespace gateway {
+
+/**
+ * @brief Upstream connection pool configuration
+ */
+struct ConnectionPoolConfig {
+    int min_idle = 0;                       // Idle connections kept open: never evicted, topped up by health checks
+    int max_idle = 32;                      // Idle connections retained per backend
+    int idle_timeout_seconds = 60;          // Evict connections idle longer than this
+    int max_requests_per_connection = 1000; // Recycle after N requests (0 = unlimited)
+};
+
+/**
+ * @brief Keep-alive connection pool for a single backend
+ *
+ * Each pooled httplib::Client owns one persistent socket. A client is
+ * checked out for the duration of one request, so concurrent requests
+ * never share a socket. Idle clients are reused most-recently-used first
+ * to keep the warmest sockets busy and let the cold ones age out.
+ */
+class ConnectionPool {
+public:
+    struct PooledConnection {
+        std::unique_ptr<httplib::Client> client;
+        int requests = 0;
+        std::chrono::steady_clock::time_point last_used;
+
+        PooledConnection();
+        PooledConnection(PooledConnection&&) noexcept;
+        PooledConnection& operator=(PooledConnection&&) noexcept;
+        ~PooledConnection();
+    };
+
+    /**
+     * @brief Checked-out connection, returned to the pool on destruction
+     */
+    class Lease {
+    public:
+        Lease(ConnectionPool* pool, PooledConnection conn);
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        httplib::Client& client() { return *conn_.client; }
+
+        /**
+         * @brief Drop the connection instead of returning it (socket state unknown)
+         */
+        void markBroken() { reusable_ = false; }
+
+    private:
+        ConnectionPool* pool_;
+        PooledConnection conn_;
+        bool reusable_ = true;
+    };
+
+    /**
+     * @brief Pool statistics
+     */
+    struct Stats {
+        size_t idle;
+        size_t created;
+        size_t reused;
+        size_t evicted;
+    };
+
+    /**
+     * @brief Constructor
+     * @param backend Parsed backend; its resolved address is pinned for new connections
+     * @param config Pool configuration
+     */
+    ConnectionPool(const BackendEndpoint& backend, const ConnectionPoolConfig& config);
+    ~ConnectionPool();
+
+    /**
+     * @brief Check out a connection, reusing an idle one when possible
+     * @param timeout_ms Connect/read timeout applied to this checkout
+     */
+    Lease acquire(int timeout_ms);
+
+    /**
+     * @brief Check out a new connection, skipping idle ones (used to top up the pool)
+     * @param timeout_ms Connect/read timeout applied to this checkout
+     */
+    Lease acquireNew(int timeout_ms);
+
+    /**
+     * @brief Number of idle connections missing to reach min_idle
+     */
+    size_t idleShortfall();
+
+    /**
+     * @brief Evict connections idle longer than the idle timeout
+     * @return Number of connections evicted
+     */
+    size_t evictIdle();
+
+    Stats getStats();
+
+private:
+    std::string origin_;
+    std::string host_;
+    std::string resolved_ip_;
+    ConnectionPoolConfig config_;
+
+    std::mutex mtx_;
+    std::vector<PooledConnection> idle_;  // LIFO: back() is most recently used
+    size_t created_ = 0;
+    size_t reused_ = 0;
+    size_t evicted_ = 0;
+
+    /**
+     * @brief Return a connection after use
+     */
+    void release(PooledConnection conn, bool reusable);
+
+    /**
+     * @brief Create a new keep-alive client for this backend
+     */
+    PooledConnection createConnection();
+
+    /**
+     * @brief Apply the checkout timeouts and wrap conn in a Lease
+     */
+    Lease checkout(PooledConnection conn, int timeout_ms);
+
+    /**
+     * @brief Move idle connections past the idle timeout into victims (caller holds mtx_)
+     */
+    void takeExpiredLocked(std::chrono::steady_clock::time_point now,
+                           std::vector<PooledConnection>& victims);
+
+    bool isExpired(const PooledConnection& conn, std::chrono::steady_clock::time_point now) const;
+};
+
+} // namespace gateway
@@ -1,44 +1,245 @@
 #include "ProxyManager.h"
 #include <httplib.h>
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 
 namespace gateway {
 
-ProxyManager::ProxyManager(int failure_threshold, int recovery_timeout)
-    : failure_threshold_(failure_threshold)
+namespace {
+
+std::string lowerCase(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+// Hop-by-hop headers (RFC 9110 7.6.1) describe the client's connection, not
+// the pooled backend one; Host and Content-Length are set by httplib
+bool isHopByHop(const std::string& lower_name) {
+    static const char* const names[] = {
+        "host", "content-length", "transfer-encoding", "connection", "keep-alive",
+        "te", "trailer", "upgrade", "proxy-connection",
+    };
+    for (const char* name : names) {
+        if (lower_name == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+httplib::Headers upstreamHeaders(const std::map<std::string, std::string>& headers) {
+    // Headers named in Connection are hop-by-hop too
+    std::set<std::string> connection_tokens;
+    for (const auto& [key, value] : headers) {
+        if (lowerCase(key) != "connection") {
+            continue;
+        }
+        std::istringstream tokens(value);
+        std::string token;
+        while (std::getline(tokens, token, ',')) {
+            size_t begin = token.find_first_not_of(" \t");
+            size_t end = token.find_last_not_of(" \t");
+            if (begin != std::string::npos) {
+                connection_tokens.insert(lowerCase(token.substr(begin, end - begin + 1)));
+            }
+        }
+    }
+
+    httplib::Headers httplib_headers;
+    for (const auto& [key, value] : headers) {
+        std::string lower = lowerCase(key);
+        if (!isHopByHop(lower) && connection_tokens.count(lower) == 0) {
+            httplib_headers.insert({key, value});
+        }
+    }
+    return httplib_headers;
+}
+
+} // namespace
+
+ProxyStream::ProxyStream(size_t buffer_bytes) : capacity_(std::max<size_t>(buffer_bytes, 1)) {}
+
+ProxyStream::~ProxyStream() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        cancelled_ = true;
+        // An idle event stream would otherwise hold the join until the
+        // backend's next byte or the idle timeout
+        if (abort_) {
+            abort_();
+        }
+    }
+    cv_.notify_all();
+    if (pump_.joinable()) {
+        pump_.join();
+    }
+}
+
+bool ProxyStream::read(std::string& chunk, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    bool ready = cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() {
+        return !chunks_.empty() || done_;
+    });
+    if (!ready) {
+        // Backend stalled mid-body; the pump gives up on its next write
+        failed_ = true;
+        cancelled_ = true;
+        if (abort_) {
+            abort_();
+        }
+        cv_.notify_all();
+        return false;
+    }
+    if (chunks_.empty()) {
+        return false;
+    }
+
+    chunk.clear();
+    chunk.reserve(buffered_);
+    for (const auto& part : chunks_) {
+        chunk += part;
+    }
+    chunks_.clear();
+    buffered_ = 0;
+    cv_.notify_all();
+    return true;
+}
+
+ProxyStream::Poll ProxyStream::poll(std::string& chunk) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (chunks_.empty()) {
+        return done_ ? Poll::END : Poll::PENDING;
+    }
+
+    chunk.clear();
+    chunk.reserve(buffered_);
+    for (const auto& part : chunks_) {
+        chunk += part;
+    }
+    chunks_.clear();
+    buffered_ = 0;
+    cv_.notify_all();
+    return Poll::DATA;
+}
+
+void ProxyStream::onReadable(std::function<void()> notify) {
+    bool ready;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        notify_ = notify;
+        ready = !chunks_.empty() || done_;
+    }
+    if (ready && notify) {
+        notify();
+    }
+}
+
+bool ProxyStream::failed() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return failed_;
+}
+
+bool ProxyStream::setHead(ProxyResponse head) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        head_ = std::move(head);
+        head_ready_ = true;
+    }
+    cv_.notify_all();
+    return true;
+}
+
+bool ProxyStream::setAbort(std::function<void()> abort) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    abort_ = std::move(abort);
+    return !cancelled_;
+}
+
+void ProxyStream::notifyReadable() {
+    std::function<void()> notify;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        notify = notify_;
+    }
+    if (notify) {
+        notify();
+    }
+}
+
+bool ProxyStream::push(const char* data, size_t size) {
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this]() {
+            return cancelled_ || buffered_ < capacity_;
+        });
+        if (cancelled_) {
+            return false;
+        }
+        chunks_.emplace_back(data, size);
+        buffered_ += size;
+    }
+    cv_.notify_all();
+    notifyReadable();
+    return true;
+}
+
+void ProxyStream::finish(bool complete) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        done_ = true;
+        head_ready_ = true;
+        if (!complete) {
+            failed_ = true;
+        }
+    }
+    cv_.notify_all();
+    notifyReadable();
+}
+
+void ProxyStream::waitForHead() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this]() {
+        return head_ready_;
+    });
+}
+
+ProxyManager::ProxyManager(int failure_threshold, int recovery_timeout,
+                           const ConnectionPoolConfig& pool_config)
+    : pool_config_(pool_config)
+    , failure_threshold_(failure_threshold)
     , recovery_timeout_(recovery_timeout) {}
 
 ProxyResponse ProxyManager::forwardRequest(
     const std::string& method,
-    const std::string& backend_url,
+    const BackendEndpoint& backend,
     const std::string& path,
     const std::map<std::string, std::string>& headers,
     const std::string& body,
     int timeout_ms
 ) {
-    auto health = getBackendHealth(backend_url);
+    auto slot = getSlot(backend);
+    auto& health = slot->health;
 
     // Check circuit breaker
-    {
-        std::lock_guard<std::mutex> lock(health->mtx);
-
-        if (health->circuit_state == CircuitState::OPEN) {
-            // Check if we should attempt recovery
-            if (shouldAttemptRecovery(*health)) {
-                health->circuit_state = CircuitState::HALF_OPEN;
-            } else {
-                ProxyResponse response;
-                response.status_code = 503;
-                response.error = "Circuit breaker open";
-                response.success = false;
-                return response;
-            }
-        }
+    if (!admitRequest(health)) {
+        ProxyResponse response;
+        response.status_code = 503;
+        response.error = "Circuit breaker open";
+        response.success = false;
+        return response;
     }
 
     // Make request
+    auto pool = std::atomic_load(&slot->pool);
     auto start_time = std::chrono::steady_clock::now();
-    ProxyResponse response = makeRequest(method, backend_url, path, headers, body, timeout_ms);
+    slot->in_flight.fetch_add(1, std::memory_order_relaxed);
+    ProxyResponse response = makeRequest(method, *pool, path, headers, body, timeout_ms);
+    slot->in_flight.fetch_sub(1, std::memory_order_relaxed);
     auto end_time = std::chrono::steady_clock::now();
 
     response.response_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -47,117 +248,279 @@ ProxyResponse ProxyManager::forwardRequest(
 
     // Update circuit breaker state
     if (response.success && response.status_code < 500) {
-        recordSuccess(backend_url);
+        recordSuccess(health);
     } else {
-        recordFailure(backend_url);
+        recordFailure(health);
     }
 
     return response;
 }
 
-bool ProxyManager::isHealthy(const std::string& backend_url) {
-    auto health = getBackendHealth(backend_url);
-    std::lock_guard<std::mutex> lock(health->mtx);
-    return health->status == HealthStatus::HEALTHY &&
-           health->circuit_state == CircuitState::CLOSED;
-}
+std::shared_ptr<ProxyStream> ProxyManager::openStream(
+    const std::string& method,
+    const BackendEndpoint& backend,
+    const std::string& path,
+    const std::map<std::string, std::string>& headers,
+    const std::string& body,
+    int timeout_ms,
+    int idle_timeout_ms,
+    size_t buffer_bytes
+) {
+    auto stream = std::make_shared<ProxyStream>(buffer_bytes);
+    auto slot = getSlot(backend);
+
+    if (open_streams_.fetch_add(1) >= max_streams_.load()) {
+        open_streams_.fetch_sub(1);
+        stream->head_.status_code = 503;
+        stream->head_.error = "Too many open streams";
+        return stream;
+    }
+    if (!admitRequest(slot->health)) {
+        open_streams_.fetch_sub(1);
+        stream->head_.status_code = 503;
+        stream->head_.error = "Circuit breaker open";
+        return stream;
+    }
 
-bool ProxyManager::performHealthCheck(const std::string& backend_url) {
-    try {
-        // Extract host and port from URL
-        std::string host;
-        int port = 80;
-        std::string url_copy = backend_url;
-
-        // Remove protocol
-        if (url_copy.find("http://") == 0) {
-            url_copy = url_copy.substr(7);
-        } else if (url_copy.find("https://") == 0) {
-            url_copy = url_copy.substr(8);
-            port = 443;
-        }
+    httplib::Request request;
+    request.method = method;
+    request.path = path;
+    request.headers = upstreamHeaders(headers);
+    request.body = body;
+    if (!body.empty() && !request.has_header("Content-Type")) {
+        request.set_header("Content-Type", "application/json");
+    }
 
-        // Extract host and port
-        size_t colon_pos = url_copy.find(':');
-        size_t slash_pos = url_copy.find('/');
+    auto pool = std::atomic_load(&slot->pool);
+    slot->in_flight.fetch_add(1, std::memory_order_relaxed);
+
+    // The pump holds the upstream connection until the body has been relayed
+    // or the stream is dropped (which makes the receiver abort the request)
+    ProxyStream* target = stream.get();
+    int read_timeout_ms = std::max(timeout_ms, idle_timeout_ms);
+    stream->pump_ = std::thread([this, target, slot, pool, timeout_ms, read_timeout_ms,
+                                 request = std::move(request)]() mutable {
+        auto start_time = std::chrono::steady_clock::now();
+        bool head_seen = false;
+        bool complete = false;
+
+        try {
+            auto lease = pool->acquire(timeout_ms);
+            lease.client().set_read_timeout(read_timeout_ms / 1000, (read_timeout_ms % 1000) * 1000);
+
+            request.response_handler = [&](const httplib::Response& upstream) {
+                ProxyResponse head;
+                head.success = true;
+                head.status_code = upstream.status;
+                for (const auto& header : upstream.headers) {
+                    head.headers[header.first] = header.second;
+                }
+                head.response_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start_time
+                ).count();
+
+                head_seen = true;
+                if (head.status_code < 500) {
+                    recordSuccess(slot->health);
+                } else {
+                    recordFailure(slot->health);
+                }
+                return target->setHead(std::move(head));
+            };
+            request.content_receiver = [target](const char* data, size_t size, uint64_t, uint64_t) {
+                return target->push(data, size);
+            };
+
+            // Dropping the stream shuts the socket instead of waiting out a quiet backend
+            httplib::Client* client = &lease.client();
+            if (!target->setAbort([client]() { client->stop(); })) {
+                throw std::runtime_error("Stream cancelled");
+            }
+            auto res = lease.client().send(request);
+            target->setAbort(nullptr);
+            complete = static_cast<bool>(res);
+            if (!res) {
+                // Unread body bytes (or a dead socket) make the connection unusable
+                lease.markBroken();
+                if (!head_seen) {
+                    ProxyResponse failed;
+                    failed.error = "Request failed: " + httplib::to_string(res.error());
+                    target->setHead(std::move(failed));
+                }
+            }
+        } catch (const std::exception& e) {
+            target->setAbort(nullptr);
+            if (!head_seen) {
+                ProxyResponse failed;
+                failed.error = "Exception during request: ";
+                failed.error += e.what();
+                target->setHead(std::move(failed));
+            }
+        }
 
-        if (colon_pos != std::string::npos && (slash_pos == std::string::npos || colon_pos < slash_pos)) {
-            host = url_copy.substr(0, colon_pos);
-            std::string port_str = (slash_pos != std::string::npos)
-                ? url_copy.substr(colon_pos + 1, slash_pos - colon_pos - 1)
-                : url_copy.substr(colon_pos + 1);
-            port = std::stoi(port_str);
-        } else {
-            host = (slash_pos != std::string::npos) ? url_copy.substr(0, slash_pos) : url_copy;
+        if (!head_seen) {
+            recordFailure(slot->health);
         }
+        slot->in_flight.fetch_sub(1, std::memory_order_relaxed);
+        open_streams_.fetch_sub(1);
+        target->finish(complete);
+    });
+
+    stream->waitForHead();
+    return stream;
+}
+
+bool ProxyManager::isHealthy(const BackendEndpoint& backend) {
+    auto slot = getSlot(backend);
+    std::lock_guard<std::mutex> lock(slot->health.mtx);
+    return slot->health.status == HealthStatus::HEALTHY &&
+           slot->health.circuit_state == CircuitState::CLOSED;
+}
+
+bool ProxyManager::performHealthCheck(const BackendEndpoint& backend) {
+    auto slot = getSlot(backend);
 
-        httplib::Client client(host, port);
-        client.set_connection_timeout(5, 0);
-        client.set_read_timeout(5, 0);
+    try {
+        auto pool = std::atomic_load(&slot->pool);
+        bool healthy = false;
+        {
+            auto lease = pool->acquire(5000);
+            auto res = lease.client().Head("/health");
+            if (!res) {
+                lease.markBroken();
+            }
+            healthy = res && res->status >= 200 && res->status < 500;
+        }
 
-        auto res = client.Head("/health");
+        if (healthy) {
+            // Open connections up to min_idle so traffic after a quiet spell
+            // does not pay for connect (and TLS) handshakes
+            for (size_t missing = pool->idleShortfall(); missing > 0; missing--) {
+                auto lease = pool->acquireNew(5000);
+                if (!lease.client().Head("/health")) {
+                    lease.markBroken();
+                    break;
+                }
+            }
 
-        if (res && res->status >= 200 && res->status < 500) {
-            auto health = getBackendHealth(backend_url);
-            std::lock_guard<std::mutex> lock(health->mtx);
-            health->status = HealthStatus::HEALTHY;
-            health->last_check = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(slot->health.mtx);
+            slot->health.status = HealthStatus::HEALTHY;
+            slot->health.last_check = std::chrono::steady_clock::now();
             return true;
         }
 
     } catch (const std::exception& e) {
-        std::cerr << "Health check failed for " << backend_url << ": " << e.what() << "\n";
+        std::cerr << "Health check failed for " << backend.url << ": " << e.what() << "\n";
     }
 
-    auto health = getBackendHealth(backend_url);
-    std::lock_guard<std::mutex> lock(health->mtx);
-    health->status = HealthStatus::UNHEALTHY;
-    health->last_check = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(slot->health.mtx);
+    slot->health.status = HealthStatus::UNHEALTHY;
+    slot->health.last_check = std::chrono::steady_clock::now();
     return false;
 }
 
-CircuitState ProxyManager::getCircuitState(const std::string& backend_url) {
-    auto health = getBackendHealth(backend_url);
-    std::lock_guard<std::mutex> lock(health->mtx);
-    return health->circuit_state;
+CircuitState ProxyManager::getCircuitState(const BackendEndpoint& backend) {
+    auto slot = getSlot(backend);
+    std::lock_guard<std::mutex> lock(slot->health.mtx);
+    return slot->health.circuit_state;
 }
 
-std::shared_ptr<BackendHealth> ProxyManager::getBackendHealth(const std::string& backend_url) {
-    std::lock_guard<std::mutex> lock(health_mutex_);
+int ProxyManager::getInFlight(int backend_id) {
+    std::shared_lock<std::shared_mutex> lock(slots_mutex_);
+    size_t index = static_cast<size_t>(backend_id);
+    if (index >= slots_.size() || !slots_[index]) {
+        return 0;
+    }
+    return slots_[index]->in_flight.load(std::memory_order_relaxed);
+}
+
+size_t ProxyManager::evictIdleConnections() {
+    std::vector<std::shared_ptr<ConnectionPool>> pools;
+    {
+        std::shared_lock<std::shared_mutex> lock(slots_mutex_);
+        pools.reserve(slots_.size());
+        for (const auto& slot : slots_) {
+            if (slot) {
+                pools.push_back(std::atomic_load(&slot->pool));
+            }
+        }
+    }
+
+    size_t evicted = 0;
+    for (const auto& pool : pools) {
+        evicted += pool->evictIdle();
+    }
+    return evicted;
+}
+
+std::shared_ptr<ProxyManager::BackendSlot> ProxyManager::getSlot(const BackendEndpoint& backend) {
+    size_t index = static_cast<size_t>(backend.id);
+    std::shared_ptr<BackendSlot> slot;
+
+    {
+        std::shared_lock<std::shared_mutex> lock(slots_mutex_);
+        if (index < slots_.size()) {
+            slot = slots_[index];
+        }
+    }
+
+    if (!slot) {
+        std::unique_lock<std::shared_mutex> lock(slots_mutex_);
+        if (index >= slots_.size()) {
+            slots_.resize(index + 1);
+        }
+        if (!slots_[index]) {
+            auto created = std::make_shared<BackendSlot>();
+            created->pool = std::make_shared<ConnectionPool>(backend, pool_config_);
+            created->generation = backend.generation;
+            slots_[index] = created;
+        }
+        slot = slots_[index];
+    }
 
-    auto it = backend_health_.find(backend_url);
-    if (it != backend_health_.end()) {
-        return it->second;
+    // Backend was re-resolved to a new address: start a fresh pool, keep health state
+    uint64_t seen = slot->generation.load();
+    if (backend.generation > seen &&
+        slot->generation.compare_exchange_strong(seen, backend.generation)) {
+        std::atomic_store(&slot->pool, std::make_shared<ConnectionPool>(backend, pool_config_));
     }
 
-    // Create new health entry
-    auto health = std::make_shared<BackendHealth>();
-    backend_health_[backend_url] = health;
-    return health;
+    return slot;
+}
+
+bool ProxyManager::admitRequest(BackendHealth& health) {
+    std::lock_guard<std::mutex> lock(health.mtx);
+
+    if (health.circuit_state == CircuitState::OPEN) {
+        // Check if we should attempt recovery
+        if (!shouldAttemptRecovery(health)) {
+            return false;
+        }
+        health.circuit_state = CircuitState::HALF_OPEN;
+    }
+    return true;
 }
 
-void ProxyManager::recordSuccess(const std::string& backend_url) {
-    auto health = getBackendHealth(backend_url);
-    std::lock_guard<std::mutex> lock(health->mtx);
+void ProxyManager::recordSuccess(BackendHealth& health) {
+    std::lock_guard<std::mutex> lock(health.mtx);
 
-    health->failure_count = 0;
-    health->status = HealthStatus::HEALTHY;
+    health.failure_count = 0;
+    health.status = HealthStatus::HEALTHY;
 
-    if (health->circuit_state == CircuitState::HALF_OPEN) {
-        health->circuit_state = CircuitState::CLOSED;
+    if (health.circuit_state == CircuitState::HALF_OPEN) {
+        health.circuit_state = CircuitState::CLOSED;
     }
 }
 
-void ProxyManager::recordFailure(const std::string& backend_url) {
-    auto health = getBackendHealth(backend_url);
-    std::lock_guard<std::mutex> lock(health->mtx);
+void ProxyManager::recordFailure(BackendHealth& health) {
+    std::lock_guard<std::mutex> lock(health.mtx);
 
-    health->failure_count++;
-    health->status = HealthStatus::UNHEALTHY;
+    health.failure_count++;
+    health.status = HealthStatus::UNHEALTHY;
 
-    if (health->failure_count >= failure_threshold_) {
-        health->circuit_state = CircuitState::OPEN;
-        health->circuit_opened_at = std::chrono::steady_clock::now();
+    if (health.failure_count >= failure_threshold_) {
+        health.circuit_state = CircuitState::OPEN;
+        health.circuit_opened_at = std::chrono::steady_clock::now();
     }
 }
 
@@ -172,7 +535,7 @@ bool ProxyManager::shouldAttemptRecovery(const BackendHealth& health) {
 
 ProxyResponse ProxyManager::makeRequest(
     const std::string& method,
-    const std::string& url,
+    ConnectionPool& pool,
     const std::string& path,
     const std::map<std::string, std::string>& headers,
     const std::string& body,
@@ -181,44 +544,11 @@ ProxyResponse ProxyManager::makeRequest(
     ProxyResponse response;
 
     try {
-        // Extract host and port from URL
-        std::string host;
-        int port = 80;
-        std::string url_copy = url;
-
-        // Remove protocol
-        if (url_copy.find("http://") == 0) {
-            url_copy = url_copy.substr(7);
-        } else if (url_copy.find("https://") == 0) {
-            url_copy = url_copy.substr(8);
-            port = 443;
-        }
-
-        // Extract host and port
-        size_t colon_pos = url_copy.find(':');
-        size_t slash_pos = url_copy.find('/');
-
-        if (colon_pos != std::string::npos && (slash_pos == std::string::npos || colon_pos < slash_pos)) {
-            host = url_copy.substr(0, colon_pos);
-            std::string port_str = (slash_pos != std::string::npos)
-                ? url_copy.substr(colon_pos + 1, slash_pos - colon_pos - 1)
-                : url_copy.substr(colon_pos + 1);
-            port = std::stoi(port_str);
-        } else {
-            host = (slash_pos != std::string::npos) ? url_copy.substr(0, slash_pos) : url_copy;
-        }
-
-        httplib::Client client(host, port);
-        client.set_connection_timeout(timeout_ms / 1000, (timeout_ms % 1000) * 1000);
-        client.set_read_timeout(timeout_ms / 1000, (timeout_ms % 1000) * 1000);
+        auto lease = pool.acquire(timeout_ms);
+        auto& client = lease.client();
 
         // Prepare headers
-        httplib::Headers httplib_headers;
-        for (const auto& [key, value] : headers) {
-            if (key != "Host" && key != "Content-Length") {
-                httplib_headers.insert({key, value});
-            }
-        }
+        httplib::Headers httplib_headers = upstreamHeaders(headers);
 
         // Make request based on method
         httplib::Result res;
@@ -241,12 +571,13 @@ ProxyResponse ProxyManager::makeRequest(
         if (res) {
             response.success = true;
             response.status_code = res->status;
-            response.body = res->body;
+            response.body = std::move(res->body);
 
-            for (const auto& header : res->headers) {
-                response.headers[header.first] = header.second;
+            for (auto& header : res->headers) {
+                response.headers[header.first] = std::move(header.second);
             }
         } else {
+            lease.markBroken();
             response.error = "Request failed: " + httplib::to_string(res.error());
         }
 
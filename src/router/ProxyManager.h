@@ -2,10 +2,18 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <memory>
 #include <chrono>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
+#include <deque>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include "BackendEndpoint.h"
+#include "ConnectionPool.h"
 
 namespace gateway {
 
@@ -60,12 +68,84 @@ struct ProxyResponse {
     ProxyResponse() : status_code(0), success(false), response_time_ms(0) {}
 };
 
+/**
+ * @brief Backend response whose body is relayed as it arrives
+ *
+ * A pump thread reads the body into a small bounded buffer and blocks
+ * while it is full; the caller drains it with read(), or with poll() and
+ * onReadable() when it must not block. Memory per request is therefore the
+ * buffer size, not the body size. Destroying the stream cancels an
+ * unfinished upstream request, closing its connection at once.
+ */
+class ProxyStream {
+public:
+    explicit ProxyStream(size_t buffer_bytes);
+    ~ProxyStream();
+
+    ProxyStream(const ProxyStream&) = delete;
+    ProxyStream& operator=(const ProxyStream&) = delete;
+
+    /**
+     * @brief Status and headers (body is unused); fixed once openStream() returns
+     */
+    const ProxyResponse& head() const { return head_; }
+
+    /**
+     * @brief Wait for the next buffered body bytes
+     * @param timeout_ms Longest wait for the backend to send more
+     * @return false at the end of the body; failed() tells whether it was cut short
+     */
+    bool read(std::string& chunk, int timeout_ms);
+
+    enum class Poll { DATA, PENDING, END };
+
+    /**
+     * @brief Take the buffered body bytes without waiting
+     * @return DATA if chunk was filled, PENDING if nothing arrived yet, END
+     *         at the end of the body (see failed())
+     */
+    Poll poll(std::string& chunk);
+
+    /**
+     * @brief Call notify (on the pump thread) whenever poll() may have
+     *        something new; it runs once straight away if it already has
+     */
+    void onReadable(std::function<void()> notify);
+
+    bool failed() const;
+
+private:
+    friend class ProxyManager;
+
+    ProxyResponse head_;
+    size_t capacity_;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::string> chunks_;
+    size_t buffered_ = 0;
+    bool head_ready_ = false;
+    bool done_ = false;
+    bool failed_ = false;
+    bool cancelled_ = false;
+    std::function<void()> notify_;
+    std::function<void()> abort_;      // Shuts the upstream socket while the pump reads
+    std::thread pump_;
+
+    // Pump side
+    bool setHead(ProxyResponse head);
+    bool setAbort(std::function<void()> abort);
+    void notifyReadable();
+    bool push(const char* data, size_t size);
+    void finish(bool complete);
+    void waitForHead();
+};
+
 /**
  * @brief Proxy Manager for forwarding requests to backends
  *
  * Features:
  * - HTTP client for backend requests
- * - Connection pooling
+ * - Keep-alive connection pooling per backend
  * - Health checks
  * - Circuit breaker pattern
  * - Timeout handling
@@ -76,13 +156,15 @@ public:
      * @brief Constructor
      * @param failure_threshold Failures before opening circuit
      * @param recovery_timeout Seconds before attempting recovery
+     * @param pool_config Upstream connection pool settings
      */
-    ProxyManager(int failure_threshold = 5, int recovery_timeout = 60);
+    ProxyManager(int failure_threshold = 5, int recovery_timeout = 60,
+                 const ConnectionPoolConfig& pool_config = ConnectionPoolConfig());
 
     /**
      * @brief Forward request to backend
      * @param method HTTP method
-     * @param backend_url Backend URL
+     * @param backend Parsed backend (from RouteMatch)
      * @param path Request path
      * @param headers Request headers
      * @param body Request body
@@ -91,53 +173,112 @@ public:
      */
     ProxyResponse forwardRequest(
         const std::string& method,
-        const std::string& backend_url,
+        const BackendEndpoint& backend,
         const std::string& path,
         const std::map<std::string, std::string>& headers,
         const std::string& body,
         int timeout_ms = 5000
     );
 
+    /**
+     * @brief Forward a request and return once the backend's status and
+     *        headers arrived; the body follows through ProxyStream::read()
+     * @param idle_timeout_ms Longest silence from the backend once connected
+     *        (long-lived event streams need more than timeout_ms)
+     * @param buffer_bytes Body bytes held at most while the reader catches up
+     * @return Stream whose head() has success == false if the request failed;
+     *         status_code 503 if the stream limit or circuit breaker refused it
+     */
+    std::shared_ptr<ProxyStream> openStream(
+        const std::string& method,
+        const BackendEndpoint& backend,
+        const std::string& path,
+        const std::map<std::string, std::string>& headers,
+        const std::string& body,
+        int timeout_ms,
+        int idle_timeout_ms,
+        size_t buffer_bytes
+    );
+
     /**
      * @brief Check backend health
-     * @param backend_url Backend URL
+     * @param backend Parsed backend
      * @return true if healthy
      */
-    bool isHealthy(const std::string& backend_url);
+    bool isHealthy(const BackendEndpoint& backend);
 
     /**
-     * @brief Perform health check on backend
-     * @param backend_url Backend URL
+     * @brief Perform health check on backend, then top its pool up to min_idle
+     * @param backend Parsed backend
      * @return true if health check passed
      */
-    bool performHealthCheck(const std::string& backend_url);
+    bool performHealthCheck(const BackendEndpoint& backend);
 
     /**
      * @brief Get circuit state for backend
      */
-    CircuitState getCircuitState(const std::string& backend_url);
+    CircuitState getCircuitState(const BackendEndpoint& backend);
+
+    /**
+     * @brief Number of requests currently being forwarded to a backend
+     * @param backend_id BackendEndpoint::id
+     */
+    int getInFlight(int backend_id);
+
+    /**
+     * @brief Close pooled connections that have been idle too long
+     * @return Number of connections evicted across all backends
+     */
+    size_t evictIdleConnections();
+
+    /**
+     * @brief Cap on streams open at once; each holds a reader thread and a
+     *        backend connection until its body has been relayed
+     */
+    void setMaxStreams(size_t max_streams) { max_streams_.store(max_streams); }
+
+    size_t getOpenStreams() const { return open_streams_.load(); }
 
 private:
-    std::map<std::string, std::shared_ptr<BackendHealth>> backend_health_;
-    std::mutex health_mutex_;
+    /**
+     * @brief Per-backend state, indexed by BackendEndpoint::id
+     */
+    struct BackendSlot {
+        BackendHealth health;
+        std::shared_ptr<ConnectionPool> pool;    // Swapped atomically on re-resolution
+        std::atomic<uint64_t> generation{0};     // Endpoint generation the pool was built for
+        std::atomic<int> in_flight{0};           // Requests currently forwarded (least_conn input)
+    };
+
+    std::vector<std::shared_ptr<BackendSlot>> slots_;
+    std::shared_mutex slots_mutex_;
+    ConnectionPoolConfig pool_config_;
+    std::atomic<size_t> max_streams_{256};
+    std::atomic<size_t> open_streams_{0};
 
     int failure_threshold_;
     int recovery_timeout_;
 
     /**
-     * @brief Get or create health info for backend
+     * @brief Get or create state for backend
+     */
+    std::shared_ptr<BackendSlot> getSlot(const BackendEndpoint& backend);
+
+    /**
+     * @brief Apply the circuit breaker before a request
+     * @return false if the circuit is open
      */
-    std::shared_ptr<BackendHealth> getBackendHealth(const std::string& backend_url);
+    bool admitRequest(BackendHealth& health);
 
     /**
      * @brief Record successful request
      */
-    void recordSuccess(const std::string& backend_url);
+    void recordSuccess(BackendHealth& health);
 
     /**
      * @brief Record failed request
      */
-    void recordFailure(const std::string& backend_url);
+    void recordFailure(BackendHealth& health);
 
     /**
      * @brief Check if circuit should be half-opened
@@ -149,7 +290,7 @@ private:
      */
     ProxyResponse makeRequest(
         const std::string& method,
-        const std::string& url,
+        ConnectionPool& pool,
         const std::string& path,
         const std::map<std::string, std::string>& headers,
         const std::string& body,
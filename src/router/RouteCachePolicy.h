@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <bitset>
+#include <cstddef>
+
+namespace gateway {
+
+/**
+ * @brief Response caching rules for one route
+ *
+ * Routes get these from their "cache" block in routes.json, layered over
+ * the gateway-wide defaults when the routes are loaded, so checking a
+ * response against them is a few field reads.
+ */
+struct RouteCachePolicy {
+    static constexpr int MAX_STATUS = 600;
+
+    bool enabled = true;
+    int ttl_seconds = 300;
+    std::bitset<MAX_STATUS> statuses;           // Cacheable status codes
+    size_t max_entry_bytes = 1048576;           // Larger bodies are not cached (0 = no limit)
+
+    // Request parts that select a cache entry
+    bool key_query = true;                      // Query string
+    bool key_credentials = true;                // Authorization / X-API-Key
+    std::vector<std::string> key_headers;       // Always keyed on these (lowercase)
+
+    // Negative caching (opt-in): 404s and error bursts are absorbed for a short TTL
+    std::bitset<MAX_STATUS> negative_statuses;
+    int negative_ttl_seconds = 0;               // 0 = off
+
+    RouteCachePolicy() { statuses.set(200); }
+
+    /**
+     * @brief Seconds to cache a response for, or 0 if it is not cached
+     *
+     * Negative statuses take their short TTL even if also listed in statuses.
+     */
+    int ttlFor(int status, size_t body_size) const {
+        if (!enabled || status < 0 || status >= MAX_STATUS ||
+            (max_entry_bytes != 0 && body_size > max_entry_bytes)) {
+            return 0;
+        }
+        if (isNegative(status)) {
+            return negative_ttl_seconds;
+        }
+        return statuses.test(status) ? ttl_seconds : 0;
+    }
+
+    bool isNegative(int status) const {
+        return negative_ttl_seconds > 0 && status >= 0 && status < MAX_STATUS && negative_statuses.test(status);
+    }
+
+    bool cacheable(int status, size_t body_size) const { return ttlFor(status, body_size) > 0; }
+
+    /**
+     * @brief Replace a status set, ignoring codes out of range
+     */
+    static void assignStatuses(std::bitset<MAX_STATUS>& set, const std::vector<int>& codes) {
+        set.reset();
+        for (int code : codes) {
+            if (code > 0 && code < MAX_STATUS) {
+                set.set(code);
+            }
+        }
+    }
+};
+
+} // namespace gateway
@@ -0,0 +1,124 @@
+#include "RouteTrie.h"
+#include <algorithm>
+
+namespace gateway {
+
+RouteTrie::RouteTrie()
+    : root_(std::make_unique<Node>()) {}
+
+RouteTrie::~RouteTrie() = default;
+
+void RouteTrie::insert(const std::string& pattern, size_t route_index) {
+    std::string_view body = pattern;
+
+    // Trailing /* matches the prefix itself or anything below it: (/.*)?
+    bool subtree = body.size() >= 2 && body.substr(body.size() - 2) == "/*";
+    if (subtree) {
+        body.remove_suffix(2);
+    }
+
+    Node* node = root_.get();
+    node->min_route = std::min(node->min_route, route_index);
+
+    // Literal runs separated by inner wildcards
+    size_t start = 0;
+    while (true) {
+        size_t star = body.find('*', start);
+        node = insertLiteral(node, body.substr(start, star - start), route_index);
+        if (star == std::string_view::npos) {
+            break;
+        }
+
+        if (!node->wildcard) {
+            node->wildcard = std::make_unique<Node>();
+        }
+        node = node->wildcard.get();
+        node->min_route = std::min(node->min_route, route_index);
+        start = star + 1;
+    }
+
+    size_t& slot = subtree ? node->subtree : node->exact;
+    slot = std::min(slot, route_index);
+}
+
+std::optional<size_t> RouteTrie::match(std::string_view path) const {
+    size_t best = NO_ROUTE;
+    matchNode(*root_, path, best);
+    if (best == NO_ROUTE) {
+        return std::nullopt;
+    }
+    return best;
+}
+
+void RouteTrie::clear() {
+    root_ = std::make_unique<Node>();
+}
+
+RouteTrie::Node* RouteTrie::insertLiteral(Node* node, std::string_view literal, size_t route_index) {
+    while (!literal.empty()) {
+        auto it = std::lower_bound(node->children.begin(), node->children.end(), literal[0],
+            [](const std::unique_ptr<Node>& child, char c) { return child->label[0] < c; });
+
+        if (it == node->children.end() || (*it)->label[0] != literal[0]) {
+            auto child = std::make_unique<Node>();
+            child->label = std::string(literal);
+            child->min_route = route_index;
+            Node* created = child.get();
+            node->children.insert(it, std::move(child));
+            return created;
+        }
+
+        Node* child = it->get();
+        size_t common = 0;
+        size_t limit = std::min(child->label.size(), literal.size());
+        while (common < limit && child->label[common] == literal[common]) {
+            common++;
+        }
+
+        if (common < child->label.size()) {
+            // Split the edge: new node takes the shared part, old child keeps the tail
+            auto split = std::make_unique<Node>();
+            split->label = child->label.substr(0, common);
+            split->min_route = child->min_route;
+            child->label.erase(0, common);
+            split->children.push_back(std::move(*it));
+            *it = std::move(split);
+            child = it->get();
+        }
+
+        child->min_route = std::min(child->min_route, route_index);
+        node = child;
+        literal.remove_prefix(common);
+    }
+    return node;
+}
+
+void RouteTrie::matchNode(const Node& node, std::string_view rest, size_t& best) {
+    if (node.min_route >= best) {
+        return;
+    }
+
+    if (rest.empty() && node.exact < best) {
+        best = node.exact;
+    }
+    if (node.subtree < best && (rest.empty() || rest[0] == '/')) {
+        best = node.subtree;
+    }
+
+    if (!rest.empty()) {
+        auto it = std::lower_bound(node.children.begin(), node.children.end(), rest[0],
+            [](const std::unique_ptr<Node>& child, char c) { return child->label[0] < c; });
+        if (it != node.children.end() && rest.compare(0, (*it)->label.size(), (*it)->label) == 0) {
+            matchNode(**it, rest.substr((*it)->label.size()), best);
+        }
+    }
+
+    // Inner wildcard: try every split point, shortest first
+    if (node.wildcard) {
+        for (size_t skip = 0; skip <= rest.size() && node.wildcard->min_route < best; skip++) {
+            matchNode(*node.wildcard, rest.substr(skip), best);
+        }
+    }
+}
+
+} // namespace gateway
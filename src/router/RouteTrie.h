@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstddef>
+
+namespace gateway {
+
+// Pattern syntax (same as the regex matcher it replaces):
+//   "/api/users"     exact match
+//   "/api/users/*"   "/api/users" itself or anything below "/api/users/"
+//   "/files/*.json"  inner "*" matches any run of characters (including "/")
+
+/**
+ * @brief Compressed prefix trie mapping path patterns to route indices
+ *
+ * Literal patterns match in O(path length) regardless of how many routes
+ * are loaded. When several patterns match, the lowest route index wins,
+ * which preserves the first-match-in-load-order semantics of the old
+ * linear regex scan.
+ */
+class RouteTrie {
+public:
+    RouteTrie();
+    ~RouteTrie();
+
+    /**
+     * @brief Add a pattern
+     * @param pattern Path pattern, see syntax above
+     * @param route_index Index reported by match(); lower indices take priority
+     */
+    void insert(const std::string& pattern, size_t route_index);
+
+    /**
+     * @brief Find the highest-priority pattern matching path
+     * @return Route index, or nullopt if nothing matches
+     */
+    std::optional<size_t> match(std::string_view path) const;
+
+    /**
+     * @brief Remove all patterns
+     */
+    void clear();
+
+private:
+    static constexpr size_t NO_ROUTE = static_cast<size_t>(-1);
+
+    struct Node {
+        std::string label;                           // Literal edge text leading into this node
+        std::vector<std::unique_ptr<Node>> children; // Sorted by label[0]
+        std::unique_ptr<Node> wildcard;              // Inner "*": rest of the pattern hangs off here
+        size_t exact = NO_ROUTE;                     // Pattern ends here
+        size_t subtree = NO_ROUTE;                   // Pattern ends here with a trailing "/*"
+        size_t min_route = NO_ROUTE;                 // Lowest index anywhere below, for pruning
+    };
+
+    std::unique_ptr<Node> root_;
+
+    /**
+     * @brief Walk/split edges to insert literal below node, returning its end node
+     */
+    static Node* insertLiteral(Node* node, std::string_view literal, size_t route_index);
+
+    /**
+     * @brief Collect the lowest matching route index below node into best
+     * @param rest Path remaining after node's label has been consumed
+     */
+    static void matchNode(const Node& node, std::string_view rest, size_t& best);
+};
+
+} // namespace gateway
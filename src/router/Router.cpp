@@ -1,61 +1,137 @@
 #include "Router.h"
+#include "../cache/GlobMatch.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
 #include <random>
 #include <set>
+#include <atomic>
+#include <algorithm>
+#include <unordered_set>
 
 namespace gateway {
 
 using json = nlohmann::json;
 
-Router::Router() {}
+namespace {
+// Global so a Router created at a recycled address never matches a stale thread cache
+std::atomic<uint64_t> g_next_table_version{1};
+}
+
+Router::Router() {
+    publish({});
+}
 
 void Router::addRoute(const Route& route) {
-    Route r = route;
-    r.path_regex = patternToRegex(route.path_pattern);
-    routes_.push_back(r);
+    std::lock_guard<std::mutex> lock(write_mtx_);
+    std::vector<Route> routes = snapshot()->routes;
+    routes.push_back(compileRoute(route));
+    publish(std::move(routes));
 }
 
 std::optional<RouteMatch> Router::matchRoute(const std::string& path) {
-    for (const auto& route : routes_) {
-        std::smatch match;
-        if (std::regex_match(path, match, route.path_regex)) {
-            RouteMatch result;
-            result.route = &route;
-            result.matched_path = path;
-            result.rewritten_path = rewritePath(path, route);
-
-            // Select backend if not an internal handler
-            if (route.handler.empty() && !route.backends.empty()) {
-                result.backend_url = selectBackend(route);
-            }
+    auto table = snapshot();
+
+    // Scanners repeat the same unknown paths; remember misses per thread
+    // for the current table so a repeat is one hash lookup
+    struct MissCache {
+        uint64_t version = 0;
+        std::unordered_set<std::string> paths;
+    };
+    thread_local MissCache misses;
+    size_t miss_limit = miss_cache_size_.load(std::memory_order_relaxed);
+    if (miss_limit > 0) {
+        if (misses.version != table->version) {
+            misses.paths.clear();
+            misses.version = table->version;
+        }
+        if (misses.paths.count(path)) {
+            return std::nullopt;
+        }
+    }
 
-            return result;
+    auto index = table->trie.match(path);
+    if (!index) {
+        if (miss_limit > 0) {
+            if (misses.paths.size() >= miss_limit) {
+                misses.paths.clear();
+            }
+            misses.paths.insert(path);
         }
+        return std::nullopt;
+    }
+
+    const Route& route = table->routes[*index];
+    RouteMatch result;
+    result.route = &route;
+    result.matched_path = path;
+    result.rewritten_path = rewritePath(path, route);
+
+    // Select backend if not an internal handler
+    if (route.handler.empty() && !route.endpoints.empty()) {
+        const BackendEndpoint* backend = route.endpoints[selectBackend(route)].get();
+        result.backend = backend;
+        result.backend_id = backend->id;
+        result.backend_url = backend->url;
     }
-    return std::nullopt;
+
+    result.table = std::move(table);
+    return result;
 }
 
 int Router::loadRoutes(const std::string& routes_json) {
+    std::lock_guard<std::mutex> lock(write_mtx_);
+    auto parsed = parseRoutes(routes_json);
+    if (!parsed) {
+        return 0;
+    }
+
+    std::vector<Route> routes = snapshot()->routes;
+    int count = static_cast<int>(parsed->size());
+    for (auto& route : *parsed) {
+        routes.push_back(std::move(route));
+    }
+    publish(std::move(routes));
+    return count;
+}
+
+int Router::replaceRoutes(const std::string& routes_json) {
+    std::lock_guard<std::mutex> lock(write_mtx_);
+    auto parsed = parseRoutes(routes_json);
+    if (!parsed) {
+        return -1;
+    }
+
+    int count = static_cast<int>(parsed->size());
+    publish(std::move(*parsed));
+    return count;
+}
+
+std::optional<std::vector<Route>> Router::parseRoutes(const std::string& routes_json) {
     try {
         json config = json::parse(routes_json);
 
         if (!config.contains("routes") || !config["routes"].is_array()) {
             std::cerr << "Invalid routes configuration\n";
-            return 0;
+            return std::nullopt;
         }
 
-        int count = 0;
+        std::vector<Route> routes;
         for (const auto& route_json : config["routes"]) {
             Route route;
 
             route.path_pattern = route_json.value("path", "");
             route.timeout_ms = route_json.value("timeout", 5000);
             route.require_auth = route_json.value("require_auth", false);
+            route.stream = route_json.value("stream", false);
+            route.event_stream = route_json.value("event_stream", false);
+            route.stream_idle_timeout_ms = route_json.value("stream_idle_timeout", 0);
             route.strip_prefix = route_json.value("strip_prefix", "");
             route.handler = route_json.value("handler", "");
             route.load_balancing = route_json.value("load_balancing", "round_robin");
+            if (route_json.contains("cache")) {
+                route.cache_config = route_json["cache"];
+            }
 
             // Handle single backend or multiple backends
             if (route_json.contains("backend")) {
@@ -67,22 +143,143 @@ int Router::loadRoutes(const std::string& routes_json) {
             }
 
             if (!route.path_pattern.empty()) {
-                addRoute(route);
-                count++;
+                routes.push_back(compileRoute(route));
             }
         }
 
-        return count;
+        return routes;
 
     } catch (const std::exception& e) {
         std::cerr << "Error loading routes: " << e.what() << "\n";
-        return 0;
+        return std::nullopt;
     }
 }
 
+Route Router::compileRoute(const Route& route) {
+    Route r = route;
+    r.strategy = parseLoadBalancing(route.load_balancing);
+
+    // Parse and resolve backends once, here, instead of on every request
+    r.backends.clear();
+    r.endpoints.clear();
+    for (const auto& url : route.backends) {
+        auto endpoint = backend_registry_.resolve(url);
+        if (!endpoint) {
+            std::cerr << "Invalid backend URL for route " << route.path_pattern << ": " << url << "\n";
+            continue;
+        }
+        r.backends.push_back(url);
+        r.endpoints.push_back(endpoint);
+    }
+
+    r.cache = compileCachePolicy(route);
+    return r;
+}
+
+RouteCachePolicy Router::compileCachePolicy(const Route& route) const {
+    RouteCachePolicy policy = cache_defaults_;
+    for (const auto& pattern : cache_exclude_paths_) {
+        if (globMatch(pattern, route.path_pattern)) {
+            policy.enabled = false;
+            break;
+        }
+    }
+
+    // "cache": false / true, or an object overriding individual settings
+    const json& config = route.cache_config;
+    try {
+        if (config.is_boolean()) {
+            policy.enabled = config.get<bool>();
+        } else if (config.is_object()) {
+            policy.enabled = config.value("enabled", policy.enabled);
+            policy.ttl_seconds = config.value("ttl", policy.ttl_seconds);
+            policy.max_entry_bytes = config.value("max_entry_size", policy.max_entry_bytes);
+
+            if (config.contains("statuses")) {
+                RouteCachePolicy::assignStatuses(policy.statuses, config["statuses"].get<std::vector<int>>());
+            }
+
+            // "negative": false, or {"ttl": seconds, "statuses": [...]}
+            if (config.contains("negative")) {
+                const json& negative = config["negative"];
+                if (negative.is_boolean()) {
+                    if (!negative.get<bool>()) {
+                        policy.negative_ttl_seconds = 0;
+                    }
+                } else {
+                    policy.negative_ttl_seconds = negative.value("ttl", policy.negative_ttl_seconds);
+                    if (negative.contains("statuses")) {
+                        RouteCachePolicy::assignStatuses(policy.negative_statuses,
+                                                         negative["statuses"].get<std::vector<int>>());
+                    }
+                }
+            }
+
+            if (config.contains("key")) {
+                const json& key = config["key"];
+                policy.key_query = key.value("query", policy.key_query);
+                policy.key_credentials = key.value("credentials", policy.key_credentials);
+                if (key.contains("headers")) {
+                    policy.key_headers = key["headers"].get<std::vector<std::string>>();
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid cache settings for route " << route.path_pattern << ": " << e.what()
+                  << " (caching disabled)\n";
+        policy.enabled = false;
+    }
+
+    for (auto& name : policy.key_headers) {
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    }
+    std::sort(policy.key_headers.begin(), policy.key_headers.end());
+    policy.key_headers.erase(std::unique(policy.key_headers.begin(), policy.key_headers.end()),
+                             policy.key_headers.end());
+
+    // Internal handlers answer locally, streamed bodies are never held in
+    // full, and a zero TTL would never be fresh
+    bool positive = policy.ttl_seconds > 0 && policy.statuses.any();
+    bool negative = policy.negative_ttl_seconds > 0 && policy.negative_statuses.any();
+    if (!route.handler.empty() || route.stream || (!positive && !negative)) {
+        policy.enabled = false;
+    }
+    return policy;
+}
+
+std::shared_ptr<const RouteTable> Router::snapshot() const {
+    struct Cache {
+        const Router* owner = nullptr;
+        uint64_t version = 0;
+        std::shared_ptr<const RouteTable> table;
+    };
+    thread_local Cache cache;
+
+    uint64_t version = table_version_.load(std::memory_order_acquire);
+    if (cache.owner != this || cache.version != version) {
+        cache.table = std::atomic_load(&table_);
+        cache.owner = this;
+        cache.version = cache.table->version;
+    }
+    return cache.table;
+}
+
+void Router::publish(std::vector<Route> routes) {
+    auto table = std::make_shared<RouteTable>();
+    table->routes = std::move(routes);
+    for (size_t i = 0; i < table->routes.size(); i++) {
+        table->trie.insert(table->routes[i].path_pattern, i);
+    }
+    table->version = g_next_table_version.fetch_add(1);
+
+    uint64_t version = table->version;
+    std::atomic_store(&table_, std::shared_ptr<const RouteTable>(std::move(table)));
+    table_version_.store(version, std::memory_order_release);
+}
+
 std::vector<std::string> Router::getAllBackendUrls() const {
     std::set<std::string> unique_urls;
-    for (const auto& route : routes_) {
+    for (const auto& route : snapshot()->routes) {
         for (const auto& backend : route.backends) {
             unique_urls.insert(backend);
         }
@@ -90,13 +287,38 @@ std::vector<std::string> Router::getAllBackendUrls() const {
     return std::vector<std::string>(unique_urls.begin(), unique_urls.end());
 }
 
+std::vector<std::shared_ptr<const BackendEndpoint>> Router::getAllBackends() const {
+    std::map<int, std::shared_ptr<const BackendEndpoint>> unique_backends;
+    for (const auto& route : snapshot()->routes) {
+        for (const auto& endpoint : route.endpoints) {
+            unique_backends[endpoint->id] = endpoint;
+        }
+    }
+
+    std::vector<std::shared_ptr<const BackendEndpoint>> result;
+    result.reserve(unique_backends.size());
+    for (const auto& [id, endpoint] : unique_backends) {
+        result.push_back(endpoint);
+    }
+    return result;
+}
+
 json Router::getRoutesJSON() const {
     json routes_array = json::array();
-    for (const auto& route : routes_) {
+    for (const auto& route : snapshot()->routes) {
         json r;
         r["path"] = route.path_pattern;
         r["timeout"] = route.timeout_ms;
         r["require_auth"] = route.require_auth;
+        if (route.stream) {
+            r["stream"] = true;
+        }
+        if (route.event_stream) {
+            r["event_stream"] = true;
+        }
+        if (route.stream_idle_timeout_ms > 0) {
+            r["stream_idle_timeout"] = route.stream_idle_timeout_ms;
+        }
 
         if (!route.handler.empty()) {
             r["handler"] = route.handler;
@@ -114,74 +336,86 @@ json Router::getRoutesJSON() const {
             r["backends"] = route.backends;
         }
 
+        if (!route.cache_config.is_null()) {
+            r["cache"] = route.cache_config;
+        }
+
         routes_array.push_back(r);
     }
     return routes_array;
 }
 
 void Router::clearRoutes() {
-    routes_.clear();
-    backend_indices_.clear();
+    std::lock_guard<std::mutex> lock(write_mtx_);
+    publish({});
 }
 
-std::regex Router::patternToRegex(const std::string& pattern) {
-    std::string regex_pattern = pattern;
+void Router::setInFlightProvider(std::function<int(int backend_id)> provider) {
+    in_flight_provider_ = std::move(provider);
+}
 
-    // Escape special regex characters except *
-    std::string special_chars = ".^$+?()[]{}|\\";
-    for (char c : special_chars) {
-        std::string from(1, c);
-        std::string to = "\\" + from;
-        size_t pos = 0;
-        while ((pos = regex_pattern.find(from, pos)) != std::string::npos) {
-            regex_pattern.replace(pos, 1, to);
-            pos += to.length();
-        }
-    }
+void Router::setCacheDefaults(const RouteCachePolicy& defaults, std::vector<std::string> exclude_paths) {
+    std::lock_guard<std::mutex> lock(write_mtx_);
+    cache_defaults_ = defaults;
+    cache_exclude_paths_ = std::move(exclude_paths);
+}
 
-    // Convert trailing /* to optional match: (/.*)?
-    // This allows /api/users/* to match both /api/users and /api/users/123
-    if (regex_pattern.size() >= 2 &&
-        regex_pattern.substr(regex_pattern.size() - 2) == "/*") {
-        regex_pattern = regex_pattern.substr(0, regex_pattern.size() - 2) + "(/.*)?";
-    }
+void Router::setMissCacheSize(size_t max_entries) {
+    miss_cache_size_.store(max_entries, std::memory_order_relaxed);
+}
 
-    // Convert remaining * to .*
-    size_t pos = 0;
-    while ((pos = regex_pattern.find("*", pos)) != std::string::npos) {
-        regex_pattern.replace(pos, 1, ".*");
-        pos += 2;
+size_t Router::selectBackend(const Route& route) const {
+    size_t count = route.endpoints.size();
+    if (count <= 1) {
+        return 0;
     }
 
-    return std::regex(regex_pattern);
-}
+    switch (route.strategy) {
+        case LoadBalancing::ROUND_ROBIN:
+            return static_cast<size_t>(route.rr_counter.next() % count);
 
-std::string Router::selectBackend(const Route& route) {
-    if (route.backends.empty()) {
-        return "";
-    }
+        case LoadBalancing::RANDOM: {
+            // Per-thread engine: a shared one would be a data race
+            thread_local std::mt19937 gen(std::random_device{}());
+            std::uniform_int_distribution<size_t> dis(0, count - 1);
+            return dis(gen);
+        }
 
-    if (route.backends.size() == 1) {
-        return route.backends[0];
-    }
+        case LoadBalancing::LEAST_CONN: {
+            // Start the scan at a rotating offset so ties spread evenly
+            size_t start = static_cast<size_t>(route.rr_counter.next() % count);
+            if (!in_flight_provider_) {
+                return start;
+            }
+
+            size_t best = start;
+            int best_load = in_flight_provider_(route.endpoints[start]->id);
+            for (size_t i = 1; i < count && best_load > 0; i++) {
+                size_t candidate = (start + i) % count;
+                int load = in_flight_provider_(route.endpoints[candidate]->id);
+                if (load < best_load) {
+                    best = candidate;
+                    best_load = load;
+                }
+            }
+            return best;
+        }
 
-    if (route.load_balancing == "round_robin") {
-        // Round-robin selection
-        std::string key = route.path_pattern;
-        size_t& index = backend_indices_[key];
-        std::string backend = route.backends[index % route.backends.size()];
-        index++;
-        return backend;
-    } else if (route.load_balancing == "random") {
-        // Random selection
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, route.backends.size() - 1);
-        return route.backends[dis(gen)];
+        case LoadBalancing::FIRST:
+        default:
+            return 0;
     }
+}
 
-    // Default to first backend
-    return route.backends[0];
+LoadBalancing Router::parseLoadBalancing(const std::string& name) {
+    if (name == "round_robin") {
+        return LoadBalancing::ROUND_ROBIN;
+    } else if (name == "random") {
+        return LoadBalancing::RANDOM;
+    } else if (name == "least_conn") {
+        return LoadBalancing::LEAST_CONN;
+    }
+    return LoadBalancing::FIRST;
 }
 
 std::string Router::rewritePath(const std::string& original_path, const Route& route) {
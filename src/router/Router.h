@@ -3,38 +3,100 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <regex>
 #include <optional>
 #include <map>
 #include <set>
+#include <string_view>
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include "BackendEndpoint.h"
+#include "RouteTrie.h"
+#include "RouteCachePolicy.h"
 
 namespace gateway {
 
+/**
+ * @brief Load balancing strategy, parsed from Route::load_balancing by addRoute
+ */
+enum class LoadBalancing {
+    FIRST,          // Always the first backend (default for unknown/empty)
+    ROUND_ROBIN,
+    RANDOM,
+    LEAST_CONN      // Fewest in-flight requests, per ProxyManager
+};
+
+/**
+ * @brief Relaxed atomic counter that can be embedded in a copyable struct
+ *
+ * Copying takes a snapshot of the current value; the counter itself is
+ * only ever advanced through next().
+ */
+class RouteCounter {
+public:
+    RouteCounter() = default;
+    RouteCounter(const RouteCounter& other) : value_(other.value_.load(std::memory_order_relaxed)) {}
+    RouteCounter& operator=(const RouteCounter& other) {
+        value_.store(other.value_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    /**
+     * @brief Return the current value and advance it
+     */
+    uint64_t next() const { return value_.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    mutable std::atomic<uint64_t> value_{0};
+};
+
 /**
  * @brief Route configuration
  */
 struct Route {
     std::string path_pattern;       // e.g., "/api/users/*"
-    std::regex path_regex;          // Compiled regex for matching
     std::vector<std::string> backends;  // Backend URLs
+    std::vector<std::shared_ptr<const BackendEndpoint>> endpoints;  // Parsed backends, filled by addRoute
     std::string load_balancing;     // "round_robin", "random", "least_conn"
     int timeout_ms;                 // Request timeout
     bool require_auth;              // Require authentication
+    bool stream;                    // Relay the backend body as it arrives (never cached)
+    bool event_stream;              // Stream requests that accept text/event-stream
+    int stream_idle_timeout_ms;     // Backend silence allowed mid-stream (0 = timeout_ms)
     std::string strip_prefix;       // Prefix to strip from path
     std::string handler;            // Internal handler (e.g., "health_check")
+    LoadBalancing strategy;         // Parsed load_balancing, filled by addRoute
+    RouteCounter rr_counter;        // Round-robin position, shared by all worker threads
+    nlohmann::json cache_config;    // Route's "cache" block as configured (null if absent)
+    RouteCachePolicy cache;         // cache_config over the gateway defaults, filled by addRoute
+
+    Route() : timeout_ms(5000), require_auth(false), stream(false), event_stream(false), stream_idle_timeout_ms(0), strategy(LoadBalancing::FIRST) {}
+};
 
-    Route() : timeout_ms(5000), require_auth(false) {}
+/**
+ * @brief Immutable compiled route table
+ *
+ * Published as a whole by Router; never modified after publication
+ * (apart from the atomic counters inside each Route).
+ */
+struct RouteTable {
+    std::vector<Route> routes;
+    RouteTrie trie;         // path_pattern -> index into routes
+    uint64_t version = 0;   // Unique across all Router instances
 };
 
 /**
  * @brief Route match result
  */
 struct RouteMatch {
+    std::shared_ptr<const RouteTable> table;   // Keeps route/backend alive across a reload
     const Route* route;
     std::string matched_path;
     std::string rewritten_path;
-    std::string backend_url;
+    const BackendEndpoint* backend = nullptr;  // Selected backend (null for internal handlers)
+    int backend_id = -1;
+    std::string_view backend_url;              // Views backend->url, for logging
 };
 
 /**
@@ -42,9 +104,11 @@ struct RouteMatch {
  *
  * Features:
  * - Pattern-based routing with wildcards
- * - Load balancing (round-robin, random)
+ * - Load balancing (round-robin, random, least connections)
  * - Path rewriting
  * - Internal handlers (health checks)
+ * - Lock-free lookups; reloads publish a new RouteTable while in-flight
+ *   requests keep using the one they matched against
  */
 class Router {
 public:
@@ -67,17 +131,30 @@ public:
     std::optional<RouteMatch> matchRoute(const std::string& path);
 
     /**
-     * @brief Load routes from configuration
+     * @brief Load routes from configuration, appending to existing routes
      * @param routes_json JSON configuration
      * @return Number of routes loaded
      */
     int loadRoutes(const std::string& routes_json);
 
+    /**
+     * @brief Atomically replace all routes with the given configuration
+     * @param routes_json JSON configuration
+     * @return Number of routes loaded, or -1 if the configuration is invalid
+     *         (existing routes are kept in that case)
+     */
+    int replaceRoutes(const std::string& routes_json);
+
     /**
      * @brief Get all unique backend URLs from loaded routes
      */
     std::vector<std::string> getAllBackendUrls() const;
 
+    /**
+     * @brief Get all unique parsed backends from loaded routes
+     */
+    std::vector<std::shared_ptr<const BackendEndpoint>> getAllBackends() const;
+
     /**
      * @brief Get all routes as JSON
      */
@@ -88,19 +165,80 @@ public:
      */
     void clearRoutes();
 
+    /**
+     * @brief Set the source of live in-flight request counts used by least_conn
+     * @param provider Returns in-flight requests for a BackendEndpoint::id
+     *
+     * Without a provider, least_conn routes fall back to round-robin.
+     */
+    void setInFlightProvider(std::function<int(int backend_id)> provider);
+
+    /**
+     * @brief Set the cache policy routes start from before their own "cache" block
+     * @param defaults Gateway-wide cache settings
+     * @param exclude_paths Route patterns ('*' globs) that are never cached
+     *
+     * Applies to routes added or loaded afterwards.
+     */
+    void setCacheDefaults(const RouteCachePolicy& defaults, std::vector<std::string> exclude_paths = {});
+
+    /**
+     * @brief Remember paths that matched no route, so repeats skip the trie
+     * @param max_entries Paths remembered per thread (0 disables)
+     *
+     * The memo is per thread and dropped whenever the route table changes.
+     */
+    void setMissCacheSize(size_t max_entries);
+
 private:
-    std::vector<Route> routes_;
-    std::map<std::string, size_t> backend_indices_; // For round-robin
+    std::shared_ptr<const RouteTable> table_;     // Accessed only via std::atomic_load/store
+    std::atomic<uint64_t> table_version_{0};      // Version of table_, readable without a lock
+    std::mutex write_mtx_;                        // Serializes writers (add/load/replace/clear)
+    std::function<int(int)> in_flight_provider_;
+    BackendRegistry backend_registry_;
+    RouteCachePolicy cache_defaults_;             // Guarded by write_mtx_
+    std::vector<std::string> cache_exclude_paths_;
+    std::atomic<size_t> miss_cache_size_{0};
+
+    /**
+     * @brief Current route table
+     *
+     * Each thread caches the last table it saw and only touches the shared
+     * pointer again when the version changes, so lookups take no lock.
+     */
+    std::shared_ptr<const RouteTable> snapshot() const;
 
     /**
-     * @brief Convert wildcard pattern to regex
+     * @brief Build a table from routes and publish it (caller holds write_mtx_)
      */
-    std::regex patternToRegex(const std::string& pattern);
+    void publish(std::vector<Route> routes);
+
+    /**
+     * @brief Parse route definitions from JSON
+     * @return Routes, or nullopt if the configuration is invalid
+     */
+    std::optional<std::vector<Route>> parseRoutes(const std::string& routes_json);
+
+    /**
+     * @brief Parse load balancing, resolve backends and the cache policy for a route
+     */
+    Route compileRoute(const Route& route);
+
+    /**
+     * @brief Resolve a route's cache policy from its "cache" block and the defaults
+     */
+    RouteCachePolicy compileCachePolicy(const Route& route) const;
 
     /**
      * @brief Select backend using load balancing strategy
+     * @return Index into route.endpoints
+     */
+    size_t selectBackend(const Route& route) const;
+
+    /**
+     * @brief Map a load_balancing config string to a strategy
      */
-    std::string selectBackend(const Route& route);
+    static LoadBalancing parseLoadBalancing(const std::string& name);
 
     /**
      * @brief Rewrite path according to route config
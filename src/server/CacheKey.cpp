@@ -0,0 +1,185 @@
+#include "CacheKey.h"
+#include <openssl/sha.h>
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <sstream>
+
+namespace gateway {
+
+namespace {
+
+// Credentials the gateway authenticates with; responses are never shared across them
+const char* const CREDENTIAL_HEADERS[] = {"authorization", "x-api-key"};
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value;
+}
+
+std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(start, end - start + 1);
+}
+
+void appendEscaped(std::string& out, const std::string& value) {
+    static const char HEX[] = "0123456789ABCDEF";
+    for (char c : value) {
+        if (c == '%' || c == '&' || c == '=') {
+            out += '%';
+            out += HEX[(static_cast<unsigned char>(c) >> 4) & 0xF];
+            out += HEX[static_cast<unsigned char>(c) & 0xF];
+        } else {
+            out += c;
+        }
+    }
+}
+
+} // namespace
+
+CacheKeyBuilder::CacheKeyBuilder(size_t max_tracked)
+    : max_tracked_(std::max<size_t>(max_tracked, 1)) {
+}
+
+std::string CacheKeyBuilder::baseKey(const std::string& method, const std::string& path) {
+    return method + ":" + path;
+}
+
+std::string CacheKeyBuilder::normalizeQuery(const httplib::Params& params) {
+    // Names only: backends read repeated parameters (a=1&a=2) in order
+    std::vector<std::pair<std::string, std::string>> sorted(params.begin(), params.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::string query;
+    for (const auto& [name, value] : sorted) {
+        if (!query.empty()) {
+            query += '&';
+        }
+        appendEscaped(query, name);
+        query += '=';
+        appendEscaped(query, value);
+    }
+    return query;
+}
+
+std::string CacheKeyBuilder::build(const std::string& base, const std::string& query,
+                                   const std::map<std::string, std::string>& request_headers,
+                                   const RouteCachePolicy& policy) {
+    // Everything that selects a variant, NUL-separated
+    std::string variant = policy.key_query ? query : "";
+    if (policy.key_credentials) {
+        for (const char* name : CREDENTIAL_HEADERS) {
+            if (const std::string* value = findHeader(request_headers, name)) {
+                variant += '\0';
+                variant += name;
+                variant += '\0';
+                variant += *value;
+            }
+        }
+    }
+    for (const auto& name : policy.key_headers) {
+        const std::string* value = findHeader(request_headers, name);
+        variant += '\0';
+        variant += name;
+        variant += '\0';
+        variant += value ? trim(*value) : "";
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = vary_.find(base);
+        if (it != vary_.end()) {
+            for (const auto& name : it->second) {
+                const std::string* value = findHeader(request_headers, name);
+                variant += '\0';
+                variant += name;
+                variant += '\0';
+                variant += value ? trim(*value) : "";
+            }
+        }
+    }
+
+    if (variant.empty()) {
+        return base;
+    }
+
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(variant.data()), variant.size(), hash);
+
+    // 128 bits is plenty to keep variants of one path apart
+    static const char HEX[] = "0123456789abcdef";
+    std::string key = base + "#";
+    for (size_t i = 0; i < 16; i++) {
+        key += HEX[hash[i] >> 4];
+        key += HEX[hash[i] & 0xF];
+    }
+    return key;
+}
+
+bool CacheKeyBuilder::learnVary(const std::string& base,
+                                const std::map<std::string, std::string>& response_headers) {
+    std::vector<std::string> names;
+    if (const std::string* vary = findHeader(response_headers, "vary")) {
+        std::stringstream ss(*vary);
+        std::string name;
+        while (std::getline(ss, name, ',')) {
+            name = toLower(trim(name));
+            if (name == "*") {
+                return false;
+            }
+            if (!name.empty()) {
+                names.push_back(name);
+            }
+        }
+    }
+    if (findHeader(response_headers, "content-encoding")) {
+        names.push_back("accept-encoding");
+    }
+
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    // Credentials are always part of the key
+    names.erase(std::remove_if(names.begin(), names.end(), [](const std::string& name) {
+        return std::find(std::begin(CREDENTIAL_HEADERS), std::end(CREDENTIAL_HEADERS), name) !=
+               std::end(CREDENTIAL_HEADERS);
+    }), names.end());
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = vary_.find(base);
+        if (it != vary_.end() ? it->second == names : names.empty()) {
+            return true;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (names.empty()) {
+        vary_.erase(base);
+        return true;
+    }
+    if (vary_.size() >= max_tracked_ && vary_.find(base) == vary_.end()) {
+        // Forgetting a Vary only costs a miss until the next response restores it
+        vary_.clear();
+    }
+    vary_[base] = std::move(names);
+    return true;
+}
+
+const std::string* CacheKeyBuilder::findHeader(const std::map<std::string, std::string>& headers,
+                                               const std::string& lower_name) {
+    for (const auto& [name, value] : headers) {
+        if (name.size() == lower_name.size() &&
+            std::equal(name.begin(), name.end(), lower_name.begin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == b;
+            })) {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace gateway
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstddef>
+#include <httplib.h>
+#include "../router/RouteCachePolicy.h"
+
+namespace gateway {
+
+/**
+ * @brief Builds response cache keys that separate every variant
+ *
+ * A key is the readable "METHOD:path" base, so pattern invalidation by path
+ * keeps working, plus a hash of whatever else selects the response: the
+ * normalized query, the caller's credentials and the request headers the
+ * backend listed in Vary. The Vary of each base key is learned from its
+ * responses; a compressed response without Vary is treated as varying on
+ * Accept-Encoding. Which of these parts apply is set per route by its
+ * RouteCachePolicy.
+ */
+class CacheKeyBuilder {
+public:
+    /**
+     * @brief Constructor
+     * @param max_tracked Base keys whose Vary is remembered before the table resets
+     */
+    explicit CacheKeyBuilder(size_t max_tracked = 10000);
+
+    /**
+     * @brief Readable key prefix for a request
+     */
+    static std::string baseKey(const std::string& method, const std::string& path);
+
+    /**
+     * @brief Query parameters sorted by name, repeated names kept in request
+     *        order, with "%&=" escaped
+     */
+    static std::string normalizeQuery(const httplib::Params& params);
+
+    /**
+     * @brief Full cache key for a request
+     * @param base Result of baseKey()
+     * @param query Result of normalizeQuery()
+     * @param request_headers Request headers (names in any case)
+     * @param policy Route's key components; Vary headers are always included
+     */
+    std::string build(const std::string& base, const std::string& query,
+                      const std::map<std::string, std::string>& request_headers,
+                      const RouteCachePolicy& policy);
+
+    /**
+     * @brief Record which request headers a response varies on
+     * @return false if the response varies on everything (Vary: *)
+     */
+    bool learnVary(const std::string& base, const std::map<std::string, std::string>& response_headers);
+
+private:
+    size_t max_tracked_;
+    std::unordered_map<std::string, std::vector<std::string>> vary_;   // Lowercase, sorted names
+    std::shared_mutex mutex_;
+
+    static const std::string* findHeader(const std::map<std::string, std::string>& headers,
+                                         const std::string& lower_name);
+};
+
+} // namespace gateway
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace gateway {
+
+/**
+ * @brief Pin the calling thread to one CPU
+ *
+ * cpu indexes the CPUs the process may run on (wrapping around), so shard
+ * numbers can be passed directly inside a restricted cpuset. The process
+ * mask is read from the main thread, which is never pinned.
+ *
+ * @return false if cpu is negative or the kernel refused
+ */
+inline bool pinCurrentThreadToCpu(int cpu) {
+    if (cpu < 0) {
+        return false;
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(getpid(), sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        return false;
+    }
+
+    int target = cpu % CPU_COUNT(&allowed);
+    for (int i = 0; i < CPU_SETSIZE; i++) {
+        if (!CPU_ISSET(i, &allowed) || target-- > 0) {
+            continue;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(i, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+    return false;
+}
+
+} // namespace gateway
@@ -0,0 +1,760 @@
+#include "EventLoop.h"
+#include "HttpParser.h"
+#include "Response.h"
+#include "CpuAffinity.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace gateway {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// epoll user data: connections are numbered from FIRST_CONNECTION_ID
+constexpr uint64_t LISTEN_ID = 0;
+constexpr uint64_t WAKE_ID = 1;
+constexpr uint64_t FIRST_CONNECTION_ID = 2;
+
+constexpr int MAX_EVENTS = 256;
+constexpr size_t READ_CHUNK = 16384;
+
+const char CONNECTION_LIMIT_RESPONSE[] =
+    "HTTP/1.1 503 Service Unavailable\r\n"
+    "Retry-After: 1\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+
+const char CONTINUE_RESPONSE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+
+// Where streamBody() leaves a body, while a worker runs the handler
+thread_local std::unique_ptr<StreamedBody>* t_streamed = nullptr;
+
+void overloaded(httplib::Response& res) {
+    res.status = StatusCode::SERVICE_UNAVAILABLE;
+    res.set_header("Retry-After", "1");
+    res.set_header("Connection", "close");
+    res.set_content(ResponseBuilder::errorJson("Server overloaded"), "application/json");
+}
+
+int openListener(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo* result = nullptr;
+    std::string service = std::to_string(port);
+    int rc = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &result);
+    if (rc != 0) {
+        std::cerr << "Event loop: cannot resolve " << host << ": " << gai_strerror(rc) << std::endl;
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+        if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) {
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(result);
+
+    if (fd < 0) {
+        std::cerr << "Event loop: cannot listen on " << host << ":" << port
+                  << ": " << std::strerror(errno) << std::endl;
+    }
+    return fd;
+}
+
+bool addressOf(const sockaddr_storage& addr, std::string& host, int& port) {
+    char buf[INET6_ADDRSTRLEN] = {};
+    if (addr.ss_family == AF_INET) {
+        auto* in = reinterpret_cast<const sockaddr_in*>(&addr);
+        ::inet_ntop(AF_INET, &in->sin_addr, buf, sizeof(buf));
+        port = ntohs(in->sin_port);
+    } else if (addr.ss_family == AF_INET6) {
+        auto* in6 = reinterpret_cast<const sockaddr_in6*>(&addr);
+        ::inet_ntop(AF_INET6, &in6->sin6_addr, buf, sizeof(buf));
+        port = ntohs(in6->sin6_port);
+    } else {
+        return false;
+    }
+    host = buf;
+    return true;
+}
+
+int localPort(int fd) {
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        return 0;
+    }
+    std::string host;
+    int port = 0;
+    addressOf(addr, host, port);
+    return port;
+}
+
+} // namespace
+
+/**
+ * @brief One epoll set: a listener, an eventfd for finished responses and
+ *        the connections accepted from that listener
+ *
+ * Everything but complete()/wake() runs on the loop's own thread.
+ */
+class EventLoopServer::Loop {
+public:
+    Loop(EventLoopServer& server, int listen_fd, WorkerPool& workers, int cpu)
+        : server_(server), workers_(workers), listen_fd_(listen_fd), cpu_(cpu) {
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (valid()) {
+            watch(listen_fd_, LISTEN_ID, EPOLLIN);
+            watch(wake_fd_, WAKE_ID, EPOLLIN);
+        }
+    }
+
+    ~Loop() {
+        for (auto& entry : connections_) {
+            ::close(entry.second.fd);
+        }
+        server_.connections_.fetch_sub(connections_.size());
+        // Streamed bodies may still wake us until they are gone
+        connections_.clear();
+        for (int fd : {listen_fd_, epoll_fd_, wake_fd_}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    bool valid() const { return epoll_fd_ >= 0 && wake_fd_ >= 0; }
+
+    void run() {
+        pinCurrentThreadToCpu(cpu_);
+        epoll_event events[MAX_EVENTS];
+        auto last_sweep = Clock::now();
+
+        while (!server_.stopping_.load()) {
+            int n = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, 1000);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "Event loop: epoll_wait failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            for (int i = 0; i < n; i++) {
+                uint64_t id = events[i].data.u64;
+                if (id == LISTEN_ID) {
+                    acceptAll();
+                } else if (id == WAKE_ID) {
+                    drainCompletions();
+                } else {
+                    onEvent(id, events[i].events);
+                }
+            }
+
+            auto now = Clock::now();
+            if (now - last_sweep >= std::chrono::seconds(1)) {
+                sweep(now);
+                last_sweep = now;
+            }
+        }
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t n = ::write(wake_fd_, &one, sizeof(one));
+        (void)n;    // Counter already non-zero; the loop wakes anyway
+    }
+
+    /**
+     * @brief Hand a serialized response back to the loop (any thread)
+     */
+    void complete(uint64_t id, std::string bytes, bool close, std::unique_ptr<StreamedBody> body = nullptr) {
+        {
+            std::lock_guard<std::mutex> lock(done_mutex_);
+            done_.push_back({id, std::move(bytes), close, std::move(body)});
+        }
+        wake();
+    }
+
+    /**
+     * @brief A streamed body has more to read (any thread)
+     */
+    void readable(uint64_t id) {
+        {
+            std::lock_guard<std::mutex> lock(done_mutex_);
+            readable_.push_back(id);
+        }
+        wake();
+    }
+
+private:
+    struct Connection {
+        int fd = -1;
+        uint64_t id = 0;
+        std::string remote_addr;
+        int remote_port = 0;
+        HttpRequestParser parser;
+        std::string out;                // Response bytes being written
+        size_t out_pos = 0;
+        std::unique_ptr<StreamedBody> body; // Rest of the response, pulled as it arrives
+        uint32_t events = 0;            // Current epoll interest
+        bool busy = false;              // A worker or a streamed body owns the current request
+        bool close_after_write = false;
+        bool peer_closed = false;
+        size_t served = 0;
+        Clock::time_point last_active;
+        Clock::time_point request_start;
+
+        Connection(size_t max_header_bytes, size_t max_body_bytes)
+            : parser(max_header_bytes, max_body_bytes) {}
+    };
+
+    struct Completion {
+        uint64_t id;
+        std::string bytes;
+        bool close;
+        std::unique_ptr<StreamedBody> body;
+    };
+
+    EventLoopServer& server_;
+    WorkerPool& workers_;
+    int listen_fd_;
+    int cpu_;                           // -1 = unpinned
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::unordered_map<uint64_t, Connection> connections_;
+    uint64_t next_id_ = FIRST_CONNECTION_ID;
+
+    std::mutex done_mutex_;
+    std::vector<Completion> done_;
+    std::vector<uint64_t> readable_;
+
+    void watch(int fd, uint64_t id, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = id;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void setInterest(Connection& conn, uint32_t events) {
+        if (conn.events == events) {
+            return;
+        }
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = conn.id;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+        conn.events = events;
+    }
+
+    void reportConnections(size_t count) {
+        if (server_.metrics_) {
+            server_.metrics_->setActiveConnections(static_cast<int>(count));
+        }
+    }
+
+    void acceptAll() {
+        while (true) {
+            sockaddr_storage addr{};
+            socklen_t len = sizeof(addr);
+            int fd = ::accept4(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    std::cerr << "Event loop: accept failed: " << std::strerror(errno) << std::endl;
+                }
+                return;
+            }
+
+            if (server_.connections_.load() >= server_.config_.max_connections) {
+                // A fresh socket's send buffer always has room for this
+                ssize_t n = ::send(fd, CONNECTION_LIMIT_RESPONSE, sizeof(CONNECTION_LIMIT_RESPONSE) - 1,
+                                   MSG_NOSIGNAL | MSG_DONTWAIT);
+                (void)n;
+                ::close(fd);
+                if (server_.metrics_) {
+                    server_.metrics_->incrementConnectionsShed();
+                }
+                continue;
+            }
+
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            uint64_t id = next_id_++;
+            auto inserted = connections_.try_emplace(id, server_.config_.max_header_bytes,
+                                                     server_.config_.max_body_bytes);
+            Connection& conn = inserted.first->second;
+            conn.fd = fd;
+            conn.id = id;
+            addressOf(addr, conn.remote_addr, conn.remote_port);
+            conn.last_active = conn.request_start = Clock::now();
+            conn.events = EPOLLIN | EPOLLRDHUP;
+
+            epoll_event ev{};
+            ev.events = conn.events;
+            ev.data.u64 = id;
+            if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+                ::close(fd);
+                connections_.erase(id);
+                continue;
+            }
+            reportConnections(server_.connections_.fetch_add(1) + 1);
+        }
+    }
+
+    void closeConnection(Connection& conn) {
+        uint64_t id = conn.id;
+        ::close(conn.fd);
+        connections_.erase(id);
+        reportConnections(server_.connections_.fetch_sub(1) - 1);
+    }
+
+    void onEvent(uint64_t id, uint32_t events) {
+        auto it = connections_.find(id);
+        if (it == connections_.end()) {
+            return;
+        }
+        Connection& conn = it->second;
+
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            closeConnection(conn);
+            return;
+        }
+        if ((events & EPOLLOUT) && !flush(conn)) {
+            return;
+        }
+        if (conn.body && (events & EPOLLRDHUP)) {
+            // The client went away mid-stream; dropping the body cancels it upstream
+            closeConnection(conn);
+            return;
+        }
+        if ((events & (EPOLLIN | EPOLLRDHUP)) && !conn.busy && conn.out.empty()) {
+            readFrom(conn);
+        }
+    }
+
+    void readFrom(Connection& conn) {
+        char buf[READ_CHUNK];
+        auto status = HttpRequestParser::Status::NEED_MORE;
+
+        while (status == HttpRequestParser::Status::NEED_MORE) {
+            ssize_t n = ::recv(conn.fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                auto now = Clock::now();
+                if (conn.parser.idle()) {
+                    conn.request_start = now;
+                }
+                conn.last_active = now;
+                status = conn.parser.feed(buf, static_cast<size_t>(n));
+            } else if (n == 0) {
+                conn.peer_closed = true;
+                break;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else {
+                closeConnection(conn);
+                return;
+            }
+        }
+
+        if (!process(conn, status)) {
+            return;
+        }
+        // Half-closed with nothing in flight: no further request can arrive
+        if (conn.peer_closed && !conn.busy && conn.out.empty()) {
+            closeConnection(conn);
+        }
+    }
+
+    /**
+     * @brief Act on a parser result; false if the connection was closed
+     */
+    bool process(Connection& conn, HttpRequestParser::Status status) {
+        switch (status) {
+            case HttpRequestParser::Status::COMPLETE:
+                dispatch(conn);
+                return true;
+
+            case HttpRequestParser::Status::INVALID: {
+                httplib::Response res;
+                res.status = conn.parser.errorStatus();
+                res.set_content(ResponseBuilder::errorJson(httplib::status_message(res.status)),
+                                "application/json");
+                return send(conn, HttpResponseWriter::serialize("", res, false), true);
+            }
+
+            case HttpRequestParser::Status::NEED_MORE:
+                if (conn.parser.expectsContinue()) {
+                    return send(conn, CONTINUE_RESPONSE, false);
+                }
+                return true;
+        }
+        return true;
+    }
+
+    void dispatch(Connection& conn) {
+        httplib::Request req = conn.parser.take();
+        req.remote_addr = conn.remote_addr;
+        req.remote_port = conn.remote_port;
+
+        size_t max_requests = server_.config_.keep_alive_max_requests;
+        bool keep_alive = HttpRequestParser::keepAlive(req) && !conn.peer_closed &&
+                          (max_requests == 0 || conn.served + 1 < max_requests) &&
+                          !server_.stopping_.load();
+
+        // Stop reading until the response is out, so requests stay in order
+        conn.busy = true;
+        setInterest(conn, 0);
+
+        std::string method = req.method;
+        uint64_t id = conn.id;
+        bool queued = workers_.enqueue([this, id, keep_alive, req = std::move(req)]() {
+            httplib::Response res;
+            std::unique_ptr<StreamedBody> body;
+            if (WorkerPool::isShedding()) {
+                overloaded(res);
+            } else {
+                t_streamed = &body;
+                try {
+                    server_.handler_(req, res);
+                } catch (const std::exception& e) {
+                    std::cerr << "Event loop handler failed: " << e.what() << std::endl;
+                    res = httplib::Response();
+                    res.status = StatusCode::INTERNAL_SERVER_ERROR;
+                    res.set_content(ResponseBuilder::errorJson("Internal server error"), "application/json");
+                    body.reset();
+                }
+                t_streamed = nullptr;
+            }
+            // A handler may ask for the connection to be dropped (e.g. shedding)
+            bool keep = keep_alive && res.get_header_value("Connection") != "close";
+
+            int status = res.status > 0 ? res.status : 200;
+            if (body && status >= 200 && status != 204 && status != 304) {
+                std::string head = HttpResponseWriter::serializeHead(res, keep, body->content_length);
+                if (req.method == "HEAD") {
+                    body.reset();
+                }
+                complete(id, std::move(head), !keep, std::move(body));
+                return;
+            }
+            complete(id, HttpResponseWriter::serialize(req.method, res, keep), !keep);
+        });
+
+        if (!queued) {
+            httplib::Response res;
+            overloaded(res);
+            conn.busy = false;
+            conn.served++;
+            send(conn, HttpResponseWriter::serialize(method, res, false), true);
+        }
+    }
+
+    void drainCompletions() {
+        uint64_t counter;
+        while (::read(wake_fd_, &counter, sizeof(counter)) > 0) {
+        }
+
+        std::vector<Completion> done;
+        std::vector<uint64_t> ready;
+        {
+            std::lock_guard<std::mutex> lock(done_mutex_);
+            done.swap(done_);
+            ready.swap(readable_);
+        }
+
+        for (auto& completion : done) {
+            auto it = connections_.find(completion.id);
+            if (it == connections_.end()) {
+                continue;   // Closed while the worker ran
+            }
+            Connection& conn = it->second;
+            if (completion.body) {
+                // Stays busy until the body has been written
+                uint64_t id = conn.id;
+                conn.body = std::move(completion.body);
+                conn.body->subscribe([this, id]() { readable(id); });
+            } else {
+                conn.busy = false;
+                conn.served++;
+            }
+            send(conn, std::move(completion.bytes), completion.close);
+        }
+
+        for (uint64_t id : ready) {
+            auto it = connections_.find(id);
+            // A connection still writing resumes the body on EPOLLOUT
+            if (it != connections_.end() && it->second.body && it->second.out.empty()) {
+                pumpBody(it->second);
+            }
+        }
+    }
+
+    bool send(Connection& conn, std::string bytes, bool close_after) {
+        conn.out = std::move(bytes);
+        conn.out_pos = 0;
+        conn.close_after_write = close_after;
+        conn.last_active = Clock::now();
+        return flush(conn);
+    }
+
+    /**
+     * @brief Write what the socket takes of the pending output; false if
+     *        the connection was closed
+     */
+    bool writeOut(Connection& conn) {
+        while (conn.out_pos < conn.out.size()) {
+            ssize_t n = ::send(conn.fd, conn.out.data() + conn.out_pos, conn.out.size() - conn.out_pos,
+                               MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.out_pos += static_cast<size_t>(n);
+                conn.last_active = Clock::now();
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                setInterest(conn, EPOLLOUT);
+                return true;
+            } else {
+                closeConnection(conn);
+                return false;
+            }
+        }
+
+        conn.out.clear();
+        conn.out_pos = 0;
+        return true;
+    }
+
+    /**
+     * @brief Write pending output and move on to what follows it; false if
+     *        the connection was closed
+     */
+    bool flush(Connection& conn) {
+        if (!writeOut(conn)) {
+            return false;
+        }
+        if (!conn.out.empty()) {
+            return true;    // The rest goes on EPOLLOUT
+        }
+        if (conn.body) {
+            return pumpBody(conn);
+        }
+        if (conn.close_after_write) {
+            closeConnection(conn);
+            return false;
+        }
+        if (conn.busy) {
+            return true;
+        }
+        setInterest(conn, EPOLLIN | EPOLLRDHUP);
+        // The next pipelined request may already be buffered
+        return process(conn, conn.parser.parse());
+    }
+
+    /**
+     * @brief Write a streamed body for as long as it has data and the socket
+     *        keeps up; false if the connection was closed
+     *
+     * Each read is written before the next, so a slow client leaves data in
+     * the body's own bounded buffer and the producer waits.
+     */
+    bool pumpBody(Connection& conn) {
+        bool chunked = conn.body->content_length < 0;
+        while (conn.out.empty()) {
+            std::string data;
+            bool more = conn.body->read(data);
+            std::string bytes;
+            if (!data.empty()) {
+                bytes = chunked ? HttpResponseWriter::chunk(data) : std::move(data);
+            }
+
+            if (!more) {
+                bool failed = conn.body->failed && conn.body->failed();
+                conn.body.reset();
+                conn.busy = false;
+                conn.served++;
+                if (failed) {
+                    // Only a cut connection tells the client the body is incomplete
+                    closeConnection(conn);
+                    return false;
+                }
+                if (chunked) {
+                    bytes += HttpResponseWriter::chunk("");
+                }
+                return send(conn, std::move(bytes), conn.close_after_write);
+            }
+
+            if (bytes.empty()) {
+                // Nothing yet; subscribe() brings us back. Meanwhile notice a client hanging up.
+                setInterest(conn, EPOLLRDHUP);
+                return true;
+            }
+            conn.out = std::move(bytes);
+            conn.out_pos = 0;
+            conn.last_active = Clock::now();
+            if (!writeOut(conn)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void sweep(Clock::time_point now) {
+        auto keep_alive = std::chrono::seconds(server_.config_.keep_alive_timeout);
+        auto read_timeout = std::chrono::seconds(server_.config_.read_timeout);
+
+        std::vector<uint64_t> expired;
+        for (auto& entry : connections_) {
+            const Connection& conn = entry.second;
+            if (conn.busy && !conn.body) {
+                continue;   // The handler has its own timeouts
+            }
+            bool expired_conn;
+            if (!conn.out.empty()) {
+                expired_conn = now - conn.last_active > read_timeout;   // Peer not reading
+            } else if (conn.body) {
+                expired_conn = false;   // Waiting on the producer, which has its own idle timeout
+            } else if (conn.parser.idle()) {
+                expired_conn = now - conn.last_active > keep_alive;
+            } else {
+                expired_conn = now - conn.request_start > read_timeout; // Slow request
+            }
+            if (expired_conn) {
+                expired.push_back(entry.first);
+            }
+        }
+
+        for (uint64_t id : expired) {
+            auto it = connections_.find(id);
+            if (it != connections_.end()) {
+                closeConnection(it->second);
+            }
+        }
+    }
+};
+
+EventLoopServer::EventLoopServer(EventLoopConfig config, Handler handler, WorkerPoolConfig workers,
+                                 std::shared_ptr<SimpleMetrics> metrics)
+    : config_(config), handler_(std::move(handler)), workers_config_(workers), metrics_(std::move(metrics)) {
+}
+
+EventLoopServer::~EventLoopServer() {
+    stop();
+    // Finish running handlers while their loops can still take the result
+    for (auto& pool : workers_) {
+        pool->shutdown();
+    }
+}
+
+bool EventLoopServer::bindToPort(const std::string& host, int port) {
+    if (!loops_.empty()) {
+        return false;
+    }
+
+    size_t count = config_.loops;
+    if (count == 0) {
+        count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Every listener shares the port through SO_REUSEPORT
+    int bound_port = port;
+    for (size_t i = 0; i < count; i++) {
+        int fd = openListener(host, bound_port);
+        if (fd < 0) {
+            loops_.clear();
+            workers_.clear();
+            return false;
+        }
+        if (bound_port == 0) {
+            bound_port = localPort(fd);
+        }
+
+        // Each loop feeds its own worker group, on the same CPU when pinned
+        int cpu = config_.pin_cpus ? static_cast<int>(i) : -1;
+        workers_.push_back(std::make_unique<WorkerPool>(workers_config_.shard(count, cpu), metrics_));
+        auto loop = std::make_unique<Loop>(*this, fd, *workers_.back(), cpu);
+        if (!loop->valid()) {
+            std::cerr << "Event loop: cannot create epoll set: " << std::strerror(errno) << std::endl;
+            loops_.clear();
+            workers_.clear();
+            return false;
+        }
+        loops_.push_back(std::move(loop));
+    }
+
+    port_ = bound_port;
+    return true;
+}
+
+bool EventLoopServer::listenAfterBind() {
+    if (loops_.empty()) {
+        return false;
+    }
+
+    std::vector<std::thread> threads;
+    for (auto& loop : loops_) {
+        threads.emplace_back([loop = loop.get()]() {
+            loop->run();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return true;
+}
+
+bool EventLoopServer::listen(const std::string& host, int port) {
+    return bindToPort(host, port) && listenAfterBind();
+}
+
+bool EventLoopServer::streamBody(StreamedBody body) {
+    if (!t_streamed || !body.read || !body.subscribe) {
+        return false;
+    }
+    *t_streamed = std::make_unique<StreamedBody>(std::move(body));
+    return true;
+}
+
+void EventLoopServer::stop() {
+    stopping_ = true;
+    for (auto& loop : loops_) {
+        loop->wake();
+    }
+}
+
+} // namespace gateway
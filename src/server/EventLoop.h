@@ -0,0 +1,132 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+#include <httplib.h>
+#include "WorkerPool.h"
+#include "../metrics/SimpleMetrics.h"
+
+namespace gateway {
+
+/**
+ * @brief Tuning for EventLoopServer
+ */
+struct EventLoopConfig {
+    size_t loops = 0;                       // 0 = one per hardware thread
+    size_t max_connections = 10000;         // Across all loops; more are answered 503
+    size_t max_header_bytes = 8192;
+    size_t max_body_bytes = 10485760;
+    int read_timeout = 30;                  // Seconds to receive one whole request
+    int keep_alive_timeout = 5;             // Idle seconds allowed between requests
+    size_t keep_alive_max_requests = 100;   // Requests per connection
+    bool pin_cpus = false;                  // Pin loop i and its workers to CPU i
+};
+
+/**
+ * @brief Response body produced after the handler has returned
+ *
+ * The loop writes the head as soon as the handler finishes and then pulls
+ * the body on its own thread, so a slow or idle stream holds no worker.
+ */
+struct StreamedBody {
+    /**
+     * Runs on the loop thread and must not block: moves the bytes available
+     * now into out. Returns false once the body has ended.
+     */
+    std::function<bool(std::string& out)> read;
+
+    /** Registers a wake-up, called from any thread when read() has more */
+    std::function<void(std::function<void()> notify)> subscribe;
+
+    /** True if the body ended early; the connection is then dropped */
+    std::function<bool()> failed;
+
+    long long content_length = -1;          // -1 = chunked
+};
+
+/**
+ * @brief Non-blocking HTTP/1.1 server built on epoll
+ *
+ * Each loop thread owns an SO_REUSEPORT listener, so the kernel spreads
+ * new connections across loops, and an epoll set of the connections it
+ * accepted. Loops only read, parse and write; a complete request is
+ * handed to the loop's own share of the worker pool and the serialized
+ * response is passed back through an eventfd. An idle keep-alive connection therefore
+ * costs a socket and a small buffer instead of a blocked thread, and so
+ * does a response streamed through streamBody() while it waits for data.
+ *
+ * Linux only; plain HTTP only (TLS stays on the threaded server).
+ */
+class EventLoopServer {
+public:
+    using Handler = std::function<void(const httplib::Request& req, httplib::Response& res)>;
+
+    /**
+     * @param handler Runs on a worker thread for each request
+     * @param workers Pool sizing, split evenly across the loops; a loop whose
+     *        share is full answers 503
+     * @param metrics Receives active connection counts (optional)
+     */
+    EventLoopServer(EventLoopConfig config, Handler handler, WorkerPoolConfig workers = {},
+                    std::shared_ptr<SimpleMetrics> metrics = nullptr);
+    ~EventLoopServer();
+
+    EventLoopServer(const EventLoopServer&) = delete;
+    EventLoopServer& operator=(const EventLoopServer&) = delete;
+
+    /**
+     * @brief Open one listener per loop on host:port (port 0 picks a free port)
+     */
+    bool bindToPort(const std::string& host, int port);
+
+    /**
+     * @brief Run the loops until stop(), each on its own thread
+     */
+    bool listenAfterBind();
+
+    /**
+     * @brief bindToPort() then listenAfterBind()
+     */
+    bool listen(const std::string& host, int port);
+
+    /**
+     * @brief Make listenAfterBind() return; safe from any thread
+     */
+    void stop();
+
+    /**
+     * @brief Bound port, or 0 before bindToPort()
+     */
+    int port() const { return port_; }
+
+    size_t connections() const { return connections_.load(); }
+
+    /**
+     * @brief From inside a handler: send res's status and headers now and
+     *        body as it becomes available
+     * @return false when not called from an EventLoopServer handler
+     */
+    static bool streamBody(StreamedBody body);
+
+private:
+    class Loop;
+
+    EventLoopConfig config_;
+    Handler handler_;
+    WorkerPoolConfig workers_config_;
+    std::shared_ptr<SimpleMetrics> metrics_;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> connections_{0};
+
+    std::vector<std::unique_ptr<Loop>> loops_;
+    // One per loop; declared after loops_ so they drain before the loops
+    // they report to go away
+    std::vector<std::unique_ptr<WorkerPool>> workers_;
+};
+
+} // namespace gateway
@@ -0,0 +1,418 @@
+#include "HttpParser.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <strings.h>
+
+namespace gateway {
+
+namespace {
+
+const std::string* findHeader(const httplib::Headers& headers, const char* name) {
+    for (const auto& [key, value] : headers) {
+        if (strcasecmp(key.c_str(), name) == 0) {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+std::string toLower(std::string_view value) {
+    std::string out(value);
+    std::transform(out.begin(), out.end(), out.begin(), ::tolower);
+    return out;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Percent-decoding; '+' means space only in the query string
+std::string decode(std::string_view in, bool plus_as_space) {
+    std::string out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); i++) {
+        if (in[i] == '%' && i + 2 < in.size()) {
+            int hi = hexValue(in[i + 1]);
+            int lo = hexValue(in[i + 2]);
+            if (hi >= 0 && lo >= 0) {
+                out += static_cast<char>(hi * 16 + lo);
+                i += 2;
+                continue;
+            }
+        }
+        out += (plus_as_space && in[i] == '+') ? ' ' : in[i];
+    }
+    return out;
+}
+
+// RFC 9110 token (methods and header names)
+bool isToken(std::string_view value) {
+    static const std::string_view SPECIALS = "!#$%&'*+-.^_`|~";
+    return !value.empty() && std::all_of(value.begin(), value.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || SPECIALS.find(c) != std::string_view::npos;
+    });
+}
+
+std::string statusAndHeaders(const httplib::Response& res, const std::string& framing, bool keep_alive) {
+    int status = res.status > 0 ? res.status : 200;
+
+    std::string out;
+    out.reserve(256 + res.body.size());
+    out += "HTTP/1.1 ";
+    out += std::to_string(status);
+    out += ' ';
+    out += httplib::status_message(status);
+    out += "\r\n";
+    for (const auto& [name, value] : res.headers) {
+        // Framing is ours to decide
+        if (strcasecmp(name.c_str(), "Content-Length") == 0 ||
+            strcasecmp(name.c_str(), "Transfer-Encoding") == 0 ||
+            strcasecmp(name.c_str(), "Connection") == 0 ||
+            strcasecmp(name.c_str(), "Keep-Alive") == 0) {
+            continue;
+        }
+        out += name;
+        out += ": ";
+        out += value;
+        out += "\r\n";
+    }
+    out += framing;
+    out += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    return out;
+}
+
+} // namespace
+
+HttpRequestParser::HttpRequestParser(size_t max_header_bytes, size_t max_body_bytes)
+    : max_header_bytes_(max_header_bytes), max_body_bytes_(max_body_bytes) {
+}
+
+HttpRequestParser::Status HttpRequestParser::feed(const char* data, size_t size) {
+    if (state_ == State::FAILED) {
+        return Status::INVALID;
+    }
+    buffer_.append(data, size);
+    return parse();
+}
+
+HttpRequestParser::Status HttpRequestParser::parse() {
+    while (true) {
+        switch (state_) {
+            case State::HEAD: {
+                size_t end = buffer_.find("\r\n\r\n", scan_from_);
+                if (end == std::string::npos) {
+                    if (buffer_.size() > max_header_bytes_) {
+                        return fail(431);
+                    }
+                    scan_from_ = buffer_.size() >= 3 ? buffer_.size() - 3 : 0;
+                    return Status::NEED_MORE;
+                }
+                if (end + 4 > max_header_bytes_) {
+                    return fail(431);
+                }
+                if (!parseHead(std::string_view(buffer_).substr(0, end))) {
+                    return Status::INVALID;
+                }
+                buffer_.erase(0, end + 4);
+                scan_from_ = 0;
+                Status status = startBody();
+                if (status == Status::INVALID) {
+                    return status;
+                }
+                break;
+            }
+
+            case State::BODY: {
+                size_t n = std::min(remaining_, buffer_.size());
+                request_.body.append(buffer_, 0, n);
+                buffer_.erase(0, n);
+                remaining_ -= n;
+                if (remaining_ > 0) {
+                    return Status::NEED_MORE;
+                }
+                state_ = State::DONE;
+                break;
+            }
+
+            case State::CHUNK_SIZE: {
+                size_t eol = buffer_.find("\r\n");
+                if (eol == std::string::npos) {
+                    return buffer_.size() > 1024 ? fail(400) : Status::NEED_MORE;
+                }
+                // Chunk extensions are ignored
+                std::string_view line = std::string_view(buffer_).substr(0, eol);
+                line = trim(line.substr(0, line.find(';')));
+                if (line.empty() || line.size() > 15) {
+                    return fail(400);
+                }
+                size_t size = 0;
+                for (char c : line) {
+                    int digit = hexValue(c);
+                    if (digit < 0) {
+                        return fail(400);
+                    }
+                    size = size * 16 + static_cast<size_t>(digit);
+                }
+                buffer_.erase(0, eol + 2);
+                if (size == 0) {
+                    state_ = State::CHUNK_TRAILER;
+                } else if (size > max_body_bytes_ - request_.body.size()) {
+                    return fail(413);
+                } else {
+                    remaining_ = size;
+                    state_ = State::CHUNK_DATA;
+                }
+                break;
+            }
+
+            case State::CHUNK_DATA: {
+                if (remaining_ > 0) {
+                    size_t n = std::min(remaining_, buffer_.size());
+                    request_.body.append(buffer_, 0, n);
+                    buffer_.erase(0, n);
+                    remaining_ -= n;
+                    if (remaining_ > 0) {
+                        return Status::NEED_MORE;
+                    }
+                }
+                if (buffer_.size() < 2) {
+                    return Status::NEED_MORE;
+                }
+                if (buffer_.compare(0, 2, "\r\n") != 0) {
+                    return fail(400);
+                }
+                buffer_.erase(0, 2);
+                state_ = State::CHUNK_SIZE;
+                break;
+            }
+
+            case State::CHUNK_TRAILER: {
+                // Trailer fields are read and dropped
+                size_t eol = buffer_.find("\r\n");
+                if (eol == std::string::npos) {
+                    return trailer_bytes_ + buffer_.size() > max_header_bytes_ ? fail(431) : Status::NEED_MORE;
+                }
+                trailer_bytes_ += eol + 2;
+                if (trailer_bytes_ > max_header_bytes_) {
+                    return fail(431);
+                }
+                buffer_.erase(0, eol + 2);
+                if (eol == 0) {
+                    state_ = State::DONE;
+                }
+                break;
+            }
+
+            case State::DONE:
+                return Status::COMPLETE;
+
+            case State::FAILED:
+                return Status::INVALID;
+        }
+    }
+}
+
+httplib::Request HttpRequestParser::take() {
+    httplib::Request request = std::move(request_);
+    request_ = httplib::Request();
+    state_ = State::HEAD;
+    scan_from_ = 0;
+    remaining_ = 0;
+    trailer_bytes_ = 0;
+    continue_pending_ = false;
+    return request;
+}
+
+bool HttpRequestParser::expectsContinue() {
+    bool pending = continue_pending_;
+    continue_pending_ = false;
+    return pending;
+}
+
+bool HttpRequestParser::keepAlive(const httplib::Request& req) {
+    const std::string* connection = findHeader(req.headers, "Connection");
+    std::string value = connection ? toLower(*connection) : "";
+    if (req.version == "HTTP/1.0") {
+        return value.find("keep-alive") != std::string::npos;
+    }
+    return value.find("close") == std::string::npos;
+}
+
+HttpRequestParser::Status HttpRequestParser::fail(int status) {
+    error_status_ = status;
+    state_ = State::FAILED;
+    buffer_.clear();
+    return Status::INVALID;
+}
+
+bool HttpRequestParser::parseHead(std::string_view head) {
+    // Stray empty lines before a request line are allowed (RFC 9112 2.2)
+    while (head.substr(0, 2) == "\r\n") {
+        head.remove_prefix(2);
+    }
+
+    size_t eol = head.find("\r\n");
+    std::string_view line = head.substr(0, eol);
+    std::string_view rest = eol == std::string_view::npos ? std::string_view() : head.substr(eol + 2);
+
+    size_t sp1 = line.find(' ');
+    size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos || line.find(' ', sp2 + 1) != std::string_view::npos) {
+        fail(400);
+        return false;
+    }
+    std::string_view method = line.substr(0, sp1);
+    std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string_view version = line.substr(sp2 + 1);
+
+    if (!isToken(method)) {
+        fail(400);
+        return false;
+    }
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        fail(version.substr(0, 5) == "HTTP/" ? 505 : 400);
+        return false;
+    }
+    bool bad_target = target.empty() || (target[0] != '/' && target != "*") ||
+                      std::any_of(target.begin(), target.end(), [](char c) {
+                          return static_cast<unsigned char>(c) <= 0x20 || c == 0x7f;
+                      });
+    if (bad_target) {
+        fail(400);
+        return false;
+    }
+
+    request_.method = std::string(method);
+    request_.target = std::string(target);
+    request_.version = std::string(version);
+
+    size_t query_start = target.find('?');
+    request_.path = decode(target.substr(0, query_start), false);
+    if (query_start != std::string_view::npos) {
+        std::string_view query = target.substr(query_start + 1);
+        while (!query.empty()) {
+            size_t amp = query.find('&');
+            std::string_view pair = query.substr(0, amp);
+            query = amp == std::string_view::npos ? std::string_view() : query.substr(amp + 1);
+            if (pair.empty()) {
+                continue;
+            }
+            size_t eq = pair.find('=');
+            request_.params.emplace(decode(pair.substr(0, eq), true),
+                                    eq == std::string_view::npos ? "" : decode(pair.substr(eq + 1), true));
+        }
+    }
+
+    while (!rest.empty()) {
+        eol = rest.find("\r\n");
+        line = rest.substr(0, eol);
+        rest = eol == std::string_view::npos ? std::string_view() : rest.substr(eol + 2);
+
+        // Obsolete line folding is rejected, as RFC 9112 allows
+        size_t colon = line.find(':');
+        if (line.empty() || line[0] == ' ' || line[0] == '\t' || colon == std::string_view::npos) {
+            fail(400);
+            return false;
+        }
+        std::string_view name = line.substr(0, colon);
+        std::string_view value = trim(line.substr(colon + 1));
+        if (!isToken(name) || value.find_first_of(std::string_view("\r\n\0", 3)) != std::string_view::npos) {
+            fail(400);
+            return false;
+        }
+        request_.headers.emplace(std::string(name), std::string(value));
+    }
+    return true;
+}
+
+HttpRequestParser::Status HttpRequestParser::startBody() {
+    const std::string* transfer_encoding = findHeader(request_.headers, "Transfer-Encoding");
+    const std::string* content_length = findHeader(request_.headers, "Content-Length");
+
+    if (transfer_encoding) {
+        // Both framings at once is how requests get smuggled
+        if (content_length) {
+            return fail(400);
+        }
+        if (toLower(trim(*transfer_encoding)) != "chunked") {
+            return fail(501);
+        }
+        state_ = State::CHUNK_SIZE;
+    } else if (content_length) {
+        std::string_view length_text = trim(*content_length);
+        for (const auto& [name, value] : request_.headers) {
+            if (strcasecmp(name.c_str(), "Content-Length") == 0 && trim(value) != length_text) {
+                return fail(400);
+            }
+        }
+        if (length_text.empty() || length_text.size() > 18 ||
+            !std::all_of(length_text.begin(), length_text.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return fail(400);
+        }
+        size_t length = std::stoull(std::string(length_text));
+        if (length > max_body_bytes_) {
+            return fail(413);
+        }
+        remaining_ = length;
+        state_ = length > 0 ? State::BODY : State::DONE;
+    } else {
+        state_ = State::DONE;
+    }
+
+    if (state_ != State::DONE) {
+        const std::string* expect = findHeader(request_.headers, "Expect");
+        continue_pending_ = expect && toLower(trim(*expect)) == "100-continue";
+    }
+    return Status::NEED_MORE;
+}
+
+std::string HttpResponseWriter::serialize(const std::string& method, const httplib::Response& res,
+                                          bool keep_alive) {
+    int status = res.status > 0 ? res.status : 200;
+    bool has_body = status >= 200 && status != 204 && status != 304;
+
+    std::string framing;
+    if (has_body) {
+        framing = "Content-Length: " + std::to_string(res.body.size()) + "\r\n";
+    }
+    std::string out = statusAndHeaders(res, framing, keep_alive);
+    if (has_body && method != "HEAD") {
+        out += res.body;
+    }
+    return out;
+}
+
+std::string HttpResponseWriter::serializeHead(const httplib::Response& res, bool keep_alive,
+                                              long long content_length) {
+    std::string framing = content_length >= 0
+        ? "Content-Length: " + std::to_string(content_length) + "\r\n"
+        : "Transfer-Encoding: chunked\r\n";
+    return statusAndHeaders(res, framing, keep_alive);
+}
+
+std::string HttpResponseWriter::chunk(const std::string& data) {
+    char size[32];
+    std::snprintf(size, sizeof(size), "%zx\r\n", data.size());
+    std::string out;
+    out.reserve(data.size() + 24);
+    out += size;
+    out += data;
+    out += "\r\n";
+    return out;
+}
+
+} // namespace gateway
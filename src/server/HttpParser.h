@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <httplib.h>
+
+namespace gateway {
+
+/**
+ * @brief Incremental HTTP/1.1 request parser for the event loop
+ *
+ * Bytes are fed as they arrive; a request is complete once its head and
+ * body (Content-Length or chunked) are in. Bytes past the end of a
+ * request stay buffered for the next one, so pipelined requests work.
+ * Ambiguous framing (both Content-Length and Transfer-Encoding, differing
+ * Content-Lengths, bare LF in a header) is rejected rather than guessed.
+ */
+class HttpRequestParser {
+public:
+    enum class Status {
+        NEED_MORE,      // Request not complete yet
+        COMPLETE,       // take() returns the request
+        INVALID         // errorStatus() says which response to send; the connection must close
+    };
+
+    HttpRequestParser(size_t max_header_bytes = 8192, size_t max_body_bytes = 10485760);
+
+    /**
+     * @brief Buffer more input and parse as far as it goes
+     */
+    Status feed(const char* data, size_t size);
+
+    /**
+     * @brief Parse already buffered input (e.g. the next pipelined request)
+     */
+    Status parse();
+
+    /**
+     * @brief Move out the completed request and start on the next one
+     */
+    httplib::Request take();
+
+    /**
+     * @brief Response status for an INVALID request (400, 413, 431, 501, 505)
+     */
+    int errorStatus() const { return error_status_; }
+
+    /**
+     * @brief True once per request whose head asked for "100 Continue"
+     *        before sending its body
+     */
+    bool expectsContinue();
+
+    /**
+     * @brief No part of a request has been received
+     */
+    bool idle() const { return state_ == State::HEAD && buffer_.empty(); }
+
+    /**
+     * @brief Whether the client wants the connection kept open after req
+     */
+    static bool keepAlive(const httplib::Request& req);
+
+private:
+    enum class State { HEAD, BODY, CHUNK_SIZE, CHUNK_DATA, CHUNK_TRAILER, DONE, FAILED };
+
+    size_t max_header_bytes_;
+    size_t max_body_bytes_;
+    std::string buffer_;            // Received, not yet parsed
+    size_t scan_from_ = 0;          // Resume point for the end-of-head search
+    State state_ = State::HEAD;
+    httplib::Request request_;
+    size_t remaining_ = 0;          // Body or chunk bytes still to come
+    size_t trailer_bytes_ = 0;
+    int error_status_ = 0;
+    bool continue_pending_ = false;
+
+    Status fail(int status);
+    bool parseHead(std::string_view head);
+    Status startBody();
+};
+
+/**
+ * @brief Serializes responses for the event loop
+ */
+class HttpResponseWriter {
+public:
+    /**
+     * @brief Status line, headers and body, framed with Content-Length
+     * @param method Request method (HEAD responses carry no body)
+     * @param keep_alive Sent as the Connection header
+     */
+    static std::string serialize(const std::string& method, const httplib::Response& res, bool keep_alive);
+
+    /**
+     * @brief Status line and headers for a body written separately
+     * @param content_length Body size, or -1 to send it chunked
+     */
+    static std::string serializeHead(const httplib::Response& res, bool keep_alive, long long content_length);
+
+    /**
+     * @brief One chunk of a chunked body (an empty chunk ends the body)
+     */
+    static std::string chunk(const std::string& data);
+};
+
+} // namespace gateway
@@ -1,10 +1,16 @@
 #include "HttpServer.h"
 #include "Response.h"
 #include "../router/ProxyManager.h"
+#include "../cache/Compression.h"
+#include "CpuAffinity.h"
 #include <uuid/uuid.h>
 #include <iostream>
 #include <chrono>
 #include <openssl/ssl.h>
+#include <strings.h>
+#include <sstream>
+#include <thread>
+#include <sys/socket.h>
 
 namespace gateway {
 
@@ -49,10 +55,117 @@ bool HttpServer::start() {
         {"tls_enabled", tls_enabled_}
     });
 
+    if (event_loop_config_) {
+        if (!tls_enabled_) {
+            proxy_manager_->setMaxStreams(max_streams_);
+            EventLoopConfig loop_config = *event_loop_config_;
+            if (keep_alive_max_requests_ > 0) {
+                loop_config.keep_alive_max_requests = keep_alive_max_requests_;
+            }
+            if (keep_alive_timeout_ > 0) {
+                loop_config.keep_alive_timeout = keep_alive_timeout_;
+            }
+            event_loop_ = std::make_unique<EventLoopServer>(
+                loop_config,
+                [this](const httplib::Request& req, httplib::Response& res) {
+                    dispatchRequest(req, res);
+                },
+                worker_pool_config_.value_or(WorkerPoolConfig{}), metrics_);
+            return event_loop_->listen(host_, port_);
+        }
+        std::cerr << "Warning: event loop mode serves plain HTTP only; using the threaded server for TLS\n";
+    }
+
+    // Threaded connections hold their worker for as long as a stream stays
+    // open; keep at least half the workers for everything else
+    size_t workers = worker_pool_config_.value_or(WorkerPoolConfig{}).workerThreads();
+    proxy_manager_->setMaxStreams(std::min(max_streams_, std::max<size_t>(1, workers / 2)));
+
+    if (acceptors_ > 1 || pin_cpus_) {
+        return listenSharded();
+    }
+
+    // Applied here because enableTLS() replaces server_
+    configureServer(*server_, worker_pool_config_);
     return server_->listen(host_.c_str(), port_);
 }
 
+bool HttpServer::listenSharded() {
+    // Shard 0 is server_; the others get the same routes and TLS setup
+    std::vector<httplib::Server*> servers{server_.get()};
+    for (size_t i = 1; i < acceptors_; i++) {
+        auto shard = createServer();
+        for (const auto& route : local_routes_) {
+            size_t space = route.first.find(' ');
+            registerRoute(*shard, route.first.substr(0, space), route.first.substr(space + 1), route.second);
+        }
+        registerCatchAll(*shard);
+        servers.push_back(shard.get());
+        shards_.push_back(std::move(shard));
+    }
+
+    // All shards bind the same port; the kernel balances accepts across them
+    WorkerPoolConfig pool_config = worker_pool_config_.value_or(WorkerPoolConfig{});
+    for (size_t i = 0; i < servers.size(); i++) {
+        int cpu = pin_cpus_ ? static_cast<int>(i) : -1;
+        configureServer(*servers[i], pool_config.shard(servers.size(), cpu));
+        servers[i]->set_socket_options([](httplib::socket_t sock) {
+            int yes = 1;
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+        });
+        if (!servers[i]->bind_to_port(host_, port_)) {
+            std::cerr << "Failed to bind acceptor " << i << " to " << host_ << ":" << port_ << "\n";
+            // httplib's stop() only closes a socket that is listening, so run
+            // each bound shard until ready and stop it to release its port
+            for (size_t j = 0; j < i; j++) {
+                std::thread listener([server = servers[j]]() { server->listen_after_bind(); });
+                servers[j]->wait_until_ready();
+                servers[j]->stop();
+                listener.join();
+            }
+            shards_.clear();
+            return false;
+        }
+    }
+
+    std::vector<std::thread> acceptors;
+    for (size_t i = 0; i < servers.size(); i++) {
+        int cpu = pin_cpus_ ? static_cast<int>(i) : -1;
+        acceptors.emplace_back([server = servers[i], cpu]() {
+            pinCurrentThreadToCpu(cpu);
+            server->listen_after_bind();
+        });
+    }
+    for (auto& acceptor : acceptors) {
+        acceptor.join();
+    }
+    return true;
+}
+
+void HttpServer::configureServer(httplib::Server& server, const std::optional<WorkerPoolConfig>& pool) {
+    if (pool) {
+        WorkerPoolConfig pool_config = *pool;
+        auto metrics = metrics_;
+        server.new_task_queue = [pool_config, metrics]() -> httplib::TaskQueue* {
+            return new WorkerPool(pool_config, metrics);
+        };
+    }
+    if (keep_alive_max_requests_ > 0) {
+        server.set_keep_alive_max_count(keep_alive_max_requests_);
+    }
+    if (keep_alive_timeout_ > 0) {
+        server.set_keep_alive_timeout(keep_alive_timeout_);
+    }
+}
+
 void HttpServer::stop() {
+    if (event_loop_) {
+        event_loop_->stop();
+    }
+    for (auto& shard : shards_) {
+        shard->stop();
+    }
     if (server_) {
         server_->stop();
         logger_->info("API Gateway stopped");
@@ -64,38 +177,47 @@ void HttpServer::enableTLS(const std::string& cert_file, const std::string& key_
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
     // Replace the plain Server with an SSLServer.
     // Must be called BEFORE initialize() / registerEndpoints().
-    server_ = std::make_unique<httplib::SSLServer>(cert_file.c_str(), key_file.c_str());
     tls_enabled_ = true;
     cert_file_ = cert_file;
     key_file_ = key_file;
+    tls_cipher_list_ = cipher_list;
+    tls_min_version_ = min_tls_version;
+    server_ = createServer();
+#else
+    (void)cert_file;
+    (void)key_file;
+    (void)cipher_list;
+    (void)min_tls_version;
+    std::cerr << "TLS requested but CPPHTTPLIB_OPENSSL_SUPPORT is not compiled in\n";
+#endif
+}
+
+std::unique_ptr<httplib::Server> HttpServer::createServer() const {
+#ifdef CPPHTTPLIB_OPENSSL_SUPPORT
+    if (tls_enabled_) {
+        auto server = std::make_unique<httplib::SSLServer>(cert_file_.c_str(), key_file_.c_str());
 
-    // Configure TLS settings on the SSL context
-    auto* ssl_server = dynamic_cast<httplib::SSLServer*>(server_.get());
-    if (ssl_server) {
-        SSL_CTX* ctx = ssl_server->ssl_context();
+        // Configure TLS settings on the SSL context
+        SSL_CTX* ctx = server->ssl_context();
         if (ctx) {
             // Set minimum TLS version
-            if (min_tls_version == "1.3") {
+            if (tls_min_version_ == "1.3") {
                 SSL_CTX_set_min_proto_version(ctx, TLS1_3_VERSION);
             } else {
                 SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
             }
 
             // Set cipher suites if provided
-            if (!cipher_list.empty()) {
-                if (!SSL_CTX_set_cipher_list(ctx, cipher_list.c_str())) {
-                    std::cerr << "Warning: Failed to set cipher list: " << cipher_list << "\n";
+            if (!tls_cipher_list_.empty()) {
+                if (!SSL_CTX_set_cipher_list(ctx, tls_cipher_list_.c_str())) {
+                    std::cerr << "Warning: Failed to set cipher list: " << tls_cipher_list_ << "\n";
                 }
             }
         }
+        return server;
     }
-#else
-    (void)cert_file;
-    (void)key_file;
-    (void)cipher_list;
-    (void)min_tls_version;
-    std::cerr << "TLS requested but CPPHTTPLIB_OPENSSL_SUPPORT is not compiled in\n";
 #endif
+    return std::make_unique<httplib::Server>();
 }
 
 void HttpServer::setSecurityHeaders(const std::map<std::string, std::string>& headers) {
@@ -142,93 +264,159 @@ void HttpServer::addSecurityHeaders(httplib::Response& res) {
 
 void HttpServer::setupHandlers() {
     // Health check endpoint
-    server_->Get("/health", [this](const httplib::Request& req, httplib::Response& res) {
+    addLocalRoute("GET", "/health", [this](const httplib::Request& req, httplib::Response& res) {
         handleHealthCheck(req, res);
     });
 
     // Metrics endpoint (Prometheus format)
-    server_->Get("/metrics", [this](const httplib::Request& req, httplib::Response& res) {
+    addLocalRoute("GET", "/metrics", [this](const httplib::Request& req, httplib::Response& res) {
         handleMetrics(req, res);
     });
 
+    registerCatchAll(*server_);
+}
+
+void HttpServer::registerCatchAll(httplib::Server& server) {
+    // Connections that overflowed the worker queue are answered before routing
+    server.set_pre_routing_handler([](const httplib::Request& /* req */, httplib::Response& res) {
+        if (!WorkerPool::isShedding()) {
+            return httplib::Server::HandlerResponse::Unhandled;
+        }
+        res.status = StatusCode::SERVICE_UNAVAILABLE;
+        res.set_header("Retry-After", "1");
+        res.set_header("Connection", "close");
+        res.set_content(ResponseBuilder::errorJson("Server overloaded"), "application/json");
+        return httplib::Server::HandlerResponse::Handled;
+    });
+
     // Catch-all handler for all other requests
-    server_->Get(".*", [this](const httplib::Request& req, httplib::Response& res) {
+    server.Get(".*", [this](const httplib::Request& req, httplib::Response& res) {
         handleRequest(req, res);
     });
 
-    server_->Post(".*", [this](const httplib::Request& req, httplib::Response& res) {
+    server.Post(".*", [this](const httplib::Request& req, httplib::Response& res) {
         handleRequest(req, res);
     });
 
-    server_->Put(".*", [this](const httplib::Request& req, httplib::Response& res) {
+    server.Put(".*", [this](const httplib::Request& req, httplib::Response& res) {
         handleRequest(req, res);
     });
 
-    server_->Delete(".*", [this](const httplib::Request& req, httplib::Response& res) {
+    server.Delete(".*", [this](const httplib::Request& req, httplib::Response& res) {
         handleRequest(req, res);
     });
 
-    server_->Patch(".*", [this](const httplib::Request& req, httplib::Response& res) {
+    server.Patch(".*", [this](const httplib::Request& req, httplib::Response& res) {
         handleRequest(req, res);
     });
 
-    server_->Options(".*", [this](const httplib::Request& req, httplib::Response& res) {
-        // Add security headers
-        addSecurityHeaders(res);
+    server.Options(".*", [this](const httplib::Request& req, httplib::Response& res) {
+        handlePreflight(req, res);
+    });
+}
 
-        if (!cors_config_.enabled) {
-            res.status = 204;
-            return;
-        }
+void HttpServer::addLocalRoute(const std::string& method, const std::string& path,
+                               httplib::Server::Handler handler) {
+    if (registerRoute(*server_, method, path, handler)) {
+        local_routes_[method + " " + path] = std::move(handler);
+    }
+}
 
-        // Always set Vary so caches key on these headers
-        res.set_header("Vary", "Origin, Access-Control-Request-Method, Access-Control-Request-Headers");
+bool HttpServer::registerRoute(httplib::Server& server, const std::string& method, const std::string& path,
+                               const httplib::Server::Handler& handler) {
+    if (method == "GET") {
+        server.Get(path, handler);
+    } else if (method == "POST") {
+        server.Post(path, handler);
+    } else if (method == "PUT") {
+        server.Put(path, handler);
+    } else if (method == "DELETE") {
+        server.Delete(path, handler);
+    } else if (method == "PATCH") {
+        server.Patch(path, handler);
+    } else {
+        std::cerr << "Unsupported method for local route: " << method << " " << path << "\n";
+        return false;
+    }
+    return true;
+}
 
-        std::string origin = req.get_header_value("Origin");
-        if (!isOriginAllowed(origin)) {
+void HttpServer::dispatchRequest(const httplib::Request& req, httplib::Response& res) {
+    // httplib serves HEAD from GET handlers
+    std::string method = req.method == "HEAD" ? "GET" : req.method;
+    auto local = local_routes_.find(method + " " + req.path);
+    if (local != local_routes_.end()) {
+        local->second(req, res);
+        return;
+    }
+
+    if (req.method == "OPTIONS") {
+        handlePreflight(req, res);
+    } else if (method == "GET" || method == "POST" || method == "PUT" ||
+               method == "DELETE" || method == "PATCH") {
+        handleRequest(req, res);
+    } else {
+        res.status = StatusCode::METHOD_NOT_ALLOWED;
+        res.set_content(ResponseBuilder::errorJson("Method not allowed"), "application/json");
+    }
+}
+
+void HttpServer::handlePreflight(const httplib::Request& req, httplib::Response& res) {
+    // Add security headers
+    addSecurityHeaders(res);
+
+    if (!cors_config_.enabled) {
+        res.status = 204;
+        return;
+    }
+
+    // Always set Vary so caches key on these headers
+    res.set_header("Vary", "Origin, Access-Control-Request-Method, Access-Control-Request-Headers");
+
+    std::string origin = req.get_header_value("Origin");
+    if (!isOriginAllowed(origin)) {
+        res.status = 204;
+        return;
+    }
+
+    // Validate requested method is in our allowed list
+    std::string req_method = req.get_header_value("Access-Control-Request-Method");
+    if (!req_method.empty()) {
+        bool method_ok = false;
+        for (const auto& m : cors_config_.allowed_methods) {
+            if (m == req_method) { method_ok = true; break; }
+        }
+        if (!method_ok) {
             res.status = 204;
             return;
         }
+    }
 
-        // Validate requested method is in our allowed list
-        std::string req_method = req.get_header_value("Access-Control-Request-Method");
-        if (!req_method.empty()) {
-            bool method_ok = false;
-            for (const auto& m : cors_config_.allowed_methods) {
-                if (m == req_method) { method_ok = true; break; }
-            }
-            if (!method_ok) {
-                res.status = 204;
-                return;
-            }
-        }
-
-        res.set_header("Access-Control-Allow-Origin", origin);
+    res.set_header("Access-Control-Allow-Origin", origin);
 
-        // Join allowed methods
-        std::string methods;
-        for (size_t i = 0; i < cors_config_.allowed_methods.size(); i++) {
-            if (i > 0) methods += ", ";
-            methods += cors_config_.allowed_methods[i];
-        }
-        res.set_header("Access-Control-Allow-Methods", methods);
+    // Join allowed methods
+    std::string methods;
+    for (size_t i = 0; i < cors_config_.allowed_methods.size(); i++) {
+        if (i > 0) methods += ", ";
+        methods += cors_config_.allowed_methods[i];
+    }
+    res.set_header("Access-Control-Allow-Methods", methods);
 
-        // Join allowed headers
-        std::string headers;
-        for (size_t i = 0; i < cors_config_.allowed_headers.size(); i++) {
-            if (i > 0) headers += ", ";
-            headers += cors_config_.allowed_headers[i];
-        }
-        res.set_header("Access-Control-Allow-Headers", headers);
+    // Join allowed headers
+    std::string headers;
+    for (size_t i = 0; i < cors_config_.allowed_headers.size(); i++) {
+        if (i > 0) headers += ", ";
+        headers += cors_config_.allowed_headers[i];
+    }
+    res.set_header("Access-Control-Allow-Headers", headers);
 
-        res.set_header("Access-Control-Max-Age", std::to_string(cors_config_.max_age));
+    res.set_header("Access-Control-Max-Age", std::to_string(cors_config_.max_age));
 
-        if (cors_config_.allow_credentials) {
-            res.set_header("Access-Control-Allow-Credentials", "true");
-        }
+    if (cors_config_.allow_credentials) {
+        res.set_header("Access-Control-Allow-Credentials", "true");
+    }
 
-        res.status = 204;
-    });
+    res.status = 204;
 }
 
 void HttpServer::handleRequest(const httplib::Request& req, httplib::Response& res) {
@@ -448,18 +636,42 @@ void HttpServer::handleRequest(const httplib::Request& req, httplib::Response& r
         return;
     }
 
-    // Check cache for GET requests (respecting Cache-Control directives)
-    std::string cache_key = req.method + ":" + req.path;
+    if (!match.backend) {
+        res.status = StatusCode::BAD_GATEWAY;
+        res.set_content(ResponseBuilder::errorJson("No backend configured for route"), "application/json");
+        return;
+    }
+
+    // Check cache for GET requests (respecting the route's policy and Cache-Control directives)
+    const RouteCachePolicy& cache_policy = match.route->cache;
+    std::string cache_base = CacheKeyBuilder::baseKey(req.method, req.path);
+    std::string cache_query = CacheKeyBuilder::normalizeQuery(req.params);
+    std::string cache_key = cache_keys_.build(cache_base, cache_query, headers_map, cache_policy);
     std::string req_cache_control = req.get_header_value("Cache-Control");
     bool skip_cache = req_cache_control.find("no-cache") != std::string::npos ||
                       req_cache_control.find("no-store") != std::string::npos;
-    if (req.method == "GET" && cache_get_ && !skip_cache) {
+    // On routes that allow it, event streams (what EventSource asks for) are
+    // relayed like "stream" routes
+    bool streamed = match.route->stream ||
+                    (match.route->event_stream &&
+                     req.get_header_value("Accept").find("text/event-stream") != std::string::npos);
+    bool use_cache = req.method == "GET" && cache_policy.enabled && !skip_cache && !streamed;
+    std::optional<CachedResponse> stale_copy;   // Kept for stale-if-error
+    if (use_cache && cache_get_) {
         auto cached = cache_get_(cache_key);
-        if (cached) {
+        bool serve_stale = cached && cached->stale_ms > 0 &&
+                           cached->stale_ms <= cache_stale_while_revalidate_ * 1000LL;
+        if (serve_stale) {
+            scheduleCacheRefresh(cache_key, cache_base, cache_query, match, headers_map);
+        } else if (cached && cached->stale_ms > 0) {
+            stale_copy = std::move(cached);
+            cached.reset();
+        }
+
+        // An entry that fails to decode is treated as a miss
+        if (cached && writeCachedResponse(req, res, *cached)) {
             metrics_->incrementCacheHits();
-            res.status = cached->status_code;
-            res.set_content(cached->body, cached->content_type.c_str());
-            res.set_header("X-Cache", "HIT");
+            res.set_header("X-Cache", serve_stale ? "STALE" : "HIT");
 
             auto end_time = std::chrono::steady_clock::now();
             auto response_time = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -477,16 +689,91 @@ void HttpServer::handleRequest(const httplib::Request& req, httplib::Response& r
 
     // Proxy to backend (use shared ProxyManager to preserve circuit breaker state)
     headers_map["X-Request-ID"] = request_id;
-    auto proxy_response = proxy_manager_->forwardRequest(
-        req.method,
-        match.backend_url,
-        match.rewritten_path,
-        headers_map,
-        req.body,
-        match.route->timeout_ms
-    );
 
-    if (proxy_response.success) {
+    // Streamed responses are relayed as the backend sends them
+    if (streamed) {
+        int idle_timeout_ms = match.route->stream_idle_timeout_ms > 0
+            ? match.route->stream_idle_timeout_ms : match.route->timeout_ms;
+        auto stream = proxy_manager_->openStream(req.method, *match.backend, match.rewritten_path,
+                                                 headers_map, req.body, match.route->timeout_ms,
+                                                 idle_timeout_ms, stream_buffer_bytes_);
+        const ProxyResponse& head = stream->head();
+        if (head.success) {
+            relayStream(res, stream, idle_timeout_ms);
+        } else if (head.status_code == StatusCode::SERVICE_UNAVAILABLE) {
+            // Stream limit reached or circuit open; the backend was not asked
+            res.status = StatusCode::SERVICE_UNAVAILABLE;
+            res.set_header("Retry-After", "1");
+            res.set_content(ResponseBuilder::errorJson(head.error), "application/json");
+        } else {
+            res.status = StatusCode::BAD_GATEWAY;
+            res.set_content(ResponseBuilder::errorJson("Backend error: " + head.error), "application/json");
+            metrics_->incrementBackendErrors(*match.backend);
+        }
+
+        // Timed to the backend's headers; the body is still on its way
+        auto end_time = std::chrono::steady_clock::now();
+        auto response_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+            end_time - start_time
+        ).count();
+
+        metrics_->incrementRequests(req.method, req.path, res.status);
+        metrics_->recordRequestDuration(req.method, static_cast<double>(response_time));
+        metrics_->recordBackendLatency(*match.backend, static_cast<double>(response_time));
+
+        logRequest(request_id, client_ip, req.method, req.path, res.status,
+                  response_time, user_id, std::string(match.backend_url), head.error);
+        return;
+    }
+    auto forward = [&]() {
+        return proxy_manager_->forwardRequest(
+            req.method,
+            *match.backend,
+            match.rewritten_path,
+            headers_map,
+            req.body,
+            match.route->timeout_ms
+        );
+    };
+
+    // Concurrent identical GETs share one upstream fetch, but only on routes
+    // whose responses may be cached and shared. The cache key covers
+    // credentials; cookie sessions it does not cover never coalesce.
+    std::shared_ptr<const ProxyResponse> proxy_result;
+    bool coalesced = false;
+    bool wait_timed_out = false;
+    if (use_cache && coalescing_enabled_ && SingleFlight::mayCoalesce(headers_map)) {
+        auto flight = single_flight_.run(cache_key, match.route->timeout_ms, forward);
+        coalesced = flight.shared;
+        if (flight.response) {
+            proxy_result = std::move(flight.response);
+        } else {
+            wait_timed_out = true;
+            ProxyResponse timed_out;
+            timed_out.error = "Timed out waiting for in-flight upstream request";
+            proxy_result = std::make_shared<const ProxyResponse>(std::move(timed_out));
+        }
+    } else {
+        proxy_result = std::make_shared<const ProxyResponse>(forward());
+    }
+    const ProxyResponse& proxy_response = *proxy_result;
+
+    // stale-if-error covers the 5xx codes RFC 5861 names as well as transport
+    // failures and an open circuit
+    int upstream_status = proxy_response.status_code;
+    bool upstream_failed = !proxy_response.success ||
+                           upstream_status == 500 || upstream_status == 502 ||
+                           upstream_status == 503 || upstream_status == 504;
+
+    if (upstream_failed && stale_copy && stale_copy->stale_ms <= cache_stale_if_error_ * 1000LL &&
+        writeCachedResponse(req, res, *stale_copy)) {
+        metrics_->incrementCacheHits();
+        res.set_header("X-Cache", "STALE");
+        res.set_header("Warning", "111 - \"Revalidation Failed\"");
+        if (!coalesced) {
+            metrics_->incrementBackendErrors(*match.backend);
+        }
+    } else if (proxy_response.success) {
         res.status = proxy_response.status_code;
         res.body = proxy_response.body;
 
@@ -494,34 +781,29 @@ void HttpServer::handleRequest(const httplib::Request& req, httplib::Response& r
             res.set_header(key.c_str(), value.c_str());
         }
 
-        // Store in cache for successful GET responses (respecting Cache-Control)
-        if (req.method == "GET" && cache_set_ && proxy_response.status_code == 200) {
-            // Check response Cache-Control directives
-            std::string resp_cc;
-            auto cc_it = proxy_response.headers.find("Cache-Control");
-            if (cc_it == proxy_response.headers.end())
-                cc_it = proxy_response.headers.find("cache-control");
-            if (cc_it != proxy_response.headers.end())
-                resp_cc = cc_it->second;
-
-            bool cacheable = resp_cc.find("no-store") == std::string::npos &&
-                             resp_cc.find("no-cache") == std::string::npos &&
-                             resp_cc.find("private") == std::string::npos;
-
-            if (cacheable) {
-                CachedResponse to_cache;
-                to_cache.body = proxy_response.body;
-                to_cache.content_type = "application/json";
-                to_cache.status_code = proxy_response.status_code;
-                cache_set_(cache_key, to_cache, cache_ttl_);
+        if (coalesced) {
+            res.set_header("X-Coalesced", "true");
+        }
+
+        // Store responses the route caches (respecting Cache-Control).
+        // Only the request that fetched stores the response.
+        if (use_cache && cache_set_) {
+            // A cached error must not replace a stale copy kept for stale-if-error
+            bool keeps_stale = stale_copy && cache_policy.isNegative(proxy_response.status_code);
+            if (!coalesced && !keeps_stale &&
+                cache_policy.cacheable(proxy_response.status_code, proxy_response.body.size())) {
+                storeInCache(cache_base, cache_query, *match.route, headers_map, proxy_response);
             }
             res.set_header("X-Cache", "MISS");
         }
     } else {
-        res.status = StatusCode::BAD_GATEWAY;
+        res.status = wait_timed_out ? StatusCode::GATEWAY_TIMEOUT : StatusCode::BAD_GATEWAY;
         res.set_content(ResponseBuilder::errorJson("Backend error: " + proxy_response.error),
                        "application/json");
-        metrics_->incrementBackendErrors(match.backend_url);
+        // A shared failure was already counted by the request that fetched
+        if (!coalesced) {
+            metrics_->incrementBackendErrors(*match.backend);
+        }
     }
 
     // Log request and record metrics
@@ -532,13 +814,210 @@ void HttpServer::handleRequest(const httplib::Request& req, httplib::Response& r
 
     metrics_->incrementRequests(req.method, req.path, res.status);
     metrics_->recordRequestDuration(req.method, static_cast<double>(response_time));
-    metrics_->recordBackendLatency(match.backend_url, static_cast<double>(response_time));
+    metrics_->recordBackendLatency(*match.backend, static_cast<double>(response_time));
 
     logRequest(request_id, client_ip, req.method, req.path, res.status,
-              response_time, user_id, match.backend_url,
+              response_time, user_id, std::string(match.backend_url),
               proxy_response.success ? "" : proxy_response.error);
 }
 
+void HttpServer::relayStream(httplib::Response& res, std::shared_ptr<ProxyStream> stream, int timeout_ms) {
+    const ProxyResponse& head = stream->head();
+    res.status = head.status_code;
+
+    // Framing is httplib's; Content-Type goes through the content provider
+    std::string content_length;
+    std::string content_type;
+    for (const auto& [key, value] : head.headers) {
+        if (strcasecmp(key.c_str(), "Content-Length") == 0) {
+            content_length = value;
+        } else if (strcasecmp(key.c_str(), "Content-Type") == 0) {
+            content_type = value;
+        } else if (strcasecmp(key.c_str(), "Transfer-Encoding") != 0) {
+            res.set_header(key, value);
+        }
+    }
+
+    size_t length = 0;
+    bool sized = false;
+    if (!content_length.empty()) {
+        try {
+            size_t parsed = 0;
+            length = std::stoull(content_length, &parsed);
+            sized = parsed == content_length.size();
+        } catch (const std::exception&) {
+            sized = false;
+        }
+    }
+
+    // The event loop pulls the body on its own thread, so an idle stream holds no worker
+    StreamedBody body;
+    body.content_length = sized ? static_cast<long long>(length) : -1;
+    body.read = [stream](std::string& out) {
+        return stream->poll(out) != ProxyStream::Poll::END;
+    };
+    body.subscribe = [stream](std::function<void()> notify) {
+        stream->onReadable(std::move(notify));
+    };
+    body.failed = [stream]() {
+        return stream->failed();
+    };
+    if (EventLoopServer::streamBody(std::move(body))) {
+        if (!content_type.empty()) {
+            res.set_header("Content-Type", content_type);
+        }
+        return;
+    }
+
+    // httplib writes each chunk as soon as read() returns it
+    if (sized) {
+        // Known length: a body that ends early is an error, which aborts the connection
+        res.set_content_provider(length, content_type,
+            [stream, timeout_ms](size_t /* offset */, size_t /* length */, httplib::DataSink& sink) {
+                std::string chunk;
+                return stream->read(chunk, timeout_ms) && sink.write(chunk.data(), chunk.size());
+            });
+    } else {
+        res.set_chunked_content_provider(content_type,
+            [stream, timeout_ms](size_t /* offset */, httplib::DataSink& sink) {
+                std::string chunk;
+                if (stream->read(chunk, timeout_ms)) {
+                    return sink.write(chunk.data(), chunk.size());
+                }
+                if (stream->failed()) {
+                    return false;
+                }
+                sink.done();
+                return true;
+            });
+    }
+}
+
+void HttpServer::storeInCache(const std::string& cache_base, const std::string& cache_query,
+                              const Route& route,
+                              const std::map<std::string, std::string>& request_headers,
+                              const ProxyResponse& response) {
+    // Check response Cache-Control directives
+    std::string resp_cc;
+    auto cc_it = response.headers.find("Cache-Control");
+    if (cc_it == response.headers.end())
+        cc_it = response.headers.find("cache-control");
+    if (cc_it != response.headers.end())
+        resp_cc = cc_it->second;
+
+    bool cacheable = resp_cc.find("no-store") == std::string::npos &&
+                     resp_cc.find("no-cache") == std::string::npos &&
+                     resp_cc.find("private") == std::string::npos;
+    if (!cacheable || !cache_keys_.learnVary(cache_base, response.headers)) {
+        return;
+    }
+
+    CachedResponse to_cache;
+    to_cache.tags.push_back("route:" + route.path_pattern);
+    to_cache.body = response.body;
+    to_cache.status_code = response.status_code;
+    for (const auto& [name, value] : response.headers) {
+        std::string lower = name;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        if (lower == "content-type") {
+            to_cache.content_type = value;
+        } else if (lower == "surrogate-key") {
+            // Space-separated purge tags; consumed here, not shown to clients
+            std::istringstream keys(value);
+            std::string tag;
+            while (keys >> tag) {
+                to_cache.tags.push_back("key:" + tag);
+            }
+        } else if (lower != "content-length" && lower != "transfer-encoding" && lower != "connection" &&
+                   lower != "keep-alive" && lower != "set-cookie") {
+            // Connection-level and per-client headers are not replayed from cache
+            to_cache.headers[name] = value;
+        }
+    }
+    // Compress once here so every hit can send the stored bytes as they are
+    bool backend_encoded = false;
+    for (const auto& [name, value] : to_cache.headers) {
+        backend_encoded = backend_encoded || strcasecmp(name.c_str(), "Content-Encoding") == 0;
+    }
+    if (!cache_compression_.empty() && !backend_encoded &&
+        to_cache.body.size() >= cache_compression_min_size_ &&
+        Compression::isCompressibleType(to_cache.content_type)) {
+        auto compressed = Compression::compress(cache_compression_, to_cache.body, cache_compression_level_);
+        if (compressed && compressed->size() < to_cache.body.size()) {
+            to_cache.body = std::move(*compressed);
+            to_cache.headers["Content-Encoding"] = cache_compression_;
+            auto vary = std::find_if(to_cache.headers.begin(), to_cache.headers.end(), [](const auto& header) {
+                return strcasecmp(header.first.c_str(), "Vary") == 0;
+            });
+            if (vary == to_cache.headers.end()) {
+                to_cache.headers["Vary"] = "Accept-Encoding";
+            } else {
+                vary->second += ", Accept-Encoding";
+            }
+        }
+    }
+
+    // Keyed after learning Vary, which may differ from what the lookup assumed
+    // Negative entries just expire: a stale 404 or 503 is not worth serving
+    int ttl = route.cache.ttlFor(response.status_code, response.body.size());
+    int stale_ttl = route.cache.isNegative(response.status_code)
+                        ? 0 : std::max(cache_stale_while_revalidate_, cache_stale_if_error_);
+    cache_set_(cache_keys_.build(cache_base, cache_query, request_headers, route.cache), to_cache,
+               ttl, stale_ttl);
+}
+
+bool HttpServer::writeCachedResponse(const httplib::Request& req, httplib::Response& res,
+                                     const CachedResponse& cached) {
+    std::string coding;
+    for (const auto& [name, value] : cached.headers) {
+        if (strcasecmp(name.c_str(), "Content-Encoding") == 0) {
+            coding = value;
+        }
+    }
+
+    // Clients that cannot take the stored coding get a decoded copy
+    std::optional<std::string> decoded;
+    if (!coding.empty() && !Compression::accepts(req.get_header_value("Accept-Encoding"), coding)) {
+        decoded = Compression::decompress(coding, cached.body, MAX_DECODED_CACHE_BODY);
+        if (!decoded) {
+            return false;
+        }
+    }
+
+    res.status = cached.status_code;
+    for (const auto& [name, value] : cached.headers) {
+        if (decoded && strcasecmp(name.c_str(), "Content-Encoding") == 0) {
+            continue;
+        }
+        res.set_header(name.c_str(), value.c_str());
+    }
+    if (cached.content_type.empty()) {
+        // The backend sent none; replaying a guessed type would change the response
+        res.body = decoded ? std::move(*decoded) : cached.body;
+    } else {
+        res.set_content(decoded ? *decoded : cached.body, cached.content_type.c_str());
+    }
+    return true;
+}
+
+void HttpServer::scheduleCacheRefresh(const std::string& cache_key, const std::string& cache_base,
+                                      const std::string& cache_query, const RouteMatch& match,
+                                      const std::map<std::string, std::string>& headers) {
+    // Copies only, plus the route table, which keeps the matched route and
+    // backend alive after the request is gone and across a reload
+    refresh_queue_.submit(cache_key, [this, cache_key, cache_base, cache_query, table = match.table,
+                                      route = match.route, backend = match.backend,
+                                      path = match.rewritten_path, headers]() {
+        auto flight = single_flight_.run(cache_key, route->timeout_ms, [&]() {
+            return proxy_manager_->forwardRequest("GET", *backend, path, headers, "", route->timeout_ms);
+        });
+        if (!flight.shared && flight.response && flight.response->success &&
+            route->cache.cacheable(flight.response->status_code, flight.response->body.size())) {
+            storeInCache(cache_base, cache_query, *route, headers, *flight.response);
+        }
+    });
+}
+
 void HttpServer::handleHealthCheck(const httplib::Request& /* req */, httplib::Response& res) {
     // Add security headers
     addSecurityHeaders(res);
@@ -4,9 +4,11 @@
 #include <memory>
 #include <functional>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <optional>
 #include <atomic>
+#include <algorithm>
 #include <httplib.h>
 #include "../auth/JWTManager.h"
 #include "../rate_limiter/RateLimiter.h"
@@ -15,6 +17,11 @@
 #include "../logging/Logger.h"
 #include "../metrics/SimpleMetrics.h"
 #include "../router/ProxyManager.h"
+#include "SingleFlight.h"
+#include "RefreshQueue.h"
+#include "CacheKey.h"
+#include "WorkerPool.h"
+#include "EventLoop.h"
 
 namespace gateway {
 
@@ -116,14 +123,49 @@ public:
         std::string body;
         std::string content_type;
         int status_code;
+        long long stale_ms = 0;     // Milliseconds past the fresh TTL (0 = fresh)
+        std::map<std::string, std::string> headers{};   // Backend headers replayed on a hit
+        std::vector<std::string> tags{};                // Purge tags (set on store only)
     };
     using CacheGetFn = std::function<std::optional<CachedResponse>(const std::string& key)>;
-    using CacheSetFn = std::function<void(const std::string& key, const CachedResponse& resp, int ttl)>;
+    /**
+     * @brief Store a response: fresh for ttl seconds, then kept stale for stale_ttl more
+     */
+    using CacheSetFn = std::function<void(const std::string& key, const CachedResponse& resp,
+                                          int ttl, int stale_ttl)>;
 
-    void setCache(CacheGetFn get_fn, CacheSetFn set_fn, int default_ttl = 300) {
+    /**
+     * @brief Set the response cache; what is cached and for how long comes
+     *        from each route's RouteCachePolicy
+     */
+    void setCache(CacheGetFn get_fn, CacheSetFn set_fn) {
         cache_get_ = std::move(get_fn);
         cache_set_ = std::move(set_fn);
-        cache_ttl_ = default_ttl;
+    }
+
+    /**
+     * @brief Serve stale cache entries instead of waiting on the backend
+     * @param stale_while_revalidate Seconds past the TTL an entry is served while
+     *        it is refreshed in the background
+     * @param stale_if_error Seconds past the TTL an entry is served when the
+     *        backend fails, answers 500/502/503/504, or its circuit is open
+     */
+    void setCacheStaleness(int stale_while_revalidate, int stale_if_error) {
+        cache_stale_while_revalidate_ = std::max(stale_while_revalidate, 0);
+        cache_stale_if_error_ = std::max(stale_if_error, 0);
+    }
+
+    /**
+     * @brief Store compressible cache entries encoded, served as-is to
+     *        clients that accept the coding
+     * @param coding "gzip" or "br" (empty disables)
+     * @param min_size Smaller bodies are stored uncompressed
+     * @param level Codec level (-1 = default)
+     */
+    void setCacheCompression(const std::string& coding, size_t min_size, int level) {
+        cache_compression_ = coding;
+        cache_compression_min_size_ = min_size;
+        cache_compression_level_ = level;
     }
 
     /**
@@ -137,6 +179,73 @@ public:
         distributed_rate_limiter_ = std::move(fn);
     }
 
+    /**
+     * @brief Share one upstream fetch among concurrent identical GET requests
+     */
+    void setRequestCoalescing(bool enabled) { coalescing_enabled_ = enabled; }
+
+    SingleFlight::Stats getCoalescingStats() const { return single_flight_.getStats(); }
+
+    /**
+     * @brief Body bytes buffered per streamed response (routes with
+     *        "stream": true, and text/event-stream requests on routes with
+     *        "event_stream": true)
+     */
+    void setStreamBufferSize(size_t bytes) { stream_buffer_bytes_ = std::max<size_t>(bytes, 4096); }
+
+    /**
+     * @brief Streams open at once before new ones are answered 503; the
+     *        threaded server also caps them at half its workers
+     */
+    void setMaxStreams(size_t max_streams) { max_streams_ = max_streams; }
+
+    /**
+     * @brief Serve connections from a bounded WorkerPool instead of httplib's
+     *        default pool; overflow connections get a fast 503
+     */
+    void setWorkerPool(const WorkerPoolConfig& config) { worker_pool_config_ = config; }
+
+    /**
+     * @brief Keep-alive limits for client connections
+     * @param max_requests Requests served on one connection before it is closed
+     * @param timeout_seconds Idle time before a kept-alive connection is closed
+     */
+    void setKeepAlive(size_t max_requests, int timeout_seconds) {
+        keep_alive_max_requests_ = max_requests;
+        keep_alive_timeout_ = timeout_seconds;
+    }
+
+    /**
+     * @brief Accept on several SO_REUSEPORT sockets, each with its own
+     *        acceptor thread and share of the worker pool
+     * @param count Listening sockets (1 = a single httplib listener)
+     * @param pin_cpus Pin acceptor i and its workers to CPU i
+     */
+    void setAcceptors(size_t count, bool pin_cpus) {
+        acceptors_ = std::max<size_t>(count, 1);
+        pin_cpus_ = pin_cpus;
+    }
+
+    /**
+     * @brief Serve plain HTTP from epoll event loops instead of one thread per
+     *        connection; requests still run on the worker pool
+     *
+     * Ignored when TLS is enabled.
+     */
+    void setEventLoop(const EventLoopConfig& config) { event_loop_config_ = config; }
+
+    /**
+     * @brief Register a handler for an exact method and path, taking
+     *        precedence over the proxy catch-all in either server mode
+     */
+    void addLocalRoute(const std::string& method, const std::string& path,
+                       httplib::Server::Handler handler);
+
+    /**
+     * @brief Metrics registry exported at /metrics
+     */
+    std::shared_ptr<SimpleMetrics> getMetrics() const { return metrics_; }
+
 private:
     std::string host_;
     int port_;
@@ -154,23 +263,110 @@ private:
     bool tls_enabled_;
     std::string cert_file_;
     std::string key_file_;
+    std::string tls_cipher_list_;
+    std::string tls_min_version_ = "1.2";
 
     std::map<std::string, std::string> security_headers_;
     CORSConfig cors_config_;
 
     CacheGetFn cache_get_;
     CacheSetFn cache_set_;
-    int cache_ttl_ = 300;
+    int cache_stale_while_revalidate_ = 0;
+    int cache_stale_if_error_ = 0;
+    CacheKeyBuilder cache_keys_;
+    std::string cache_compression_;
+    size_t cache_compression_min_size_ = 1024;
+    int cache_compression_level_ = -1;
+    static constexpr size_t MAX_DECODED_CACHE_BODY = 64 * 1024 * 1024;
 
     DistributedRateLimitFn distributed_rate_limiter_;
 
+    SingleFlight single_flight_;
+    bool coalescing_enabled_ = true;
+    size_t stream_buffer_bytes_ = 256 * 1024;
+    size_t max_streams_ = 256;
+
+    std::optional<WorkerPoolConfig> worker_pool_config_;
+    size_t keep_alive_max_requests_ = 0;    // 0 = httplib default
+    int keep_alive_timeout_ = 0;
+    size_t acceptors_ = 1;
+    bool pin_cpus_ = false;
+    std::vector<std::unique_ptr<httplib::Server>> shards_;     // Acceptors besides server_
+
     std::atomic<int> active_connections_{0};
 
+    // Declared after every member refresh jobs use (cache, proxy, router,
+    // single_flight_), so its worker is stopped before any of them is destroyed
+    RefreshQueue refresh_queue_;
+
+    std::optional<EventLoopConfig> event_loop_config_;
+    std::unordered_map<std::string, httplib::Server::Handler> local_routes_;    // "METHOD path"
+    // After refresh_queue_: its workers run handleRequest, which schedules refreshes
+    std::unique_ptr<EventLoopServer> event_loop_;
+
+    /**
+     * @brief Cache a backend response unless its Cache-Control or Vary forbids it
+     *
+     * The caller has checked the response against the route's cache policy.
+     * The entry is tagged "route:<route pattern>" plus "key:<k>" for each
+     * key in the backend's Surrogate-Key header, for purging by tag.
+     */
+    void storeInCache(const std::string& cache_base, const std::string& cache_query,
+                      const Route& route,
+                      const std::map<std::string, std::string>& request_headers,
+                      const ProxyResponse& response);
+
+    /**
+     * @brief Send a streamed backend response through the event loop, or
+     *        else an httplib content provider (sized when the backend sent
+     *        Content-Length, chunked otherwise)
+     * @param timeout_ms Longest wait for the next body bytes
+     */
+    static void relayStream(httplib::Response& res, std::shared_ptr<ProxyStream> stream, int timeout_ms);
+
+    /**
+     * @brief Fill a response from a cache entry, decoding it if the client
+     *        does not accept its stored Content-Encoding
+     * @return false if the entry could not be decoded (nothing written)
+     */
+    static bool writeCachedResponse(const httplib::Request& req, httplib::Response& res,
+                                    const CachedResponse& cached);
+
+    /**
+     * @brief Refetch a stale cache entry in the background (once per key)
+     */
+    void scheduleCacheRefresh(const std::string& cache_key, const std::string& cache_base,
+                              const std::string& cache_query, const RouteMatch& match,
+                              const std::map<std::string, std::string>& headers);
+
     /**
      * @brief Setup request handlers
      */
     void setupHandlers();
 
+    /**
+     * @brief Shedding pre-routing handler plus the proxy catch-all routes
+     */
+    void registerCatchAll(httplib::Server& server);
+
+    static bool registerRoute(httplib::Server& server, const std::string& method, const std::string& path,
+                              const httplib::Server::Handler& handler);
+
+    /**
+     * @brief A plain or TLS server as configured by enableTLS()
+     */
+    std::unique_ptr<httplib::Server> createServer() const;
+
+    /**
+     * @brief Apply the worker pool and keep-alive settings to one listener
+     */
+    void configureServer(httplib::Server& server, const std::optional<WorkerPoolConfig>& pool);
+
+    /**
+     * @brief Run one listener per acceptor shard until stop()
+     */
+    bool listenSharded();
+
     /**
      * @brief Add security headers to response
      */
@@ -186,6 +382,17 @@ private:
      */
     bool isOriginAllowed(const std::string& origin) const;
 
+    /**
+     * @brief Route a request from the event loop the way httplib routes it:
+     *        local routes, then CORS preflight, then handleRequest
+     */
+    void dispatchRequest(const httplib::Request& req, httplib::Response& res);
+
+    /**
+     * @brief Answer an OPTIONS (CORS preflight) request
+     */
+    void handlePreflight(const httplib::Request& req, httplib::Response& res);
+
     /**
      * @brief Main request handler
      */
@@ -0,0 +1,73 @@
+#include "RefreshQueue.h"
+#include <iostream>
+
+namespace gateway {
+
+RefreshQueue::RefreshQueue(size_t max_pending)
+    : max_pending_(max_pending) {
+    worker_ = std::thread([this]() {
+        workerLoop();
+    });
+}
+
+RefreshQueue::~RefreshQueue() {
+    stop();
+}
+
+bool RefreshQueue::submit(const std::string& key, std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || pending_keys_.size() >= max_pending_ || !pending_keys_.insert(key).second) {
+            return false;
+        }
+        queue_.push_back({key, std::move(job)});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void RefreshQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+size_t RefreshQueue::pending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_keys_.size();
+}
+
+void RefreshQueue::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() {
+                return !running_ || !queue_.empty();
+            });
+            if (!running_) {
+                queue_.clear();
+                pending_keys_.clear();
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        try {
+            job.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Background refresh failed for " << job.key << ": " << e.what() << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_keys_.erase(job.key);
+    }
+}
+
+} // namespace gateway
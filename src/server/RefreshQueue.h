@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <unordered_set>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+
+namespace gateway {
+
+/**
+ * @brief Runs background cache refreshes, at most one pending per key
+ *
+ * A single worker thread drains a bounded queue. Submitting a key that is
+ * already queued or running is a no-op, so a stale hot key triggers one
+ * refresh no matter how many requests see it stale.
+ */
+class RefreshQueue {
+public:
+    explicit RefreshQueue(size_t max_pending = 1024);
+    ~RefreshQueue();
+
+    RefreshQueue(const RefreshQueue&) = delete;
+    RefreshQueue& operator=(const RefreshQueue&) = delete;
+
+    /**
+     * @brief Queue a refresh job for key
+     * @return false if key is already pending or the queue is full
+     */
+    bool submit(const std::string& key, std::function<void()> job);
+
+    /**
+     * @brief Stop the worker; queued jobs that have not started are dropped
+     */
+    void stop();
+
+    /**
+     * @brief Keys queued or running
+     */
+    size_t pending();
+
+private:
+    struct Job {
+        std::string key;
+        std::function<void()> run;
+    };
+
+    size_t max_pending_;
+    std::deque<Job> queue_;
+    std::unordered_set<std::string> pending_keys_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> running_{true};
+    std::thread worker_;
+
+    void workerLoop();
+};
+
+} // namespace gateway
@@ -0,0 +1,112 @@
+#include "SingleFlight.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <strings.h>
+
+namespace gateway {
+
+namespace {
+
+const std::string* findHeader(const std::map<std::string, std::string>& headers, const char* name) {
+    for (const auto& [key, value] : headers) {
+        if (strcasecmp(key.c_str(), name) == 0) {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+SingleFlight::Result SingleFlight::run(const std::string& key, int max_wait_ms,
+                                       const std::function<ProxyResponse()>& fetch) {
+    std::shared_ptr<Call> call;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = calls_[key];
+        if (!slot) {
+            slot = std::make_shared<Call>();
+            leader = true;
+        }
+        call = slot;
+    }
+
+    if (!leader) {
+        std::unique_lock<std::mutex> lock(call->mtx);
+        bool done = call->cv.wait_for(lock, std::chrono::milliseconds(max_wait_ms), [&call]() {
+            return call->done;
+        });
+        if (!done) {
+            timeouts_.fetch_add(1, std::memory_order_relaxed);
+            return {nullptr, true};
+        }
+        if (!isShareable(*call->response)) {
+            // Meant for the request that fetched it; get our own
+            lock.unlock();
+            return {std::make_shared<const ProxyResponse>(fetch()), false};
+        }
+        shared_.fetch_add(1, std::memory_order_relaxed);
+        return {call->response, true};
+    }
+
+    leaders_.fetch_add(1, std::memory_order_relaxed);
+    std::shared_ptr<const ProxyResponse> response;
+    try {
+        response = std::make_shared<const ProxyResponse>(fetch());
+    } catch (const std::exception& e) {
+        ProxyResponse failed;
+        failed.error = e.what();
+        response = std::make_shared<const ProxyResponse>(std::move(failed));
+    } catch (...) {
+        // Anything else must still publish a result and drop the entry, or
+        // waiters and every later request for key would wait out max_wait_ms
+        ProxyResponse failed;
+        failed.error = "Unknown error during upstream fetch";
+        response = std::make_shared<const ProxyResponse>(std::move(failed));
+    }
+
+    // Later requests start a fresh fetch; current waiters get this response
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        calls_.erase(key);
+    }
+    {
+        std::lock_guard<std::mutex> lock(call->mtx);
+        call->response = response;
+        call->done = true;
+    }
+    call->cv.notify_all();
+
+    return {response, false};
+}
+
+bool SingleFlight::mayCoalesce(const std::map<std::string, std::string>& request_headers) {
+    return findHeader(request_headers, "Cookie") == nullptr;
+}
+
+bool SingleFlight::isShareable(const ProxyResponse& response) {
+    if (findHeader(response.headers, "Set-Cookie")) {
+        return false;
+    }
+    const std::string* cache_control = findHeader(response.headers, "Cache-Control");
+    if (!cache_control) {
+        return true;
+    }
+    std::string directives = *cache_control;
+    std::transform(directives.begin(), directives.end(), directives.begin(), ::tolower);
+    return directives.find("private") == std::string::npos &&
+           directives.find("no-store") == std::string::npos;
+}
+
+size_t SingleFlight::inFlight() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return calls_.size();
+}
+
+SingleFlight::Stats SingleFlight::getStats() const {
+    return {leaders_.load(), shared_.load(), timeouts_.load()};
+}
+
+} // namespace gateway
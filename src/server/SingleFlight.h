@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include "../router/ProxyManager.h"
+
+namespace gateway {
+
+/**
+ * @brief Collapses concurrent identical upstream fetches into one
+ *
+ * The first request for a key runs the fetch; requests for the same key
+ * that arrive while it is in flight wait for and share its response
+ * instead of hitting the backend themselves. Waiters give up after a
+ * bounded time rather than queueing behind a stuck backend. A response
+ * meant for one user only (see isShareable()) is never handed to a waiter;
+ * the waiter fetches for itself instead.
+ */
+class SingleFlight {
+public:
+    struct Result {
+        std::shared_ptr<const ProxyResponse> response;  // nullptr if the wait timed out
+        bool shared;                                    // Response came from another request's fetch
+    };
+
+    struct Stats {
+        uint64_t leaders;       // Fetches actually run
+        uint64_t shared;        // Requests served by another request's fetch
+        uint64_t timeouts;      // Waiters that gave up
+    };
+
+    /**
+     * @brief Fetch for key, or wait for the fetch already in flight
+     * @param key Identifies requests that may share a response
+     * @param max_wait_ms How long a waiter waits for the in-flight fetch
+     * @param fetch Performs the upstream request (runs on the caller's thread)
+     */
+    Result run(const std::string& key, int max_wait_ms, const std::function<ProxyResponse()>& fetch);
+
+    /**
+     * @brief Whether a request may share another's fetch at all
+     *
+     * Cookies carry sessions the key does not cover, so requests sending
+     * them always fetch for themselves.
+     */
+    static bool mayCoalesce(const std::map<std::string, std::string>& request_headers);
+
+    /**
+     * @brief Whether a response may be given to other requests: not when it
+     *        sets cookies or is marked Cache-Control private or no-store
+     */
+    static bool isShareable(const ProxyResponse& response);
+
+    /**
+     * @brief Number of keys with a fetch in flight
+     */
+    size_t inFlight();
+
+    Stats getStats() const;
+
+private:
+    struct Call {
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool done = false;
+        std::shared_ptr<const ProxyResponse> response;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Call>> calls_;
+
+    std::atomic<uint64_t> leaders_{0};
+    std::atomic<uint64_t> shared_{0};
+    std::atomic<uint64_t> timeouts_{0};
+};
+
+} // namespace gateway
@@ -0,0 +1,180 @@
+#include "WorkerPool.h"
+#include "CpuAffinity.h"
+#include <algorithm>
+#include <iostream>
+
+namespace gateway {
+
+namespace {
+thread_local bool t_shedding = false;
+
+size_t defaultThreads() {
+    size_t hardware = std::thread::hardware_concurrency();
+    return std::max<size_t>(8, hardware > 1 ? hardware - 1 : 0);
+}
+
+size_t share(size_t total, size_t count) {
+    return std::max<size_t>(1, (total + count - 1) / count);
+}
+}
+
+WorkerPoolConfig WorkerPoolConfig::shard(size_t count, int shard_cpu) const {
+    WorkerPoolConfig config = *this;
+    count = std::max<size_t>(count, 1);
+    config.threads = threads ? share(threads, count) : std::max<size_t>(2, share(defaultThreads(), count));
+    config.queue_depth = share(queue_depth, count);
+    config.shed_queue_depth = share(shed_queue_depth, count);
+    config.cpu = shard_cpu;
+    return config;
+}
+
+size_t WorkerPoolConfig::workerThreads() const {
+    return threads ? threads : defaultThreads();
+}
+
+WorkerPool::WorkerPool(WorkerPoolConfig config, std::shared_ptr<SimpleMetrics> metrics)
+    : config_(config), metrics_(std::move(metrics)) {
+    if (config_.threads == 0) {
+        config_.threads = defaultThreads();
+    }
+    config_.queue_depth = std::max<size_t>(config_.queue_depth, 1);
+    config_.shed_queue_depth = std::max<size_t>(config_.shed_queue_depth, 1);
+
+    workers_.reserve(config_.threads);
+    for (size_t i = 0; i < config_.threads; i++) {
+        workers_.emplace_back([this]() {
+            workerLoop();
+        });
+    }
+    shedder_ = std::thread([this]() {
+        shedLoop();
+    });
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+bool WorkerPool::enqueue(std::function<void()> fn) {
+    size_t depth;
+    bool shed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return false;
+        }
+        if (jobs_.size() < config_.queue_depth) {
+            jobs_.push_back(std::move(fn));
+        } else if (shed_jobs_.size() < config_.shed_queue_depth) {
+            shed_jobs_.push_back(std::move(fn));
+            shed = true;
+        } else {
+            refused_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        depth = jobs_.size();
+    }
+
+    if (shed) {
+        shed_.fetch_add(1, std::memory_order_relaxed);
+        if (metrics_) {
+            metrics_->incrementConnectionsShed();
+        }
+        shed_cv_.notify_one();
+        return true;
+    }
+
+    accepted_.fetch_add(1, std::memory_order_relaxed);
+    if (metrics_) {
+        metrics_->setWorkerQueueDepth(depth);
+    }
+    jobs_cv_.notify_one();
+    return true;
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    jobs_cv_.notify_all();
+    shed_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    if (shedder_.joinable()) {
+        shedder_.join();
+    }
+}
+
+bool WorkerPool::isShedding() {
+    return t_shedding;
+}
+
+WorkerPool::Stats WorkerPool::getStats() {
+    size_t depth;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        depth = jobs_.size();
+    }
+    return {depth, accepted_.load(), shed_.load(), refused_.load()};
+}
+
+void WorkerPool::workerLoop() {
+    pinCurrentThreadToCpu(config_.cpu);
+    while (true) {
+        std::function<void()> job;
+        size_t depth;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobs_cv_.wait(lock, [this]() {
+                return !running_ || !jobs_.empty();
+            });
+            if (jobs_.empty()) {
+                return;     // Stopped and drained
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            depth = jobs_.size();
+        }
+        if (metrics_) {
+            metrics_->setWorkerQueueDepth(depth);
+        }
+
+        try {
+            job();
+        } catch (const std::exception& e) {
+            std::cerr << "Worker task failed: " << e.what() << std::endl;
+        }
+    }
+}
+
+void WorkerPool::shedLoop() {
+    t_shedding = true;
+    pinCurrentThreadToCpu(config_.cpu);
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            shed_cv_.wait(lock, [this]() {
+                return !running_ || !shed_jobs_.empty();
+            });
+            if (shed_jobs_.empty()) {
+                return;
+            }
+            job = std::move(shed_jobs_.front());
+            shed_jobs_.pop_front();
+        }
+
+        try {
+            job();
+        } catch (const std::exception& e) {
+            std::cerr << "Shed task failed: " << e.what() << std::endl;
+        }
+    }
+}
+
+} // namespace gateway
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <httplib.h>
+#include "../metrics/SimpleMetrics.h"
+
+namespace gateway {
+
+/**
+ * @brief Sizing for WorkerPool
+ */
+struct WorkerPoolConfig {
+    size_t threads = 0;             // 0 = max(8, hardware threads - 1), like httplib
+    size_t queue_depth = 1024;      // Connections waiting for a worker
+    size_t shed_queue_depth = 256;  // Overflow connections waiting for a 503
+    int cpu = -1;                   // Pin every thread to this CPU (-1 = unpinned)
+
+    /**
+     * @brief This pool's sizing split across count shards, pinned to cpu
+     *
+     * threads and both queue depths are treated as totals; an automatic
+     * thread count still gives every shard at least two workers.
+     */
+    WorkerPoolConfig shard(size_t count, int shard_cpu) const;
+
+    /**
+     * @brief threads, with 0 resolved to the automatic count
+     */
+    size_t workerThreads() const;
+};
+
+/**
+ * @brief Bounded connection queue for httplib::Server
+ *
+ * Accepted connections wait in a bounded queue for one of a fixed set of
+ * worker threads. When the queue is full, a connection goes to a separate
+ * shed thread instead, which reads its request and answers 503 at once
+ * (see isShedding()), so overload shows up as fast rejections rather than
+ * ever-growing latency. If the shed queue is full as well the connection
+ * is refused and httplib closes it.
+ */
+class WorkerPool : public httplib::TaskQueue {
+public:
+    struct Stats {
+        size_t depth;           // Connections queued now
+        uint64_t accepted;      // Queued for a worker
+        uint64_t shed;          // Sent to the shed thread
+        uint64_t refused;       // Both queues full
+    };
+
+    /**
+     * @param metrics Receives queue depth and shed counts (optional)
+     */
+    explicit WorkerPool(WorkerPoolConfig config = {}, std::shared_ptr<SimpleMetrics> metrics = nullptr);
+
+    /**
+     * @brief Finishes queued connections, then stops all threads
+     */
+    ~WorkerPool() override;
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @return false if both queues are full (httplib then closes the socket)
+     */
+    bool enqueue(std::function<void()> fn) override;
+
+    void shutdown() override;
+
+    /**
+     * @brief True on the thread serving a shed connection; handlers answer 503
+     */
+    static bool isShedding();
+
+    Stats getStats();
+
+private:
+    WorkerPoolConfig config_;
+    std::shared_ptr<SimpleMetrics> metrics_;
+
+    std::deque<std::function<void()>> jobs_;
+    std::deque<std::function<void()>> shed_jobs_;
+    std::mutex mutex_;
+    std::condition_variable jobs_cv_;
+    std::condition_variable shed_cv_;
+    bool running_ = true;           // Guarded by mutex_
+    std::vector<std::thread> workers_;
+    std::thread shedder_;
+
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> shed_{0};
+    std::atomic<uint64_t> refused_{0};
+
+    void workerLoop();
+    void shedLoop();
+};
+
+} // namespace gateway
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "../src/cache/CacheCodec.h"
+
+using namespace gateway;
+
+TEST(CacheCodecTest, RoundTripsBinaryBodyAndHeaders) {
+    std::string body("\x00\x01{\"a\":\"\\\"\"}\xff", 13);
+    std::map<std::string, std::string> headers{{"ETag", "\"v1\""}, {"X-Empty", ""}};
+    std::string encoded = CacheCodec::encode(404, 1700000000000LL, 1700000060000LL,
+                                             "application/octet-stream", headers,
+                                             {"route:/api/*", "key:user-1"}, body);
+
+    auto record = CacheRecord::fromBuffer(encoded);
+    ASSERT_TRUE(record.has_value());
+    const CacheRecordView& view = record->view();
+    EXPECT_EQ(view.status_code, 404);
+    EXPECT_EQ(view.cached_at, 1700000000000LL);
+    EXPECT_EQ(view.fresh_until, 1700000060000LL);
+    EXPECT_EQ(view.content_type, "application/octet-stream");
+    EXPECT_EQ(record->body(), body);
+    ASSERT_EQ(view.headers.size(), 2u);
+    EXPECT_EQ(view.headers[0].first, "ETag");
+    EXPECT_EQ(view.headers[0].second, "\"v1\"");
+    EXPECT_EQ(view.headers[1].second, "");
+    ASSERT_EQ(view.tags.size(), 2u);
+    EXPECT_EQ(view.tags[1], "key:user-1");
+
+    // Copies share the buffer, so the view stays valid
+    auto copy = *record;
+    record.reset();
+    EXPECT_EQ(copy.body(), body);
+}
+
+TEST(CacheCodecTest, RejectsTruncatedAndForeignValues) {
+    std::string encoded = CacheCodec::encode(200, 1, 0, "text/plain", {{"A", "b"}}, {"t"}, "hello");
+
+    for (size_t len = 0; len < encoded.size(); len++) {
+        EXPECT_FALSE(CacheCodec::decode(std::string_view(encoded).substr(0, len)).has_value()) << len;
+    }
+    EXPECT_FALSE(CacheCodec::decode(encoded + "x").has_value());
+    EXPECT_FALSE(CacheCodec::decode("{\"body\":\"hello\",\"status_code\":200}").has_value());
+}
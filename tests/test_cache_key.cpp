@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "../src/server/CacheKey.h"
+
+using namespace gateway;
+
+TEST(CacheKeyTest, NormalizesQueryAndSeparatesCredentials) {
+    CacheKeyBuilder keys;
+    RouteCachePolicy policy;
+    std::string base = CacheKeyBuilder::baseKey("GET", "/api/items");
+
+    httplib::Params a{{"page", "2"}, {"sort", "name"}};
+    httplib::Params b{{"sort", "name"}, {"page", "2"}};
+    EXPECT_EQ(CacheKeyBuilder::normalizeQuery(a), CacheKeyBuilder::normalizeQuery(b));
+    EXPECT_EQ(CacheKeyBuilder::normalizeQuery({{"q", "a&b=c"}}), "q=a%26b%3Dc");
+    EXPECT_EQ(CacheKeyBuilder::normalizeQuery({{"a", "2"}, {"b", "x"}, {"a", "1"}}), "a=2&a=1&b=x");
+    EXPECT_NE(CacheKeyBuilder::normalizeQuery({{"a", "1"}, {"a", "2"}}),
+              CacheKeyBuilder::normalizeQuery({{"a", "2"}, {"a", "1"}}));
+
+    std::string plain = keys.build(base, "", {}, policy);
+    std::string paged = keys.build(base, CacheKeyBuilder::normalizeQuery(a), {}, policy);
+    std::string alice = keys.build(base, "", {{"Authorization", "Bearer alice"}}, policy);
+    std::string bob = keys.build(base, "", {{"authorization", "Bearer bob"}}, policy);
+
+    EXPECT_EQ(plain, "GET:/api/items");
+    EXPECT_EQ(paged.rfind("GET:/api/items#", 0), 0u);
+    EXPECT_NE(paged, plain);
+    EXPECT_NE(alice, plain);
+    EXPECT_NE(alice, bob);
+}
+
+TEST(CacheKeyTest, KeysOnLearnedVaryHeaders) {
+    CacheKeyBuilder keys;
+    RouteCachePolicy policy;
+    std::string base = CacheKeyBuilder::baseKey("GET", "/api/items");
+    std::map<std::string, std::string> en{{"Accept-Language", "en"}, {"Accept-Encoding", "gzip"}};
+    std::map<std::string, std::string> de{{"Accept-Language", "de"}, {"Accept-Encoding", "gzip"}};
+
+    EXPECT_EQ(keys.build(base, "", en, policy), keys.build(base, "", de, policy));
+    EXPECT_TRUE(keys.learnVary(base, {{"Vary", "Accept-Language"}}));
+    EXPECT_NE(keys.build(base, "", en, policy), keys.build(base, "", de, policy));
+
+    // Compressed responses vary on Accept-Encoding even without Vary
+    EXPECT_TRUE(keys.learnVary(base, {{"Content-Encoding", "gzip"}}));
+    EXPECT_EQ(keys.build(base, "", en, policy), keys.build(base, "", de, policy));
+    EXPECT_NE(keys.build(base, "", en, policy), keys.build(base, "", {{"Accept-Language", "en"}}, policy));
+
+    EXPECT_FALSE(keys.learnVary(base, {{"Vary", "*"}}));
+}
+
+TEST(CacheKeyTest, FollowsRouteKeyPolicy) {
+    CacheKeyBuilder keys;
+    std::string base = CacheKeyBuilder::baseKey("GET", "/api/catalog");
+    std::string query = CacheKeyBuilder::normalizeQuery({{"utm_source", "mail"}});
+    std::map<std::string, std::string> alice{{"Authorization", "Bearer alice"}, {"X-Tenant", "a"}};
+    std::map<std::string, std::string> bob{{"Authorization", "Bearer bob"}, {"X-Tenant", "a"}};
+
+    RouteCachePolicy shared;
+    shared.key_query = false;
+    shared.key_credentials = false;
+    EXPECT_EQ(keys.build(base, query, alice, shared), base);
+    EXPECT_EQ(keys.build(base, query, alice, shared), keys.build(base, "", bob, shared));
+
+    shared.key_headers = {"x-tenant"};
+    EXPECT_EQ(keys.build(base, "", alice, shared), keys.build(base, "", bob, shared));
+    EXPECT_NE(keys.build(base, "", alice, shared), keys.build(base, "", {{"X-Tenant", "b"}}, shared));
+}
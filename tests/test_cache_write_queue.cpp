@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include "../src/cache/CacheWriteQueue.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace gateway;
+
+namespace {
+CacheWrite makeWrite(int i) {
+    return CacheWrite{"GET:/api/items/" + std::to_string(i), "v", 60, {}};
+}
+}
+
+TEST(CacheWriteQueueTest, BatchesWritesAndDropsWhenFull) {
+    std::atomic<bool> release{false};
+    std::atomic<size_t> written{0};
+    std::atomic<size_t> largest_batch{0};
+    auto metrics = std::make_shared<SimpleMetrics>();
+
+    CacheWriteQueueConfig config;
+    config.max_pending = 4;
+    config.max_batch = 3;
+    {
+        CacheWriteQueue queue([&](const std::vector<CacheWrite>& batch) {
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            written += batch.size();
+            largest_batch = std::max(largest_batch.load(), batch.size());
+        }, config, metrics);
+
+        // First write occupies the writer; the next four fill the queue
+        ASSERT_TRUE(queue.enqueue(makeWrite(0)));
+        for (int i = 0; i < 200 && queue.getStats().depth > 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        for (int i = 1; i <= 4; i++) {
+            EXPECT_TRUE(queue.enqueue(makeWrite(i)));
+        }
+        EXPECT_FALSE(queue.enqueue(makeWrite(5)));
+        EXPECT_EQ(queue.getStats().dropped, 1u);
+        EXPECT_NE(metrics->exportMetrics().find("gateway_cache_write_dropped_total 1"), std::string::npos);
+
+        release = true;
+    }   // Destructor flushes what was queued
+
+    EXPECT_EQ(written.load(), 5u);
+    EXPECT_EQ(largest_batch.load(), 3u);
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "../src/cache/Compression.h"
+
+using namespace gateway;
+
+TEST(CompressionTest, RoundTripsSupportedCodings) {
+    std::string body;
+    for (int i = 0; i < 200; i++) {
+        body += "{\"id\":" + std::to_string(i) + ",\"name\":\"item\"},";
+    }
+
+    for (const std::string coding : {"gzip", "br"}) {
+        if (!Compression::isSupported(coding)) {
+            EXPECT_FALSE(Compression::compress(coding, body).has_value());
+            continue;
+        }
+        auto compressed = Compression::compress(coding, body);
+        ASSERT_TRUE(compressed.has_value()) << coding;
+        EXPECT_LT(compressed->size(), body.size() / 4) << coding;
+
+        auto restored = Compression::decompress(coding, *compressed, body.size());
+        ASSERT_TRUE(restored.has_value()) << coding;
+        EXPECT_EQ(*restored, body);
+
+        EXPECT_FALSE(Compression::decompress(coding, *compressed, body.size() / 2).has_value()) << coding;
+        EXPECT_FALSE(Compression::decompress(coding, compressed->substr(0, compressed->size() / 2),
+                                             body.size()).has_value()) << coding;
+    }
+}
+
+TEST(CompressionTest, ParsesAcceptEncoding) {
+    EXPECT_TRUE(Compression::accepts("gzip, deflate, br", "br"));
+    EXPECT_TRUE(Compression::accepts("deflate, GZIP;q=0.5", "gzip"));
+    EXPECT_FALSE(Compression::accepts("gzip;q=0, deflate", "gzip"));
+    EXPECT_FALSE(Compression::accepts("", "gzip"));
+    EXPECT_TRUE(Compression::accepts("*", "br"));
+    EXPECT_FALSE(Compression::accepts("*, br;q=0", "br"));
+
+    EXPECT_TRUE(Compression::isCompressibleType("application/json; charset=utf-8"));
+    EXPECT_TRUE(Compression::isCompressibleType("application/problem+json"));
+    EXPECT_FALSE(Compression::isCompressibleType("image/png"));
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "../src/router/ConnectionPool.h"
+#include "../src/router/ProxyManager.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <thread>
+
+using namespace gateway;
+
+// Clients connect lazily, so these tests exercise pool bookkeeping without a backend
+static BackendEndpoint testBackend() {
+    return *BackendEndpoint::parse("http://127.0.0.1:1");
+}
+
+TEST(ConnectionPoolTest, ReusesReleasedConnection) {
+    ConnectionPool pool(testBackend(), ConnectionPoolConfig());
+
+    { auto lease = pool.acquire(1000); }
+    { auto lease = pool.acquire(1000); }
+
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.created, 1u);
+    EXPECT_EQ(stats.reused, 1u);
+    EXPECT_EQ(stats.idle, 1u);
+}
+
+TEST(ConnectionPoolTest, ConcurrentLeasesGetSeparateConnections) {
+    ConnectionPool pool(testBackend(), ConnectionPoolConfig());
+
+    {
+        auto lease1 = pool.acquire(1000);
+        auto lease2 = pool.acquire(1000);
+        EXPECT_NE(&lease1.client(), &lease2.client());
+    }
+
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.created, 2u);
+    EXPECT_EQ(stats.idle, 2u);
+}
+
+TEST(ConnectionPoolTest, DropsBrokenConnection) {
+    ConnectionPool pool(testBackend(), ConnectionPoolConfig());
+
+    {
+        auto lease = pool.acquire(1000);
+        lease.markBroken();
+    }
+
+    EXPECT_EQ(pool.getStats().idle, 0u);
+}
+
+TEST(ConnectionPoolTest, RecyclesAfterMaxRequests) {
+    ConnectionPoolConfig config;
+    config.max_requests_per_connection = 2;
+    ConnectionPool pool(testBackend(), config);
+
+    for (int i = 0; i < 4; i++) {
+        auto lease = pool.acquire(1000);
+    }
+
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.created, 2u);
+    EXPECT_EQ(stats.reused, 2u);
+}
+
+TEST(ConnectionPoolTest, RespectsMaxIdle) {
+    ConnectionPoolConfig config;
+    config.max_idle = 1;
+    ConnectionPool pool(testBackend(), config);
+
+    {
+        auto lease1 = pool.acquire(1000);
+        auto lease2 = pool.acquire(1000);
+    }
+
+    EXPECT_EQ(pool.getStats().idle, 1u);
+}
+
+TEST(ConnectionPoolTest, EvictsIdleConnectionsAboveMinIdle) {
+    ConnectionPoolConfig config;
+    config.min_idle = 1;
+    config.idle_timeout_seconds = 0;
+    ConnectionPool pool(testBackend(), config);
+
+    {
+        auto lease1 = pool.acquire(1000);
+        auto lease2 = pool.acquire(1000);
+        auto lease3 = pool.acquire(1000);
+    }
+
+    EXPECT_EQ(pool.evictIdle(), 2u);
+    EXPECT_EQ(pool.getStats().idle, 1u);
+}
+
+TEST(ConnectionPoolTest, TopsUpToMinIdleWithNewConnections) {
+    ConnectionPoolConfig config;
+    config.min_idle = 3;
+    ConnectionPool pool(testBackend(), config);
+
+    {
+        auto lease = pool.acquire(1000);
+    }
+    ASSERT_EQ(pool.idleShortfall(), 2u);
+
+    // New connections are created even while an idle one is available
+    for (size_t missing = pool.idleShortfall(); missing > 0; missing--) {
+        auto lease = pool.acquireNew(1000);
+    }
+
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.idle, 3u);
+    EXPECT_EQ(stats.created, 3u);
+    EXPECT_EQ(stats.reused, 0u);
+    EXPECT_EQ(pool.idleShortfall(), 0u);
+}
+
+TEST(ProxyManagerTest, RefusesStreamsOverTheLimit) {
+    // A backend that accepts connections and never answers
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::listen(listener, 8), 0);
+    socklen_t len = sizeof(addr);
+    ::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len);
+
+    BackendEndpoint backend = *BackendEndpoint::parse("http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)));
+    backend.id = 0;
+    ProxyManager proxy;
+    proxy.setMaxStreams(1);
+
+    std::shared_ptr<ProxyStream> first;
+    std::thread opener([&]() {
+        first = proxy.openStream("GET", backend, "/events", {}, "", 500, 500, 4096);
+    });
+    while (proxy.getOpenStreams() == 0) {
+        std::this_thread::yield();
+    }
+
+    auto second = proxy.openStream("GET", backend, "/events", {}, "", 500, 500, 4096);
+    EXPECT_FALSE(second->head().success);
+    EXPECT_EQ(second->head().status_code, 503);
+
+    // The silent backend times the first one out, which frees its slot
+    opener.join();
+    EXPECT_FALSE(first->head().success);
+    first.reset();
+    EXPECT_EQ(proxy.getOpenStreams(), 0u);
+    ::close(listener);
+}
+
+TEST(ProxyManagerTest, StripsHopByHopHeadersBeforeForwarding) {
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::listen(listener, 8), 0);
+    socklen_t len = sizeof(addr);
+    ::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len);
+
+    // Records the request head as the backend sees it
+    std::string received;
+    std::thread backend_thread([&]() {
+        int conn = ::accept(listener, nullptr, nullptr);
+        char buf[4096];
+        while (received.find("\r\n\r\n") == std::string::npos) {
+            ssize_t n = ::recv(conn, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                break;
+            }
+            received.append(buf, static_cast<size_t>(n));
+        }
+        const char reply[] = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+        ::send(conn, reply, sizeof(reply) - 1, 0);
+        ::close(conn);
+    });
+
+    BackendEndpoint backend = *BackendEndpoint::parse("http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)));
+    backend.id = 0;
+    ProxyManager proxy;
+
+    // A chunked client request reaches the handler de-chunked, framing headers still attached
+    std::map<std::string, std::string> headers{
+        {"Transfer-Encoding", "chunked"},
+        {"content-length", "999"},
+        {"host", "client.example"},
+        {"Connection", "keep-alive, X-Session-Hint"},
+        {"X-Session-Hint", "abc"},
+        {"Keep-Alive", "timeout=5"},
+        {"X-Request-ID", "42"},
+    };
+    auto response = proxy.forwardRequest("POST", backend, "/orders", headers, "hello", 2000);
+    backend_thread.join();
+    ::close(listener);
+
+    ASSERT_TRUE(response.success);
+    std::string head = received.substr(0, received.find("\r\n\r\n") + 2);
+    std::transform(head.begin(), head.end(), head.begin(), ::tolower);
+    size_t first_length = head.find("\r\ncontent-length:");
+    ASSERT_NE(first_length, std::string::npos);
+    EXPECT_EQ(head.find("\r\ncontent-length:", first_length + 1), std::string::npos);
+    EXPECT_NE(head.find("\r\ncontent-length: 5\r\n"), std::string::npos);
+    EXPECT_EQ(head.find("transfer-encoding"), std::string::npos);
+    EXPECT_EQ(head.find("client.example"), std::string::npos);
+    EXPECT_EQ(head.find("x-session-hint"), std::string::npos);
+    EXPECT_EQ(head.find("timeout=5"), std::string::npos);
+    EXPECT_NE(head.find("\r\nx-request-id: 42\r\n"), std::string::npos);
+}
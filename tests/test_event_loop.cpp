@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include "../src/server/EventLoop.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using namespace gateway;
+
+namespace {
+
+int connectTo(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    timeval timeout{2, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Reads until `responses` complete responses arrived or the peer closed
+std::string readResponses(int fd, size_t responses) {
+    std::string data;
+    char buf[4096];
+    while (true) {
+        size_t complete = 0;
+        for (size_t pos = data.find("\r\n\r\n"); pos != std::string::npos;
+             pos = data.find("\r\n\r\n", pos + 4)) {
+            complete++;
+        }
+        if (complete >= responses) {
+            return data;
+        }
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return data;
+        }
+        data.append(buf, static_cast<size_t>(n));
+    }
+}
+
+// Reads until needle arrived or the peer closed
+std::string readUntil(int fd, std::string data, const std::string& needle) {
+    char buf[4096];
+    while (data.find(needle) == std::string::npos) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            break;
+        }
+        data.append(buf, static_cast<size_t>(n));
+    }
+    return data;
+}
+
+void echo(const httplib::Request& req, httplib::Response& res) {
+    res.status = 200;
+    res.set_content(req.method + " " + req.path + " " + req.body, "text/plain");
+}
+
+class EventLoopServerTest : public ::testing::Test {
+protected:
+    void start(EventLoopConfig config, EventLoopServer::Handler handler = echo, size_t threads = 2) {
+        WorkerPoolConfig workers;
+        workers.threads = threads;
+        server_ = std::make_unique<EventLoopServer>(config, std::move(handler), workers);
+        ASSERT_TRUE(server_->bindToPort("127.0.0.1", 0));
+        ASSERT_GT(server_->port(), 0);
+        thread_ = std::thread([this]() { server_->listenAfterBind(); });
+    }
+
+    void TearDown() override {
+        if (server_) {
+            server_->stop();
+        }
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    std::unique_ptr<EventLoopServer> server_;
+    std::thread thread_;
+};
+
+} // namespace
+
+TEST_F(EventLoopServerTest, ServesPipelinedRequestsInOrder) {
+    EventLoopConfig config;
+    config.loops = 2;
+    start(config);
+
+    int fd = connectTo(server_->port());
+    ASSERT_GE(fd, 0);
+    std::string requests =
+        "POST /a HTTP/1.1\r\nHost: x\r\nContent-Length: 3\r\n\r\nabc"
+        "GET /b HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+    ASSERT_EQ(::send(fd, requests.data(), requests.size(), 0), static_cast<ssize_t>(requests.size()));
+
+    std::string data = readResponses(fd, 2);
+    size_t first = data.find("POST /a abc");
+    size_t second = data.find("GET /b ");
+    EXPECT_NE(first, std::string::npos);
+    EXPECT_NE(second, std::string::npos);
+    EXPECT_LT(first, second);
+    EXPECT_NE(data.find("Connection: keep-alive"), std::string::npos);
+    EXPECT_NE(data.find("Connection: close"), std::string::npos);
+
+    // The server closes after the Connection: close response
+    char byte;
+    EXPECT_EQ(::recv(fd, &byte, 1, 0), 0);
+    ::close(fd);
+}
+
+TEST_F(EventLoopServerTest, RejectsMalformedRequestAndConnectionsOverLimit) {
+    EventLoopConfig config;
+    config.loops = 1;
+    config.max_connections = 1;
+    start(config);
+
+    int first = connectTo(server_->port());
+    ASSERT_GE(first, 0);
+    for (int i = 0; i < 200 && server_->connections() < 1; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(server_->connections(), 1u);
+
+    // The only slot is taken
+    std::string hello = "GET / HTTP/1.1\r\n\r\n";
+    int second = connectTo(server_->port());
+    ASSERT_GE(second, 0);
+    ::send(second, hello.data(), hello.size(), MSG_NOSIGNAL);
+    EXPECT_EQ(readResponses(second, 1).rfind("HTTP/1.1 503", 0), 0u);
+    ::close(second);
+
+    std::string bad = "GET / HTTP/1.1\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    ASSERT_GT(::send(first, bad.data(), bad.size(), 0), 0);
+    EXPECT_EQ(readResponses(first, 1).rfind("HTTP/1.1 400", 0), 0u);
+    ::close(first);
+}
+
+TEST_F(EventLoopServerTest, StreamsBodyWithoutHoldingAWorker) {
+    // Body parts are fed by the test after the handler has returned
+    struct Feed {
+        std::mutex mtx;
+        std::string pending;
+        bool done = false;
+        std::function<void()> notify;
+    };
+    auto feed = std::make_shared<Feed>();
+    auto push = [feed](const std::string& data, bool done) {
+        std::function<void()> notify;
+        {
+            std::lock_guard<std::mutex> lock(feed->mtx);
+            feed->pending += data;
+            feed->done = done;
+            notify = feed->notify;
+        }
+        notify();
+    };
+
+    EventLoopConfig config;
+    config.loops = 1;
+    start(config, [feed](const httplib::Request& req, httplib::Response& res) {
+        if (req.path != "/events") {
+            echo(req, res);
+            return;
+        }
+        res.status = 200;
+        res.set_header("Content-Type", "text/event-stream");
+        StreamedBody body;
+        body.read = [feed](std::string& out) {
+            std::lock_guard<std::mutex> lock(feed->mtx);
+            out.swap(feed->pending);
+            return !feed->done;
+        };
+        body.subscribe = [feed](std::function<void()> notify) {
+            std::lock_guard<std::mutex> lock(feed->mtx);
+            feed->notify = std::move(notify);
+        };
+        EXPECT_TRUE(EventLoopServer::streamBody(std::move(body)));
+    }, 1);
+    EXPECT_FALSE(EventLoopServer::streamBody(StreamedBody()));
+
+    int fd = connectTo(server_->port());
+    ASSERT_GE(fd, 0);
+    std::string request = "GET /events HTTP/1.1\r\nHost: x\r\n\r\n";
+    ASSERT_GT(::send(fd, request.data(), request.size(), 0), 0);
+    std::string data = readUntil(fd, "", "\r\n\r\n");
+    EXPECT_EQ(data.rfind("HTTP/1.1 200", 0), 0u);
+    EXPECT_NE(data.find("Transfer-Encoding: chunked"), std::string::npos);
+    EXPECT_NE(data.find("text/event-stream"), std::string::npos);
+
+    // The only worker is free while the stream waits
+    int other = connectTo(server_->port());
+    ASSERT_GE(other, 0);
+    std::string hello = "GET /other HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+    ASSERT_GT(::send(other, hello.data(), hello.size(), 0), 0);
+    EXPECT_NE(readResponses(other, 1).find("GET /other"), std::string::npos);
+    ::close(other);
+
+    // Each part is written as it arrives, then the body is terminated
+    push("data: 1\n\n", false);
+    data = readUntil(fd, data, "data: 1\n\n\r\n");
+    EXPECT_NE(data.find("9\r\ndata: 1\n\n\r\n"), std::string::npos);
+    push("data: 2\n\n", true);
+    data = readUntil(fd, data, "0\r\n\r\n");
+    EXPECT_NE(data.find("data: 2\n\n\r\n0\r\n\r\n"), std::string::npos);
+    ::close(fd);
+}
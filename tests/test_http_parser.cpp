@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "../src/server/Request.h"
 #include "../src/server/Response.h"
+#include "../src/server/HttpParser.h"
 
 using namespace gateway;
 
@@ -73,3 +74,79 @@ TEST(ResponseBuilderTest, CreatesSuccessJson) {
 
     EXPECT_NE(success_json.find("Operation completed"), std::string::npos);
 }
+
+TEST(HttpRequestParserTest, ParsesIncrementallyAndKeepsPipelinedBytes) {
+    HttpRequestParser parser;
+    std::string input =
+        "POST /api/users%20x?q=a+b&flag HTTP/1.1\r\nHost: x\r\nContent-Length: 5\r\n\r\nhello"
+        "GET /next HTTP/1.1\r\nConnection: close\r\n\r\n";
+
+    // One byte at a time until the first request completes
+    size_t first_end = input.find("hello") + 5;
+    for (size_t i = 0; i + 1 < first_end; i++) {
+        ASSERT_EQ(parser.feed(&input[i], 1), HttpRequestParser::Status::NEED_MORE) << i;
+    }
+    ASSERT_EQ(parser.feed(&input[first_end - 1], input.size() - first_end + 1),
+              HttpRequestParser::Status::COMPLETE);
+
+    auto req = parser.take();
+    EXPECT_EQ(req.method, "POST");
+    EXPECT_EQ(req.path, "/api/users x");
+    EXPECT_EQ(req.get_param_value("q"), "a b");
+    EXPECT_TRUE(req.has_param("flag"));
+    EXPECT_EQ(req.body, "hello");
+    EXPECT_TRUE(HttpRequestParser::keepAlive(req));
+
+    ASSERT_EQ(parser.parse(), HttpRequestParser::Status::COMPLETE);
+    auto next = parser.take();
+    EXPECT_EQ(next.path, "/next");
+    EXPECT_FALSE(HttpRequestParser::keepAlive(next));
+    EXPECT_TRUE(parser.idle());
+}
+
+TEST(HttpRequestParserTest, DecodesChunkedBody) {
+    HttpRequestParser parser;
+    std::string input =
+        "PUT /x HTTP/1.1\r\nTransfer-Encoding: chunked\r\nExpect: 100-continue\r\n\r\n";
+    ASSERT_EQ(parser.feed(input.data(), input.size()), HttpRequestParser::Status::NEED_MORE);
+    EXPECT_TRUE(parser.expectsContinue());
+    EXPECT_FALSE(parser.expectsContinue());
+
+    std::string body = "4;ext=1\r\nWiki\r\n5\r\npedia\r\n0\r\nTrailer: x\r\n\r\n";
+    ASSERT_EQ(parser.feed(body.data(), body.size()), HttpRequestParser::Status::COMPLETE);
+    EXPECT_EQ(parser.take().body, "Wikipedia");
+}
+
+TEST(HttpRequestParserTest, RejectsAmbiguousOrOversizedRequests) {
+    auto status_of = [](const std::string& input, size_t max_header = 8192, size_t max_body = 1024) {
+        HttpRequestParser parser(max_header, max_body);
+        return parser.feed(input.data(), input.size()) == HttpRequestParser::Status::INVALID
+            ? parser.errorStatus() : 0;
+    };
+
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 4\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\nX-A: 1\r\n folded\r\n\r\n"), 400);
+    EXPECT_EQ(status_of("GET / HTTP/2.0\r\n\r\n"), 505);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n"), 501);
+    EXPECT_EQ(status_of("POST / HTTP/1.1\r\nContent-Length: 2048\r\n\r\n"), 413);
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\nX-Big: " + std::string(200, 'a'), 64), 431);
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\nHost: x\r\n\r\n"), 0);
+}
+
+TEST(HttpResponseWriterTest, FramesWithContentLength) {
+    httplib::Response res;
+    res.status = 200;
+    res.set_header("Content-Length", "999");
+    res.set_content("hello", "text/plain");
+
+    std::string out = HttpResponseWriter::serialize("GET", res, true);
+    EXPECT_EQ(out.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(out.find("Content-Length: 5\r\n"), std::string::npos);
+    EXPECT_EQ(out.find("999"), std::string::npos);
+    EXPECT_NE(out.find("Connection: keep-alive\r\n\r\nhello"), std::string::npos);
+
+    std::string head = HttpResponseWriter::serialize("HEAD", res, false);
+    EXPECT_NE(head.find("Content-Length: 5\r\nConnection: close\r\n\r\n"), std::string::npos);
+    EXPECT_EQ(head.find("hello"), std::string::npos);
+}
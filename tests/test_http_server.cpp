@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "../src/server/HttpServer.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+
+using namespace gateway;
+
+namespace {
+
+int listenOnLoopback(int& port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    ::listen(fd, 16);
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+int freePort() {
+    int port = 0;
+    ::close(listenOnLoopback(port));
+    return port;
+}
+
+} // namespace
+
+// Drives handleRequest through a real listener against a backend that
+// answers every request with a fixed 503
+class HttpServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        backend_fd = listenOnLoopback(backend_port);
+        backend_thread = std::thread([this]() {
+            while (true) {
+                int conn = ::accept(backend_fd, nullptr, nullptr);
+                if (conn < 0 || stopping) {
+                    if (conn >= 0) {
+                        ::close(conn);
+                    }
+                    return;
+                }
+                char buf[4096];
+                ::recv(conn, buf, sizeof(buf), 0);
+                backend_hits++;
+                const char reply[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                                     "Content-Type: text/plain\r\nContent-Length: 4\r\n"
+                                     "Connection: close\r\n\r\ndown";
+                ::send(conn, reply, sizeof(reply) - 1, 0);
+                ::close(conn);
+            }
+        });
+
+        auto router = std::make_shared<Router>();
+        router->loadRoutes(R"({"routes": [{"path": "/api/items", "backend": "http://127.0.0.1:)" +
+                           std::to_string(backend_port) + R"(", "cache": {"ttl": 60}}]})");
+
+        port = freePort();
+        server = std::make_unique<HttpServer>("127.0.0.1", port);
+        server->initialize(std::make_shared<JWTManager>("test-secret-that-is-at-least-32-bytes-long"),
+                           std::make_shared<RateLimiter>(), router,
+                           std::make_shared<SecurityValidator>(),
+                           std::make_shared<Logger>("/tmp/gateway-http-server-test.log", 1048576, 1, false),
+                           std::make_shared<ProxyManager>());
+    }
+
+    void TearDown() override {
+        if (server_thread.joinable()) {
+            server->stop();
+            server_thread.join();
+        }
+        stopping = true;
+        ::shutdown(backend_fd, SHUT_RDWR);
+        ::close(backend_fd);
+        backend_thread.join();
+    }
+
+    void start() {
+        server_thread = std::thread([this]() { server->start(); });
+        server->getInternalServer().wait_until_ready();
+    }
+
+    int backend_fd = -1;
+    int backend_port = 0;
+    std::atomic<int> backend_hits{0};
+    std::atomic<bool> stopping{false};
+    std::thread backend_thread;
+
+    int port = 0;
+    std::unique_ptr<HttpServer> server;
+    std::thread server_thread;
+};
+
+TEST_F(HttpServerTest, ServesStaleCopyWhenBackendAnswers5xx) {
+    server->setCache(
+        [](const std::string&) -> std::optional<HttpServer::CachedResponse> {
+            HttpServer::CachedResponse stale;
+            stale.body = "cached";
+            stale.content_type = "text/plain";
+            stale.status_code = 200;
+            stale.stale_ms = 5000;
+            return stale;
+        },
+        [](const std::string&, const HttpServer::CachedResponse&, int, int) {});
+    server->setCacheStaleness(0, 300);
+    start();
+
+    httplib::Client client("127.0.0.1", port);
+    auto res = client.Get("/api/items");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(backend_hits.load(), 1);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(res->body, "cached");
+    EXPECT_EQ(res->get_header_value("X-Cache"), "STALE");
+}
+
+TEST_F(HttpServerTest, PassesBackend5xxThroughWithoutStaleCopy) {
+    server->setCache([](const std::string&) { return std::optional<HttpServer::CachedResponse>(); },
+                     [](const std::string&, const HttpServer::CachedResponse&, int, int) {});
+    server->setCacheStaleness(0, 300);
+    start();
+
+    httplib::Client client("127.0.0.1", port);
+    auto res = client.Get("/api/items");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 503);
+    EXPECT_EQ(res->body, "down");
+}
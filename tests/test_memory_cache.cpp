@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "../src/cache/MemoryCache.h"
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace gateway;
+
+TEST(MemoryCacheTest, StoresAndReturnsEntries) {
+    MemoryCache cache(1024 * 1024, 4);
+    cache.set("GET:/api/users", {"[1,2,3]", "application/json", 200}, 60);
+
+    auto hit = cache.get("GET:/api/users");
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(hit->body, "[1,2,3]");
+    EXPECT_EQ(hit->status_code, 200);
+    EXPECT_EQ(cache.get("GET:/api/other"), nullptr);
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+}
+
+TEST(MemoryCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+    // One shard so the budget is easy to reason about
+    MemoryCache cache(4096, 1);
+    std::string body(900, 'x');
+
+    cache.set("a", {body, "text/plain", 200}, 60);
+    cache.set("b", {body, "text/plain", 200}, 60);
+    cache.set("c", {body, "text/plain", 200}, 60);
+    ASSERT_NE(cache.get("a"), nullptr);   // a is now most recently used
+
+    cache.set("d", {body, "text/plain", 200}, 60);
+
+    EXPECT_NE(cache.get("a"), nullptr);
+    EXPECT_EQ(cache.get("b"), nullptr);
+    EXPECT_LE(cache.getStats().bytes, 4096u);
+    EXPECT_GE(cache.getStats().evictions, 1u);
+}
+
+TEST(MemoryCacheTest, HonorsTtlAndSizeLimit) {
+    MemoryCache cache(1024 * 1024, 4, 1000);
+    cache.set("short", {"v", "text/plain", 200}, 1);
+    cache.set("huge", {std::string(2000, 'x'), "text/plain", 200}, 60);
+
+    EXPECT_NE(cache.get("short"), nullptr);
+    EXPECT_EQ(cache.get("huge"), nullptr);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_EQ(cache.get("short"), nullptr);
+}
+
+TEST(MemoryCacheTest, InvalidatesByPattern) {
+    MemoryCache cache(1024 * 1024, 4);
+    cache.set("GET:/api/users/1", {"1", "application/json", 200}, 60);
+    cache.set("GET:/api/users/2", {"2", "application/json", 200}, 60);
+    cache.set("GET:/api/orders/1", {"3", "application/json", 200}, 60);
+
+    EXPECT_EQ(cache.invalidatePattern("GET:/api/users/*"), 2u);
+    EXPECT_EQ(cache.get("GET:/api/users/1"), nullptr);
+    EXPECT_NE(cache.get("GET:/api/orders/1"), nullptr);
+}
+
+TEST(MemoryCacheTest, KeepsStaleCopyForGracePeriod) {
+    MemoryCache cache(1024 * 1024, 4);
+    cache.set("swr", {"v", "text/plain", 200}, 1, 1);
+    cache.set("plain", {"v", "text/plain", 200}, 1);
+
+    auto fresh = cache.get("swr");
+    ASSERT_NE(fresh, nullptr);
+    EXPECT_EQ(fresh->staleForMs(), 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    auto stale = cache.get("swr");
+    ASSERT_NE(stale, nullptr);
+    EXPECT_GT(stale->staleForMs(), 0);
+    EXPECT_EQ(cache.get("plain"), nullptr);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    EXPECT_EQ(cache.get("swr"), nullptr);
+}
+
+TEST(MemoryCacheTest, InvalidatesByTag) {
+    MemoryCache cache(1024 * 1024, 4);
+    cache.set("GET:/api/users/1", {"1", "application/json", 200, {}, {"route:/api/users/*", "key:user-1"}}, 60);
+    cache.set("GET:/api/users/2", {"2", "application/json", 200, {}, {"route:/api/users/*"}}, 60);
+    cache.set("GET:/api/orders/1", {"3", "application/json", 200, {}, {"key:user-1"}}, 60);
+
+    EXPECT_EQ(cache.invalidateTag("key:user-1"), 2u);
+    EXPECT_EQ(cache.get("GET:/api/orders/1"), nullptr);
+    EXPECT_NE(cache.get("GET:/api/users/2"), nullptr);
+
+    // Rewriting an entry drops its old tags
+    cache.set("GET:/api/users/2", {"2", "application/json", 200}, 60);
+    EXPECT_EQ(cache.invalidateTag("route:/api/users/*"), 0u);
+    EXPECT_NE(cache.get("GET:/api/users/2"), nullptr);
+    EXPECT_EQ(cache.invalidateTag("missing"), 0u);
+}
@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 #include "../src/rate_limiter/RateLimiter.h"
+#include "../src/rate_limiter/LeasedRateLimiter.h"
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <vector>
+#include <map>
+#include <mutex>
 
 using namespace gateway;
 
@@ -111,3 +116,200 @@ TEST_F(RateLimiterTest, ResetBucketWorks) {
     auto [allowed2, __] = rate_limiter->allowRequest("127.0.0.1", "/api/test");
     EXPECT_TRUE(allowed2);
 }
+
+TEST(BucketStoreTest, GrowsAndKeepsBucketsSeparate) {
+    BucketStore store(4);
+
+    // Enough keys to force every shard to rehash several times
+    for (int i = 0; i < 2000; i++) {
+        auto result = store.consume("10.0.0." + std::to_string(i), 2, 0, 1);
+        EXPECT_TRUE(result.allowed);
+    }
+    EXPECT_EQ(store.size(), 2000u);
+
+    for (int i = 0; i < 2000; i++) {
+        EXPECT_DOUBLE_EQ(store.peek("10.0.0." + std::to_string(i)), 1.0);
+    }
+
+    store.erase("10.0.0.7");
+    EXPECT_LT(store.peek("10.0.0.7"), 0);
+    EXPECT_EQ(store.size(), 1999u);
+    EXPECT_EQ(store.evictIdle(3600), 0u);
+}
+
+TEST(BucketStoreTest, ConcurrentConsumeNeverOverspends) {
+    BucketStore store;
+    std::atomic<int> allowed{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&store, &allowed]() {
+            for (int i = 0; i < 500; i++) {
+                if (store.consume("shared", 1000, 0, 1).allowed) {
+                    allowed++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(allowed.load(), 1000);
+}
+
+TEST(BucketStoreTest, EvictionNeverRemovesBucketsInUse) {
+    BucketStore store;
+    std::atomic<bool> stop{false};
+
+    // Buckets refilled while the sweep walks the shards must not look idle
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&store, &stop, t]() {
+            while (!stop) {
+                for (int i = 0; i < 256; i++) {
+                    store.consume("10." + std::to_string(t) + ".0." + std::to_string(i), 1e6, 1e6, 1);
+                }
+            }
+        });
+    }
+
+    size_t evicted = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    while (std::chrono::steady_clock::now() < deadline) {
+        evicted += store.evictIdle(3600);
+    }
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(evicted, 0u);
+}
+
+TEST(AtomicTokenBucketTest, FixedPointRefill) {
+    AtomicTokenBucket bucket(2, 1000);
+
+    EXPECT_TRUE(bucket.consume(2, 1, 2, 1000).allowed);
+    auto refused = bucket.consume(2, 1, 1, 1000);
+    EXPECT_FALSE(refused.allowed);
+    EXPECT_EQ(refused.retry_after, 1);
+
+    EXPECT_FALSE(bucket.consume(2, 1, 1, 1500).allowed);
+    EXPECT_TRUE(bucket.consume(2, 1, 1, 2000).allowed);
+
+    // One token a minute, polled every millisecond: fractions must still add up
+    AtomicTokenBucket slow(1, 0);
+    EXPECT_TRUE(slow.consume(1, 1.0 / 60, 1, 0).allowed);
+    bool allowed = false;
+    uint32_t t = 0;
+    while (!allowed && t < 120000) {
+        t++;
+        allowed = slow.consume(1, 1.0 / 60, 1, t).allowed;
+    }
+    EXPECT_TRUE(allowed);
+    EXPECT_NEAR(t, 60000, 100);
+}
+
+TEST(AtomicTokenBucketTest, SurvivesClockWrap) {
+    uint32_t before_wrap = UINT32_MAX - 500;
+    AtomicTokenBucket bucket(1, before_wrap);
+
+    EXPECT_TRUE(bucket.consume(1, 1, 1, before_wrap).allowed);
+    EXPECT_FALSE(bucket.consume(1, 1, 1, before_wrap + 400).allowed);
+    EXPECT_TRUE(bucket.consume(1, 1, 1, before_wrap + 1001).allowed);  // wrapped to 500
+}
+
+// Stands in for the Redis counters shared by several gateway nodes
+struct FakeLeaseServer {
+    std::mutex mtx;
+    std::map<std::string, int> used;
+    std::atomic<int> calls{0};
+
+    LeasedRateLimiter::LeaseFn leaseFn() {
+        return [this](const std::vector<RedisRateLimitTier>& tiers, const std::vector<int>& wanted) {
+            std::lock_guard<std::mutex> lock(mtx);
+            calls++;
+            std::vector<RedisLeaseGrant> grants;
+            for (size_t i = 0; i < tiers.size(); i++) {
+                if (wanted[i] < 0) {
+                    used[tiers[i].key] += wanted[i];
+                    grants.push_back({0, 0});
+                    continue;
+                }
+                int granted = std::max(0, std::min(wanted[i], tiers[i].max_requests - used[tiers[i].key]));
+                used[tiers[i].key] += granted;
+                grants.push_back({granted, granted > 0 ? 0 : 60000});
+            }
+            return grants;
+        };
+    }
+};
+
+TEST(LeasedRateLimiterTest, ServesMostRequestsLocally) {
+    FakeLeaseServer server;
+    RedisRateLimits limits;
+    limits.global = RedisRateLimits::Limit{100000, 60};
+    LeasedRateLimiter limiter(server.leaseFn(), limits);
+
+    for (int i = 0; i < 2000; i++) {
+        EXPECT_TRUE(limiter.allowRequest("10.0.0.1", "/api/test").first);
+    }
+
+    EXPECT_LT(server.calls.load(), 200);
+    EXPECT_GT(limiter.getStats().local_hits, 1800u);
+}
+
+TEST(LeasedRateLimiterTest, NodesTogetherStayWithinLimit) {
+    FakeLeaseServer server;
+    RedisRateLimits limits;
+    limits.global = RedisRateLimits::Limit{100, 60};
+    LeasedRateLimiter node_a(server.leaseFn(), limits);
+    LeasedRateLimiter node_b(server.leaseFn(), limits);
+
+    int allowed = 0;
+    for (int i = 0; i < 200; i++) {
+        allowed += node_a.allowRequest("10.0.0.1", "/api/test").first ? 1 : 0;
+        allowed += node_b.allowRequest("10.0.0.2", "/api/test").first ? 1 : 0;
+    }
+
+    // Never over the limit; at most one lease per node left stranded
+    EXPECT_LE(allowed, 100);
+    EXPECT_GE(allowed, 80);
+
+    auto [ok, retry_after] = node_a.allowRequest("10.0.0.1", "/api/test");
+    EXPECT_FALSE(ok);
+    EXPECT_GT(retry_after, 0);
+}
+
+TEST(LeasedRateLimiterTest, SlowKeyIsChargedOnlyForWhatItUses) {
+    FakeLeaseServer server;
+    RedisRateLimits limits;
+    limits.per_ip = RedisRateLimits::Limit{1000, 60};
+    TokenLeaseConfig config;
+    config.lease_ttl_ms = 50;
+
+    {
+        LeasedRateLimiter limiter(server.leaseFn(), limits, config);
+        for (int i = 0; i < 5; i++) {
+            EXPECT_TRUE(limiter.allowRequest("10.0.0.1", "/api/test").first);
+            std::this_thread::sleep_for(std::chrono::milliseconds(120));
+        }
+
+        // Every lease outlived its use; the unused part goes back
+        int charged = 0;
+        for (int i = 0; i < 100; i++) {
+            {
+                std::lock_guard<std::mutex> lock(server.mtx);
+                charged = server.used["ip:10.0.0.1"];
+            }
+            if (charged == 5) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        EXPECT_EQ(charged, 5);
+    }
+    std::lock_guard<std::mutex> lock(server.mtx);
+    EXPECT_EQ(server.used["ip:10.0.0.1"], 5);
+}
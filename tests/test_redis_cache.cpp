@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "../src/cache/RedisCache.h"
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace gateway;
+
+// Runs against a live server: REDIS_TEST_URI (default tcp://127.0.0.1:6379).
+// Tests are skipped when no server is reachable.
+class RedisCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const char* env = std::getenv("REDIS_TEST_URI");
+        uri = env ? env : "tcp://127.0.0.1:6379";
+        try {
+            cache = std::make_unique<RedisCache>(uri, "", "cache-test:");
+        } catch (const std::exception& e) {
+            GTEST_SKIP() << "Redis not reachable at " << uri << ": " << e.what();
+        }
+        cache->clear();
+    }
+
+    void TearDown() override {
+        if (cache) {
+            cache->clear();
+        }
+    }
+
+    static RedisCache::CachedResponse tagged(const std::string& tag) {
+        RedisCache::CachedResponse response;
+        response.body = "{}";
+        response.content_type = "application/json";
+        response.status_code = 200;
+        response.cached_at = 0;
+        response.tags = {tag};
+        return response;
+    }
+
+    std::string uri;
+    std::unique_ptr<RedisCache> cache;
+};
+
+TEST_F(RedisCacheTest, ShortEntryDoesNotShortenTagIndex) {
+    cache->set("GET:/api/users", tagged("route:/api/users/*"), 60);
+    // A negative entry expiring first must not take the tag set with it
+    cache->set("GET:/api/users/missing", tagged("route:/api/users/*"), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+
+    EXPECT_EQ(cache->invalidateTag("route:/api/users/*"), 1);
+    EXPECT_FALSE(cache->get("GET:/api/users").has_value());
+}
+
+TEST_F(RedisCacheTest, TagsStillIndexedAfterScriptFlush) {
+    // What a Redis restart does to the script cache
+    sw::redis::Redis(uri).script_flush();
+    cache->set("GET:/api/orders", tagged("route:/api/orders/*"), 60);
+
+    EXPECT_EQ(cache->invalidateTag("route:/api/orders/*"), 1);
+    EXPECT_FALSE(cache->get("GET:/api/orders").has_value());
+}
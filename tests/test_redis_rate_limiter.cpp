@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "../src/rate_limiter/RedisRateLimiter.h"
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace gateway;
+
+// Runs against a live server: REDIS_TEST_URI (default tcp://127.0.0.1:6379).
+// Tests are skipped when no server is reachable.
+class RedisRateLimiterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const char* env = std::getenv("REDIS_TEST_URI");
+        uri = env ? env : "tcp://127.0.0.1:6379";
+        try {
+            limiter = std::make_unique<RedisRateLimiter>(uri, "", "ratelimit-test:");
+        } catch (const std::exception& e) {
+            GTEST_SKIP() << "Redis not reachable at " << uri << ": " << e.what();
+        }
+
+        key = std::string(::testing::UnitTest::GetInstance()->current_test_info()->name());
+        limiter->resetKey(key);
+    }
+
+    void TearDown() override {
+        if (limiter) {
+            limiter->resetKey(key);
+        }
+    }
+
+    std::string uri;
+    std::string key;
+    std::unique_ptr<RedisRateLimiter> limiter;
+};
+
+TEST_F(RedisRateLimiterTest, WindowCounterAllowsUpToLimit) {
+    for (int i = 0; i < 5; i++) {
+        EXPECT_TRUE(limiter->allowRequest(key, 5, 60)) << "Request " << i << " should be allowed";
+    }
+    EXPECT_FALSE(limiter->allowRequest(key, 5, 60));
+}
+
+TEST_F(RedisRateLimiterTest, RejectedRequestsAreNotCounted) {
+    for (int i = 0; i < 20; i++) {
+        limiter->allowRequest(key, 3, 60);
+    }
+    EXPECT_EQ(limiter->getCurrentCount(key, 60), 3);
+}
+
+TEST_F(RedisRateLimiterTest, ReloadsScriptAfterFlush) {
+    EXPECT_TRUE(limiter->allowRequest(key, 5, 60));
+
+    sw::redis::Redis admin(uri);
+    admin.script_flush();
+
+    EXPECT_TRUE(limiter->allowRequest(key, 5, 60));
+    EXPECT_EQ(limiter->getCurrentCount(key, 60), 2);
+}
+
+TEST_F(RedisRateLimiterTest, BatchedTiersCountOnlyWhenAllAllow) {
+    std::string tight = key + ":tight";
+    limiter->resetKey(tight);
+
+    std::vector<RedisRateLimitTier> tiers = {{key, 100, 60}, {tight, 2, 60}};
+    EXPECT_TRUE(limiter->allowRequests(tiers).first);
+    EXPECT_TRUE(limiter->allowRequests(tiers).first);
+
+    auto [allowed, retry_after] = limiter->allowRequests(tiers);
+    EXPECT_FALSE(allowed);
+    EXPECT_GT(retry_after, 0);
+
+    // The rejected request was not charged to the looser tier
+    EXPECT_EQ(limiter->getCurrentCount(key, 60), 2);
+    limiter->resetKey(tight);
+}
+
+TEST_F(RedisRateLimiterTest, SlidingLogStillAvailable) {
+    RedisRateLimiter log_limiter(uri, "", "ratelimit-test:", RedisRateLimitAlgorithm::SLIDING_LOG);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(log_limiter.allowRequest(key, 3, 60));
+    }
+    EXPECT_FALSE(log_limiter.allowRequest(key, 3, 60));
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include "../src/server/RefreshQueue.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace gateway;
+
+TEST(RefreshQueueTest, RunsOneJobPerPendingKey) {
+    RefreshQueue queue(8);
+    std::atomic<bool> release{false};
+    std::atomic<int> runs{0};
+
+    auto job = [&]() {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        runs++;
+    };
+
+    EXPECT_TRUE(queue.submit("GET:/api/hot", job));
+    EXPECT_FALSE(queue.submit("GET:/api/hot", job));
+    EXPECT_TRUE(queue.submit("GET:/api/other", job));
+    EXPECT_EQ(queue.pending(), 2u);
+
+    release = true;
+    for (int i = 0; i < 200 && queue.pending() > 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(runs.load(), 2);
+    EXPECT_EQ(queue.pending(), 0u);
+
+    // Key can be refreshed again once its job finished
+    EXPECT_TRUE(queue.submit("GET:/api/hot", job));
+}
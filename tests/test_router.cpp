@@ -1,5 +1,7 @@
 #include "../src/router/Router.h"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
 
 using namespace gateway;
 
@@ -106,7 +108,7 @@ TEST_F(RouterTest, RoundRobinLoadBalancing) {
   for (int i = 0; i < 6; i++) {
     auto match = router->matchRoute("/api/test");
     ASSERT_TRUE(match.has_value());
-    backends.push_back(match->backend_url);
+    backends.emplace_back(match->backend_url);
   }
 
   // Should cycle through backends
@@ -114,3 +116,275 @@ TEST_F(RouterTest, RoundRobinLoadBalancing) {
   EXPECT_EQ(backends[1], backends[4]);
   EXPECT_EQ(backends[2], backends[5]);
 }
+
+TEST_F(RouterTest, ParsesBackendEndpoint) {
+  auto endpoint = BackendEndpoint::parse("https://api.internal:8443/v1");
+  ASSERT_TRUE(endpoint.has_value());
+  EXPECT_EQ(endpoint->scheme, "https");
+  EXPECT_EQ(endpoint->host, "api.internal");
+  EXPECT_EQ(endpoint->port, 8443);
+  EXPECT_EQ(endpoint->origin(), "https://api.internal:8443");
+
+  auto defaulted = BackendEndpoint::parse("http://[::1]");
+  ASSERT_TRUE(defaulted.has_value());
+  EXPECT_EQ(defaulted->host, "::1");
+  EXPECT_EQ(defaulted->port, 80);
+
+  EXPECT_FALSE(BackendEndpoint::parse("http://localhost:notaport").has_value());
+  EXPECT_FALSE(BackendEndpoint::parse("ftp://localhost").has_value());
+}
+
+TEST_F(RouterTest, SharesBackendIdAcrossRoutes) {
+  Route users;
+  users.path_pattern = "/api/users";
+  users.backends = {"http://127.0.0.1:3001", "http://127.0.0.1:3002"};
+  router->addRoute(users);
+
+  Route orders;
+  orders.path_pattern = "/api/orders";
+  orders.backends = {"http://127.0.0.1:3002"};
+  router->addRoute(orders);
+
+  auto match = router->matchRoute("/api/orders");
+  ASSERT_TRUE(match.has_value());
+  ASSERT_NE(match->backend, nullptr);
+  EXPECT_EQ(match->backend->resolved_ip, "127.0.0.1");
+  EXPECT_EQ(match->backend_id, match->backend->id);
+
+  auto backends = router->getAllBackends();
+  ASSERT_EQ(backends.size(), 2u);
+  EXPECT_EQ(backends[1]->id, match->backend_id);
+  EXPECT_EQ(backends[1]->url, "http://127.0.0.1:3002");
+}
+
+TEST_F(RouterTest, TrailingWildcardRespectsSegmentBoundary) {
+  Route route;
+  route.path_pattern = "/api/users/*";
+  route.backends.push_back("http://localhost:3000");
+  router->addRoute(route);
+
+  EXPECT_TRUE(router->matchRoute("/api/users").has_value());
+  EXPECT_TRUE(router->matchRoute("/api/users/").has_value());
+  EXPECT_TRUE(router->matchRoute("/api/users/1/orders").has_value());
+  EXPECT_FALSE(router->matchRoute("/api/usersx").has_value());
+  EXPECT_FALSE(router->matchRoute("/api/user").has_value());
+}
+
+TEST_F(RouterTest, InnerWildcardAndLoadOrderPriority) {
+  Route files;
+  files.path_pattern = "/files/*.json";
+  files.backends.push_back("http://localhost:3001");
+  router->addRoute(files);
+
+  Route catch_all;
+  catch_all.path_pattern = "/*";
+  catch_all.backends.push_back("http://localhost:3002");
+  router->addRoute(catch_all);
+
+  Route shadowed;
+  shadowed.path_pattern = "/files/a.json";
+  shadowed.backends.push_back("http://localhost:3003");
+  router->addRoute(shadowed);
+
+  auto json_match = router->matchRoute("/files/a/b.json");
+  ASSERT_TRUE(json_match.has_value());
+  EXPECT_EQ(json_match->route->path_pattern, "/files/*.json");
+
+  // Earlier routes win even when a later one is more specific
+  auto exact_match = router->matchRoute("/files/a.json");
+  ASSERT_TRUE(exact_match.has_value());
+  EXPECT_EQ(exact_match->route->path_pattern, "/files/*.json");
+
+  auto other = router->matchRoute("/files/a.xml");
+  ASSERT_TRUE(other.has_value());
+  EXPECT_EQ(other->route->path_pattern, "/*");
+}
+
+TEST_F(RouterTest, LeastConnPicksIdlestBackend) {
+  Route route;
+  route.path_pattern = "/api/test";
+  route.backends = {"http://127.0.0.1:3001", "http://127.0.0.1:3002",
+                    "http://127.0.0.1:3003"};
+  route.load_balancing = "least_conn";
+  router->addRoute(route);
+
+  auto backends = router->getAllBackends();
+  ASSERT_EQ(backends.size(), 3u);
+  int idle_id = backends[1]->id;
+  router->setInFlightProvider(
+      [idle_id](int backend_id) { return backend_id == idle_id ? 0 : 5; });
+
+  for (int i = 0; i < 6; i++) {
+    auto match = router->matchRoute("/api/test");
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->backend_id, idle_id);
+  }
+}
+
+TEST_F(RouterTest, RoundRobinIsEvenUnderConcurrency) {
+  Route route;
+  route.path_pattern = "/api/test";
+  route.backends = {"http://127.0.0.1:3001", "http://127.0.0.1:3002"};
+  route.load_balancing = "round_robin";
+  router->addRoute(route);
+
+  std::atomic<int> first_backend{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([this, &first_backend]() {
+      for (int i = 0; i < 1000; i++) {
+        auto match = router->matchRoute("/api/test");
+        if (match && match->backend_url == "http://127.0.0.1:3001") {
+          first_backend++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(first_backend.load(), 2000);
+}
+
+TEST_F(RouterTest, ReplaceRoutesKeepsOldMatchValid) {
+  router->loadRoutes(R"({"routes": [{"path": "/api/old/*", "backend": "http://127.0.0.1:3001"}]})");
+
+  auto old_match = router->matchRoute("/api/old/1");
+  ASSERT_TRUE(old_match.has_value());
+
+  int count = router->replaceRoutes(
+      R"({"routes": [{"path": "/api/new/*", "backend": "http://127.0.0.1:3002"}]})");
+  EXPECT_EQ(count, 1);
+
+  // The earlier match still points into the table it was made against
+  EXPECT_EQ(old_match->route->path_pattern, "/api/old/*");
+  EXPECT_EQ(old_match->backend_url, "http://127.0.0.1:3001");
+
+  EXPECT_FALSE(router->matchRoute("/api/old/1").has_value());
+  EXPECT_TRUE(router->matchRoute("/api/new/1").has_value());
+
+  // Invalid config leaves the current table in place
+  EXPECT_EQ(router->replaceRoutes("{\"not_routes\": []}"), -1);
+  EXPECT_TRUE(router->matchRoute("/api/new/1").has_value());
+}
+
+TEST_F(RouterTest, ConcurrentMatchDuringReload) {
+  const std::string table_a = R"({"routes": [{"path": "/api/*", "backend": "http://127.0.0.1:3001"}]})";
+  const std::string table_b = R"({"routes": [{"path": "/api/*", "backend": "http://127.0.0.1:3002"}]})";
+  router->replaceRoutes(table_a);
+
+  std::atomic<bool> running{true};
+  std::atomic<int> misses{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([this, &running, &misses]() {
+      while (running) {
+        auto match = router->matchRoute("/api/users");
+        if (!match || match->route->path_pattern != "/api/*") {
+          misses++;
+        }
+      }
+    });
+  }
+
+  for (int i = 0; i < 200; i++) {
+    router->replaceRoutes(i % 2 ? table_a : table_b);
+  }
+  running = false;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(misses.load(), 0);
+}
+
+TEST_F(RouterTest, CompilesRouteCachePolicy) {
+  RouteCachePolicy defaults;
+  defaults.ttl_seconds = 300;
+  defaults.statuses.set(404);
+  router->setCacheDefaults(defaults, {"/api/auth/*"});
+
+  std::string routes_json = R"({
+        "routes": [
+            {"path": "/api/items/*", "backend": "http://localhost:3000"},
+            {
+                "path": "/api/catalog/*",
+                "backend": "http://localhost:3000",
+                "cache": {
+                    "ttl": 60,
+                    "statuses": [200, 301],
+                    "max_entry_size": 1024,
+                    "key": {"query": false, "headers": ["Accept-Language"]}
+                }
+            },
+            {"path": "/api/auth/*", "backend": "http://localhost:3001"},
+            {"path": "/api/live/*", "backend": "http://localhost:3000", "cache": false,
+             "event_stream": true},
+            {"path": "/api/files/*", "backend": "http://localhost:3000", "stream": true,
+             "stream_idle_timeout": 300000, "cache": true}
+        ]
+    })";
+  ASSERT_EQ(router->loadRoutes(routes_json), 5);
+
+  const RouteCachePolicy& items = router->matchRoute("/api/items/1")->route->cache;
+  EXPECT_TRUE(items.enabled);
+  EXPECT_EQ(items.ttl_seconds, 300);
+  EXPECT_TRUE(items.cacheable(404, 10));
+  EXPECT_FALSE(items.cacheable(500, 10));
+
+  const RouteCachePolicy& catalog = router->matchRoute("/api/catalog/1")->route->cache;
+  EXPECT_EQ(catalog.ttl_seconds, 60);
+  EXPECT_TRUE(catalog.cacheable(301, 1024));
+  EXPECT_FALSE(catalog.cacheable(404, 10));
+  EXPECT_FALSE(catalog.cacheable(200, 1025));
+  EXPECT_FALSE(catalog.key_query);
+  EXPECT_TRUE(catalog.key_credentials);
+  EXPECT_EQ(catalog.key_headers, std::vector<std::string>{"accept-language"});
+
+  EXPECT_FALSE(router->matchRoute("/api/auth/login")->route->cache.enabled);
+  EXPECT_FALSE(router->matchRoute("/api/live/1")->route->cache.enabled);
+  EXPECT_TRUE(router->matchRoute("/api/live/1")->route->event_stream);
+  EXPECT_FALSE(router->matchRoute("/api/items/1")->route->event_stream);
+  EXPECT_EQ(router->getRoutesJSON()[3]["event_stream"], true);
+  EXPECT_EQ(router->getRoutesJSON()[1]["cache"]["ttl"], 60);
+
+  // Streamed bodies are never held whole, so they are never cached
+  const Route& files = *router->matchRoute("/api/files/big.iso")->route;
+  EXPECT_TRUE(files.stream);
+  EXPECT_EQ(files.stream_idle_timeout_ms, 300000);
+  EXPECT_FALSE(files.cache.enabled);
+  EXPECT_EQ(router->getRoutesJSON()[4]["stream"], true);
+  EXPECT_EQ(router->getRoutesJSON()[4]["stream_idle_timeout"], 300000);
+}
+
+TEST_F(RouterTest, NegativeCachePolicyAndMissMemo) {
+  RouteCachePolicy defaults;
+  defaults.negative_ttl_seconds = 10;
+  RouteCachePolicy::assignStatuses(defaults.negative_statuses, {404, 503});
+  router->setCacheDefaults(defaults);
+  router->setMissCacheSize(16);
+
+  ASSERT_EQ(router->loadRoutes(R"({"routes": [
+        {"path": "/api/items/*", "backend": "http://localhost:3000",
+         "cache": {"statuses": [200, 404], "negative": {"ttl": 5, "statuses": [404]}}},
+        {"path": "/api/live/*", "backend": "http://localhost:3000", "cache": {"negative": false}}
+    ]})"), 2);
+
+  const RouteCachePolicy& items = router->matchRoute("/api/items/1")->route->cache;
+  EXPECT_EQ(items.ttlFor(200, 10), 300);
+  EXPECT_EQ(items.ttlFor(404, 10), 5);    // Negative TTL wins over statuses
+  EXPECT_EQ(items.ttlFor(503, 10), 0);
+
+  const RouteCachePolicy& live = router->matchRoute("/api/live/1")->route->cache;
+  EXPECT_FALSE(live.isNegative(404));
+
+  // A remembered miss is forgotten once the routes change
+  EXPECT_FALSE(router->matchRoute("/wp-login.php").has_value());
+  EXPECT_FALSE(router->matchRoute("/wp-login.php").has_value());
+  Route route;
+  route.path_pattern = "/wp-login.php";
+  route.backends.push_back("http://localhost:3000");
+  router->addRoute(route);
+  EXPECT_TRUE(router->matchRoute("/wp-login.php").has_value());
+}
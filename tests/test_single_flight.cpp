@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "../src/server/SingleFlight.h"
+#include <atomic>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace gateway;
+
+namespace {
+ProxyResponse okResponse(const std::string& body) {
+    ProxyResponse response;
+    response.success = true;
+    response.status_code = 200;
+    response.body = body;
+    return response;
+}
+}
+
+TEST(SingleFlightTest, ConcurrentCallersShareOneFetch) {
+    SingleFlight flight;
+    std::atomic<int> fetches{0};
+    std::atomic<int> shared{0};
+    std::atomic<int> ok{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&]() {
+            auto result = flight.run("GET:/api/hot", 2000, [&]() {
+                fetches++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                return okResponse("hot");
+            });
+            if (result.response && result.response->body == "hot") {
+                ok++;
+            }
+            if (result.shared) {
+                shared++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(fetches.load(), 1);
+    EXPECT_EQ(ok.load(), 8);
+    EXPECT_EQ(shared.load(), 7);
+    EXPECT_EQ(flight.inFlight(), 0u);
+}
+
+TEST(SingleFlightTest, WaitersTimeOutAndLaterCallsFetchAgain) {
+    SingleFlight flight;
+    std::thread leader([&]() {
+        flight.run("GET:/api/slow", 1000, []() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            return okResponse("slow");
+        });
+    });
+
+    while (flight.inFlight() == 0) {
+        std::this_thread::yield();
+    }
+    auto waiter = flight.run("GET:/api/slow", 50, []() { return okResponse("unused"); });
+    EXPECT_EQ(waiter.response, nullptr);
+    leader.join();
+
+    auto fresh = flight.run("GET:/api/slow", 50, []() { return okResponse("fresh"); });
+    ASSERT_NE(fresh.response, nullptr);
+    EXPECT_FALSE(fresh.shared);
+    EXPECT_EQ(fresh.response->body, "fresh");
+    EXPECT_EQ(flight.getStats().timeouts, 1u);
+}
+
+TEST(SingleFlightTest, CookieSessionsAndPrivateResponsesAreNotShared) {
+    // Two users on the same URL, told apart only by their session cookie
+    std::map<std::string, std::string> alice = {{"cookie", "session=alice"}};
+    std::map<std::string, std::string> bob = {{"Cookie", "session=bob"}};
+    EXPECT_FALSE(SingleFlight::mayCoalesce(alice));
+    EXPECT_FALSE(SingleFlight::mayCoalesce(bob));
+    EXPECT_TRUE(SingleFlight::mayCoalesce({{"Accept", "application/json"}}));
+
+    // A waiter never receives a response that logs in whoever fetched it
+    SingleFlight flight;
+    std::atomic<int> fetches{0};
+    auto fetch = [&]() {
+        int n = ++fetches;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        ProxyResponse response = okResponse("user" + std::to_string(n));
+        response.headers["Set-Cookie"] = "session=user" + std::to_string(n);
+        return response;
+    };
+
+    SingleFlight::Result first;
+    std::thread leader([&]() { first = flight.run("GET:/api/me", 2000, fetch); });
+    while (flight.inFlight() == 0) {
+        std::this_thread::yield();
+    }
+    auto second = flight.run("GET:/api/me", 2000, fetch);
+    leader.join();
+
+    EXPECT_EQ(fetches.load(), 2);
+    EXPECT_FALSE(first.shared);
+    EXPECT_FALSE(second.shared);
+    ASSERT_NE(second.response, nullptr);
+    EXPECT_NE(second.response->body, first.response->body);
+
+    ProxyResponse private_response = okResponse("mine");
+    private_response.headers["Cache-Control"] = "Private, max-age=60";
+    EXPECT_FALSE(SingleFlight::isShareable(private_response));
+    EXPECT_TRUE(SingleFlight::isShareable(okResponse("public")));
+}
+
+TEST(SingleFlightTest, NonStandardExceptionStillReleasesWaiters) {
+    SingleFlight flight;
+    SingleFlight::Result led;
+    std::thread leader([&]() {
+        led = flight.run("GET:/api/broken", 2000, []() -> ProxyResponse {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            throw 42;
+        });
+    });
+    while (flight.inFlight() == 0) {
+        std::this_thread::yield();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto waited = flight.run("GET:/api/broken", 2000, []() { return okResponse("unused"); });
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    leader.join();
+
+    ASSERT_TRUE(led.response);
+    EXPECT_FALSE(led.response->success);
+    ASSERT_TRUE(waited.response);
+    EXPECT_FALSE(waited.response->success);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000));
+    EXPECT_EQ(flight.inFlight(), 0u);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "../src/server/WorkerPool.h"
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace gateway;
+
+namespace {
+void waitFor(const std::atomic<int>& counter, int value) {
+    for (int i = 0; i < 400 && counter < value; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+}
+
+TEST(WorkerPoolTest, ShedsOverflowAndRefusesWhenBothQueuesFull) {
+    std::atomic<bool> release{false};
+    std::atomic<int> started{0};
+    std::atomic<int> ran{0};
+    std::atomic<int> shed_runs{0};
+    auto metrics = std::make_shared<SimpleMetrics>();
+
+    auto job = [&]() {
+        started++;
+        if (WorkerPool::isShedding()) {
+            shed_runs++;
+        }
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ran++;
+    };
+
+    WorkerPoolConfig config;
+    config.threads = 1;
+    config.queue_depth = 1;
+    config.shed_queue_depth = 1;
+    {
+        WorkerPool pool(config, metrics);
+
+        // Worker busy, then one job waits in the queue
+        ASSERT_TRUE(pool.enqueue(job));
+        waitFor(started, 1);
+        ASSERT_TRUE(pool.enqueue(job));
+
+        // Overflow goes to the shed thread, then waits in the shed queue
+        ASSERT_TRUE(pool.enqueue(job));
+        waitFor(started, 2);
+        ASSERT_TRUE(pool.enqueue(job));
+        EXPECT_FALSE(pool.enqueue(job));
+
+        auto stats = pool.getStats();
+        EXPECT_EQ(stats.accepted, 2u);
+        EXPECT_EQ(stats.shed, 2u);
+        EXPECT_EQ(stats.refused, 1u);
+        EXPECT_FALSE(WorkerPool::isShedding());
+
+        release = true;
+    }
+
+    // Shutdown finished everything that was queued
+    EXPECT_EQ(ran.load(), 4);
+    EXPECT_EQ(shed_runs.load(), 2);
+    EXPECT_NE(metrics->exportMetrics().find("gateway_connections_shed_total 2"), std::string::npos);
+}
+
+TEST(WorkerPoolTest, ShardSplitsSizingAndPinsThreads) {
+    WorkerPoolConfig total;
+    total.threads = 6;
+    total.queue_depth = 100;
+    total.shed_queue_depth = 10;
+
+    auto shard = total.shard(4, 1);
+    EXPECT_EQ(shard.threads, 2u);
+    EXPECT_EQ(shard.queue_depth, 25u);
+    EXPECT_EQ(shard.shed_queue_depth, 3u);
+    EXPECT_EQ(shard.cpu, 1);
+    EXPECT_EQ(WorkerPoolConfig{}.shard(1024, -1).threads, 2u);
+
+    std::atomic<int> cpus_allowed{0};
+    {
+        WorkerPoolConfig config;
+        config.threads = 1;
+        config.cpu = 0;
+        WorkerPool pool(config);
+        ASSERT_TRUE(pool.enqueue([&]() {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+            cpus_allowed = CPU_COUNT(&set);
+        }));
+    }
+    EXPECT_EQ(cpus_allowed.load(), 1);
+}